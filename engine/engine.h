@@ -31,8 +31,9 @@ public:
   Server() {}
 
   //------------------------------------------------------------------------
-  // Time to sleep until next tick (microseconds)
-  int tick_wait() override { return 100; }
+  // Time to sleep until next tick (microseconds) - none, since the
+  // service sleeps until the next tick is due itself
+  int tick_wait() override { return 0; }
 
   //------------------------------------------------------------------------
   // Read settings from configuration
@@ -117,10 +117,25 @@ Element *Element::clone(const SetupContext&) const
   return el;
 }
 
+//--------------------------------------------------------------------------
+// Get elements which must tick before this one
+vector<GraphElement *> Element::get_tick_sources() const
+{
+  auto sources = vector<GraphElement *>{};
+  if (!waits_for_inputs())
+    return sources;
+  for (const auto& i: inputs)
+    for (const auto& c: i->get_connections())
+      sources.push_back(c.element);
+  return sources;
+}
+
 //--------------------------------------------------------------------------
 // Ready - check for tick readiness
 bool Element::ready() const
 {
+  if (!waits_for_inputs())
+    return true;
   for (const auto& i: inputs)
     if (!i->ready())
       return false;
@@ -9,9 +9,13 @@
 #include "vg-dataflow.h"
 #include "ot-log.h"
 #include <algorithm>
+#include <unordered_map>
 
 namespace ViGraph { namespace Dataflow {
 
+// Count of sample buffer growths - see resize_buffer()
+atomic<uint64_t> buffer_allocations{0};
+
 //--------------------------------------------------------------------------
 // Create an element with the given type
 GraphElement *Engine::create(const string& type, const string& id) const
@@ -36,11 +40,199 @@ void Engine::setup(GraphElement& element) const
 }
 
 //--------------------------------------------------------------------------
-// Update element list
+// Update element list, sorting into dependency order so a tick can just
+// walk it without checking readiness, and partitioning it into tasks for
+// the work-stealing scheduler
 void Engine::update_elements()
 {
+  auto elements = vector<Element *>{};
+  graph->collect_elements(elements);
+
+  // Build successor lists and count dependencies of each element
+  const auto nels = elements.size();
+  auto index = unordered_map<const GraphElement *, unsigned>{};
+  for (auto i = 0u; i < nels; ++i)
+    index[elements[i]] = i;
+  auto dependencies = vector<unsigned>(nels);
+  auto successors = vector<vector<unsigned>>(nels);
+  for (auto i = 0u; i < nels; ++i)
+  {
+    for (const auto source: elements[i]->get_tick_sources())
+    {
+      const auto it = index.find(source);
+      if (it == index.end())
+        continue;
+      successors[it->second].push_back(i);
+      ++dependencies[i];
+    }
+  }
+
+  // Kahn's algorithm - start with everything that has no dependencies,
+  // in collection order, and add successors as they become free
+  auto pending = dependencies;
+  auto order = vector<unsigned>{};
+  order.reserve(nels);
+  for (auto i = 0u; i < nels; ++i)
+    if (!pending[i])
+      order.push_back(i);
+  for (auto n = 0u; n < order.size(); ++n)
+    for (const auto s: successors[order[n]])
+      if (!--pending[s])
+        order.push_back(s);
+
+  // Cluster linear chains - where an element's only dependent has no other
+  // source - into single tasks, so they run on one thread.  Every edge into
+  // a task is then into its head, so the tasks are still in dependency
+  // order if taken in order of their heads
+  auto task_of = vector<unsigned>(nels, 0);
+  auto assigned = vector<bool>(nels, false);
   tick_elements.clear();
-  graph->collect_elements(tick_elements);
+  tick_elements.reserve(nels);
+  tick_tasks.clear();
+  for (const auto i: order)
+  {
+    if (assigned[i])
+      continue;
+    const auto t = static_cast<unsigned>(tick_tasks.size());
+    tick_tasks.push_back(tick_elements.size());
+    for (auto e = i;;)
+    {
+      assigned[e] = true;
+      task_of[e] = t;
+      tick_elements.push_back(elements[e]);
+      if (successors[e].size() != 1 || dependencies[successors[e][0]] != 1)
+        break;
+      e = successors[e][0];
+    }
+  }
+  tick_schedule_size = tick_elements.size();
+  const auto ntasks = tick_tasks.size();
+  tick_tasks.push_back(tick_schedule_size);
+
+  // Task dependencies - edges out of a task can only come from its tail
+  tick_dependencies.assign(ntasks, 0);
+  tick_successors.assign(ntasks, {});
+  for (auto t = 0u; t < ntasks; ++t)
+  {
+    const auto tail = index[tick_elements[tick_tasks[t + 1] - 1]];
+    for (const auto s: successors[tail])
+    {
+      if (!assigned[s] || task_of[s] == t)
+        continue;
+      tick_successors[t].push_back(task_of[s]);
+      ++tick_dependencies[task_of[s]];
+    }
+  }
+
+  // Critical path - longest run of elements from each task to the end of
+  // the graph, used to start on the longest paths first
+  auto level = vector<unsigned>(ntasks, 0);
+  for (auto t = ntasks; t-- > 0;)
+  {
+    auto longest = 0u;
+    for (const auto s: tick_successors[t])
+      longest = max(longest, level[s]);
+    level[t] = tick_tasks[t + 1] - tick_tasks[t] + longest;
+  }
+
+  // Order successors so the most critical is pushed (and hence popped) last,
+  // and roots most critical first
+  for (auto& ss: tick_successors)
+    sort(ss.begin(), ss.end(), [&level](unsigned a, unsigned b)
+         { return level[a] < level[b]; });
+  tick_roots.clear();
+  for (auto t = 0u; t < ntasks; ++t)
+    if (!tick_dependencies[t])
+      tick_roots.push_back(t);
+  stable_sort(tick_roots.begin(), tick_roots.end(), [&level](unsigned a,
+                                                             unsigned b)
+              { return level[a] > level[b]; });
+
+  // Statistics
+  {
+    MT::Lock lock{schedule_stats_mutex};
+    schedule_stats = ScheduleStats{};
+    schedule_stats.elements = nels;
+    schedule_stats.deadlocked = nels - tick_schedule_size;
+    schedule_stats.tasks = ntasks;
+    schedule_stats.roots = tick_roots.size();
+    for (auto t = 0u; t < ntasks; ++t)
+    {
+      const auto length = tick_tasks[t + 1] - tick_tasks[t];
+      if (length > 1)
+      {
+        schedule_stats.chains++;
+        schedule_stats.chained_elements += length;
+      }
+      schedule_stats.longest_chain = max(schedule_stats.longest_chain,
+                                         length);
+      schedule_stats.critical_path = max(schedule_stats.critical_path,
+                                         level[t]);
+    }
+  }
+
+  // Anything left is in a loop without a loop-breaking element
+  if (tick_schedule_size < nels)
+  {
+    for (auto i = 0u; i < nels; ++i)
+      if (!assigned[i])
+        tick_elements.push_back(elements[i]);
+    handle_deadlock(tick_elements.begin() + tick_schedule_size,
+                    tick_elements.end());
+  }
+
+  if (profiling)
+    reset_profile();
+}
+
+//--------------------------------------------------------------------------
+// Get schedule statistics
+Engine::ScheduleStats Engine::get_schedule_stats() const
+{
+  MT::Lock lock{schedule_stats_mutex};
+  auto stats = schedule_stats;
+  stats.threads = threads.size();
+  stats.scheduler = scheduler;
+  return stats;
+}
+
+//--------------------------------------------------------------------------
+// Enable/disable profiling
+void Engine::enable_profiling(bool enable)
+{
+  MT::RWWriteLock lock(graph_mutex);
+  profiling = enable;
+  if (profiling)
+  {
+    reset_profile();
+  }
+  else
+  {
+    MT::Lock lock{profile_mutex};
+    profile.enabled = false;
+  }
+}
+
+//--------------------------------------------------------------------------
+// Reset profile for current elements
+void Engine::reset_profile()
+{
+  profile_times.assign(tick_schedule_size, 0);
+  MT::Lock lock{profile_mutex};
+  profile = Profile{};
+  profile.enabled = true;
+  profile.elements.reserve(tick_schedule_size);
+  for (auto i = 0u; i < tick_schedule_size; ++i)
+    profile.elements.emplace_back(tick_elements[i]->get_id(),
+                      tick_elements[i]->get_module().get_full_type());
+}
+
+//--------------------------------------------------------------------------
+// Get a copy of the tick profile
+Engine::Profile Engine::get_profile() const
+{
+  MT::Lock lock{profile_mutex};
+  return profile;
 }
 
 //--------------------------------------------------------------------------
@@ -55,21 +247,39 @@ void Engine::tick(const Time::Duration& t)
   MT::RWReadLock lock(graph_mutex);
   if (!start_time) start_time = t;
 
+  const auto next_tick_time = start_time + tick_interval * tick_number;
+  if (t < next_tick_time)
+    return;
+
   const auto latest_tick_number = static_cast<unsigned long>((t - start_time)
                                                              / tick_interval);
-  if (latest_tick_number > tick_number + 2)
+  const auto max_late = catch_up == CatchUp::drop ? 0 : max_catch_up;
+  const auto late = latest_tick_number > tick_number;
+  auto skip = 0ul;
+  if (latest_tick_number > tick_number + max_late)
   {
+    skip = latest_tick_number - tick_number - max_late;
     Log::Error elog;
-    const auto skip = latest_tick_number - tick_number - 2;
-    elog << "Skipping " << skip << " ticks due to lag" << endl;
-    tick_number += skip;
+    if (catch_up == CatchUp::stretch)
+    {
+      elog << "Stretching tick time by " << skip << " ticks due to lag" << endl;
+      start_time += tick_interval * skip;
+    }
+    else
+    {
+      elog << "Skipping " << skip << " ticks due to lag" << endl;
+      tick_number += skip;
+    }
   }
 
+  auto ticks = 0ul;
   while (t >= start_time + tick_interval * tick_number)
   {
     const auto tick_start = tick_interval.seconds() * tick_number;
     const auto tick_end = tick_interval.seconds() * (tick_number + 1);
 
+    const auto start = profiling ? chrono::steady_clock::now()
+                                 : chrono::steady_clock::time_point{};
     try
     {
       const auto td = TickData{tick_start, tick_end};
@@ -84,8 +294,28 @@ void Engine::tick(const Time::Duration& t)
       log << "Graph tick failed: " << e.what() << endl;
     }
 
+    if (profiling)
+    {
+      MT::Lock lock{profile_mutex};
+      profile.ticks.add(chrono::duration_cast<chrono::nanoseconds>(
+                          chrono::steady_clock::now() - start).count());
+      for (auto i = 0u; i < tick_schedule_size; ++i)
+        profile.elements[i].histogram.add(profile_times[i]);
+    }
+
     tick_number++;
+    ticks++;
   }
+
+  MT::Lock timing_lock{timing_mutex};
+  timing_stats.ticks += ticks;
+  timing_stats.lateness.add(static_cast<uint64_t>(
+                              (t - next_tick_time).seconds() * 1e9));
+  if (late) timing_stats.late_calls++;
+  if (catch_up == CatchUp::stretch)
+    timing_stats.stretched_ticks += skip;
+  else
+    timing_stats.skipped_ticks += skip;
 }
 
 //--------------------------------------------------------------------------
@@ -94,7 +324,7 @@ void Engine::handle_deadlock(const vector<Element *>::const_iterator& begin,
                              const vector<Element *>::const_iterator& end)
 {
   Log::Error elog;
-  elog << "Deadlock detected in tick. Remaining elements:" << endl;
+  elog << "Deadlock detected in graph. Elements not ticked:" << endl;
   for_each(begin, end, [&](Element * el)
   {
     elog << "  " << el->get_id() << endl;
@@ -102,31 +332,11 @@ void Engine::handle_deadlock(const vector<Element *>::const_iterator& begin,
 }
 
 //--------------------------------------------------------------------------
-// Serial tick of elements
+// Serial tick of elements - already in dependency order
 void Engine::serial_tick_elements(const TickData& td)
 {
-  auto ticked = 0u;
-  auto last_count = ticked;
-  const auto to_tick = tick_elements.size();
-  while (ticked < to_tick)
-  {
-    for (auto i = ticked; i < to_tick; ++i)
-    {
-      if (tick_elements[i]->ready())
-      {
-        tick_elements[i]->tick(td);
-        iter_swap(tick_elements.begin() + i, tick_elements.begin() + ticked);
-        ++ticked;
-      }
-    }
-    if (ticked == last_count)
-    {
-      handle_deadlock(tick_elements.begin() + ticked, tick_elements.end());
-      break;
-    }
-
-    last_count = ticked;
-  }
+  for (auto i = 0u; i < tick_schedule_size; ++i)
+    tick_element(i, td);
 
   // Reset all
   for (auto it: tick_elements)
@@ -135,7 +345,7 @@ void Engine::serial_tick_elements(const TickData& td)
 
 //--------------------------------------------------------------------------
 // Set the number of threads
-void Engine::set_threads(unsigned nthreads)
+void Engine::set_threads(unsigned nthreads, Scheduler _scheduler)
 {
   parallel_state.shutdown = true;
   for (auto& go: parallel_state.go)
@@ -146,97 +356,206 @@ void Engine::set_threads(unsigned nthreads)
   parallel_state.go.clear();
   parallel_state.complete.clear();
   parallel_state.complete_threads.clear();
+  parallel_state.deques.clear();
+  parallel_state.capacity = 0;
 
+  scheduler = _scheduler;
   parallel_state.shutdown = false;
   if (nthreads > 1)
   {
     parallel_state.go.resize(nthreads);
     parallel_state.complete_threads.resize(nthreads);
+    parallel_state.deques.resize(nthreads);
     while (threads.size() < nthreads)
     {
       const auto n = threads.size();
-      threads.emplace_back([&, n, nthreads]()
+      if (scheduler == Scheduler::work_stealing)
+        threads.emplace_back([this, n]() { work_stealing_tick_thread(n); });
+      else
+        threads.emplace_back([this, n]() { shared_tick_thread(n); });
+    }
+  }
+}
+
+//--------------------------------------------------------------------------
+// Thread function for shared scheduler - scan for ready elements in a
+// shared list, under a lock
+void Engine::shared_tick_thread(unsigned n)
+{
+  const auto nthreads = parallel_state.go.size();
+  while (true)
+  {
+    parallel_state.go[n].wait();
+    parallel_state.go[n].clear();
+    if (parallel_state.shutdown)
+      return;
+
+    auto nels = parallel_state.tick_elements.size();
+    while (true)
+    {
+      auto el = -1;
+      auto ticked = 0u;
       {
-        while (true)
+        MT::Lock lock{parallel_state.tick_elements_mutex};
+        for (auto i = parallel_state.ticked; i < nels; ++i)
         {
-          parallel_state.go[n].wait();
-          parallel_state.go[n].clear();
-          if (parallel_state.shutdown)
-            return;
+          if (tick_elements[parallel_state.tick_elements[i]]->ready())
+          {
+            el = parallel_state.tick_elements[i];
+            iter_swap(parallel_state.tick_elements.begin() + i,
+                      parallel_state.tick_elements.begin() +
+                      parallel_state.ticked);
+            ticked = ++parallel_state.ticked;
+            break;
+          }
+        }
+      }
+      if (el < 0)
+      {
+        MT::Lock lock{parallel_state.complete_threads_mutex};
+        parallel_state.complete_threads[n] = true;
+        if (find(begin(parallel_state.complete_threads),
+                 end(parallel_state.complete_threads), false)
+            == end(parallel_state.complete_threads))
+          parallel_state.complete.signal();
+        break;
+      }
 
-          auto nels = tick_elements.size();
-          while (true)
+      tick_element(el, parallel_state.td);
+
+      MT::Lock lock{parallel_state.complete_threads_mutex};
+      if (ticked < nels)
+      {
+        for (auto g = 0u; g < nthreads; ++g)
+        {
+          if (g != n && parallel_state.complete_threads[g])
           {
-            Element *el = nullptr;
-            auto ticked = 0u;
-            {
-              MT::Lock lock{parallel_state.tick_elements_mutex};
-              for (auto i = parallel_state.ticked; i < nels; ++i)
-              {
-                if (parallel_state.tick_elements[i]->ready())
-                {
-                  el = parallel_state.tick_elements[i];
-                  iter_swap(parallel_state.tick_elements.begin() + i,
-                            parallel_state.tick_elements.begin() +
-                            parallel_state.ticked);
-                  ticked = ++parallel_state.ticked;
-                  break;
-                }
-              }
-            }
-            if (!el)
-            {
-              MT::Lock lock{parallel_state.complete_threads_mutex};
-              parallel_state.complete_threads[n] = true;
-              if (find(begin(parallel_state.complete_threads),
-                       end(parallel_state.complete_threads), false)
-                  == end(parallel_state.complete_threads))
-                parallel_state.complete.signal();
-              break;
-            }
-
-            el->tick(parallel_state.td);
-
-            MT::Lock lock{parallel_state.complete_threads_mutex};
-            if (ticked < nels)
-            {
-              for (auto g = 0u; g < nthreads; ++g)
-              {
-                if (g != n && parallel_state.complete_threads[g])
-                {
-                  parallel_state.complete_threads[g] = false;
-                  parallel_state.go[g].signal();
-                }
-              }
-            }
+            parallel_state.complete_threads[g] = false;
+            parallel_state.go[g].signal();
           }
         }
-      });
+      }
     }
   }
 }
 
+//--------------------------------------------------------------------------
+// Thread function for work-stealing scheduler - tick tasks from our own
+// deque, or steal from others', and push dependents onto our own deque as
+// their last source completes
+void Engine::work_stealing_tick_thread(unsigned n)
+{
+  auto& own = parallel_state.deques[n];
+  const auto nthreads = parallel_state.deques.size();
+  while (true)
+  {
+    parallel_state.go[n].wait();
+    parallel_state.go[n].clear();
+    if (parallel_state.shutdown)
+      return;
+
+    while (parallel_state.outstanding.load(memory_order_acquire))
+    {
+      auto i = 0u;
+      if (!own.pop(i))
+      {
+        auto stolen = false;
+        for (auto k = 1u; k < nthreads && !stolen; ++k)
+          stolen = parallel_state.deques[(n + k) % nthreads].steal(i);
+        if (!stolen)
+        {
+          this_thread::yield();
+          continue;
+        }
+      }
+
+      for (auto j = tick_tasks[i]; j < tick_tasks[i + 1]; ++j)
+      {
+        try
+        {
+          tick_element(j, parallel_state.td);
+        }
+        catch (const runtime_error& e)
+        {
+          Log::Error log;
+          log << "Element " << tick_elements[j]->get_id()
+              << " tick failed: " << e.what() << endl;
+        }
+      }
+
+      for (const auto s: tick_successors[i])
+        if (parallel_state.pending[s].fetch_sub(1, memory_order_acq_rel)
+            == 1)
+          own.push(s);
+
+      parallel_state.outstanding.fetch_sub(1, memory_order_acq_rel);
+    }
+
+    if (parallel_state.running.fetch_sub(1, memory_order_acq_rel) == 1)
+      parallel_state.complete.signal();
+  }
+}
 
 //--------------------------------------------------------------------------
 // Parallel tick of elements
 void Engine::parallel_tick_elements(const TickData& td)
 {
   parallel_state.td = td;
-  parallel_state.ticked = 0;
-  for (auto& go: parallel_state.go)
-    go.signal();
-  parallel_state.complete.wait();
-  parallel_state.complete.clear();
+  if (scheduler == Scheduler::work_stealing)
+  {
+    // (Re)allocate for graph size if required
+    const auto nthreads = parallel_state.deques.size();
+    const auto ntasks = tick_dependencies.size();
+    if (parallel_state.capacity < ntasks)
+    {
+      parallel_state.capacity = ntasks;
+      parallel_state.pending.reset(new atomic<unsigned>[ntasks]);
+      for (auto& d: parallel_state.deques)
+        d.resize(ntasks);
+    }
 
-  if (parallel_state.ticked < tick_elements.size())
-    handle_deadlock(tick_elements.begin() + parallel_state.ticked,
-                    tick_elements.end());
+    // Reset counters and share out the tasks with no dependencies, most
+    // critical first - pushed in reverse so they are popped first
+    for (auto& d: parallel_state.deques)
+      d.clear();
+    for (auto i = 0u; i < ntasks; ++i)
+      parallel_state.pending[i].store(tick_dependencies[i],
+                                      memory_order_relaxed);
+    for (auto r = tick_roots.size(); r-- > 0;)
+      parallel_state.deques[r % nthreads].push(tick_roots[r]);
+    parallel_state.outstanding.store(ntasks, memory_order_relaxed);
+    parallel_state.running.store(nthreads, memory_order_release);
+
+    for (auto& go: parallel_state.go)
+      go.signal();
+    parallel_state.complete.wait();
+    parallel_state.complete.clear();
+  }
+  else
+  {
+    parallel_state.tick_elements.resize(tick_schedule_size);
+    for (auto i = 0u; i < tick_schedule_size; ++i)
+      parallel_state.tick_elements[i] = i;
+    parallel_state.ticked = 0;
+    for (auto& go: parallel_state.go)
+      go.signal();
+    parallel_state.complete.wait();
+    parallel_state.complete.clear();
+
+    if (parallel_state.ticked < tick_schedule_size)
+    {
+      auto remaining = vector<Element *>{};
+      for (auto i = parallel_state.ticked; i < tick_schedule_size; ++i)
+        remaining.push_back(tick_elements[parallel_state.tick_elements[i]]);
+      handle_deadlock(remaining.begin(), remaining.end());
+    }
+    for (auto&& c: parallel_state.complete_threads)
+      c = false;
+  }
 
   // Reset all
   for (auto it: tick_elements)
     it->reset();
-  for (auto&& c: parallel_state.complete_threads)
-    c = false;
 }
 
 //--------------------------------------------------------------------------
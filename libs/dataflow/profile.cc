@@ -0,0 +1,68 @@
+//==========================================================================
+// ViGraph dataflow machines: profile.cc
+//
+// Tick timing histogram implementation
+//
+// Copyright (c) 2020 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-dataflow.h"
+
+namespace ViGraph { namespace Dataflow {
+
+//--------------------------------------------------------------------------
+// Add a sample
+void TickHistogram::add(uint64_t ns)
+{
+  count++;
+  total += ns;
+  if (ns > max) max = ns;
+
+  // Octave is position of top bit, bucket within it the next two bits
+  auto bucket = 0u;
+  if (ns >= buckets_per_octave)
+  {
+    auto octave = 0u;
+    for (auto v = ns; v >>= 1;)
+      octave++;
+    const auto sub = (ns >> (octave - 2)) & (buckets_per_octave - 1);
+    bucket = (octave - 1) * buckets_per_octave + sub;
+  }
+  else
+  {
+    bucket = ns;
+  }
+  if (bucket >= buckets.size())
+    bucket = buckets.size() - 1;
+  buckets[bucket]++;
+}
+
+//--------------------------------------------------------------------------
+// Get the time at or below which the given fraction of samples lie
+uint64_t TickHistogram::get_percentile(double fraction) const
+{
+  if (!count)
+    return 0;
+
+  const auto wanted = static_cast<uint64_t>(ceil(fraction * count));
+  auto seen = uint64_t{0};
+  for (auto b = 0u; b < buckets.size(); ++b)
+  {
+    seen += buckets[b];
+    if (seen >= wanted && seen)
+    {
+      // Upper bound of bucket, but never more than the maximum seen
+      auto upper = uint64_t{b + 1};
+      if (b >= buckets_per_octave)
+      {
+        const auto octave = b / buckets_per_octave + 1;
+        const auto sub = b % buckets_per_octave;
+        upper = (uint64_t{buckets_per_octave + sub + 1}) << (octave - 2);
+      }
+      return upper < max ? upper : max;
+    }
+  }
+  return max;
+}
+
+}} // namespaces
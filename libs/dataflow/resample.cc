@@ -0,0 +1,150 @@
+//==========================================================================
+// ViGraph dataflow machines: resample.cc
+//
+// Sample rate conversion between connections
+//
+// Copyright (c) 2020 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-dataflow.h"
+
+namespace ViGraph { namespace Dataflow {
+
+namespace
+{
+  atomic<Resampling> default_resampling{Resampling::nearest};
+}
+
+const unsigned PolyphaseKernel::min_taps;
+const unsigned PolyphaseKernel::max_taps;
+const unsigned PolyphaseKernel::phases;
+const unsigned SampleResampler::history;
+
+//--------------------------------------------------------------------------
+// Set the global default resampling mode
+void set_default_resampling(Resampling mode)
+{
+  default_resampling = mode == Resampling::global ? Resampling::nearest
+                                                  : mode;
+}
+
+//--------------------------------------------------------------------------
+// Get the global default resampling mode
+Resampling get_default_resampling()
+{
+  return default_resampling;
+}
+
+//--------------------------------------------------------------------------
+// Constructor - tabulate a Blackman-windowed sinc for each phase.  Taps
+// grow as the cutoff falls so decimation averages over the whole
+// decimation period, up to max_taps
+PolyphaseKernel::PolyphaseKernel(double _cutoff):
+  cutoff{_cutoff},
+  taps{min(max_taps, max(min_taps,
+                         static_cast<unsigned>(ceil(min_taps / cutoff / 4))
+                         * 4))}
+{
+  const auto half = taps / 2.0;
+  coeffs.resize((phases + 1) * taps);
+  for (auto p = 0u; p <= phases; ++p)
+  {
+    auto c = &coeffs[p * taps];
+    auto sum = 0.0;
+    for (auto k = 0u; k < taps; ++k)
+    {
+      // Distance from the (delayed by half) centre, in input samples
+      const auto d = static_cast<double>(p) / phases + taps - 1 - half - k;
+      const auto x = d * cutoff;
+      const auto sinc = fabs(x) < 1e-9 ? 1.0 : sin(M_PI * x) / (M_PI * x);
+      const auto w = fabs(d) >= half ? 0.0
+                     : 0.42 + 0.5 * cos(M_PI * d / half)
+                       + 0.08 * cos(2 * M_PI * d / half);
+      c[k] = sinc * w;
+      sum += c[k];
+    }
+
+    // Normalise for unity gain at DC
+    if (sum != 0.0)
+      for (auto k = 0u; k < taps; ++k)
+        c[k] /= sum;
+  }
+}
+
+//--------------------------------------------------------------------------
+// Resample.  Output samples are spread evenly across the tick with the
+// last one aligned to the last input sample, delayed by half the kernel.
+// The inner loop is a straight multiply-accumulate over contiguous
+// arrays, with four independent accumulators so it vectorises
+void PolyphaseKernel::resample(const double *in, unsigned fsize,
+                               double *out, unsigned tsize) const
+{
+  const auto step = static_cast<double>(fsize) / tsize;
+  for (auto i = 0u; i < tsize; ++i)
+  {
+    const auto pos = (i + 1) * step - 1;
+    const auto end = static_cast<int>(floor(pos));
+    const auto phase = static_cast<unsigned>(lround((pos - end) * phases));
+
+    // Window is the taps ending at input sample 'end' - history means
+    // in[end - taps + 1] is always valid
+    const auto x = in + end - static_cast<int>(taps) + 1;
+    const auto c = &coeffs[phase * taps];
+    double a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+    for (auto k = 0u; k < taps; k += 4)
+    {
+      a0 += c[k] * x[k];
+      a1 += c[k + 1] * x[k + 1];
+      a2 += c[k + 2] * x[k + 2];
+      a3 += c[k + 3] * x[k + 3];
+    }
+    out[i] = (a0 + a1) + (a2 + a3);
+  }
+}
+
+//--------------------------------------------------------------------------
+// Resample one tick of a stream
+void SampleResampler::resample(const double *from, unsigned fsize,
+                               double *to, unsigned tsize, Resampling mode)
+{
+  if (!fsize || !tsize)
+    return;
+
+  // (Re)create the kernel if the ratio has changed more than a little
+  if (mode == Resampling::polyphase)
+  {
+    const auto cutoff = min(1.0, static_cast<double>(tsize) / fsize);
+    if (!kernel || fabs(kernel->get_cutoff() - cutoff) > cutoff * 0.01)
+      kernel.reset(new PolyphaseKernel(cutoff));
+  }
+
+  // Input follows enough history for the longest kernel, primed with the
+  // first sample at start
+  if (work.empty())
+    work.assign(history, from[0]);
+  resize_buffer(work, history + fsize);
+  copy(from, from + fsize, work.begin() + history);
+  const auto in = work.data() + history;
+
+  if (mode == Resampling::polyphase)
+  {
+    kernel->resample(in, fsize, to, tsize);
+  }
+  else
+  {
+    // Linear between the last history sample and this tick's input
+    const auto step = static_cast<double>(fsize) / tsize;
+    for (auto i = 0u; i < tsize; ++i)
+    {
+      const auto pos = (i + 1) * step - 1;
+      const auto j = static_cast<int>(floor(pos));
+      const auto frac = pos - j;
+      to[i] = frac > 0 ? in[j] + (in[j + 1] - in[j]) * frac : in[j];
+    }
+  }
+
+  // Keep the tail as history for next time
+  copy(work.end() - history, work.end(), work.begin());
+}
+
+}} // namespaces
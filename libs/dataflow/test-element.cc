@@ -53,6 +53,171 @@ TEST(ElementTest, TestElementControlUpdateDirectSetting)
   EXPECT_EQ(1.0, e.x.get());
 }
 
+//==========================================================================
+// Test Adder
+// Adds two inputs, per sample or in blocks
+
+extern SimpleModule adder_module;
+class TestAdder: public SimpleElement
+{
+private:
+  TestAdder *create_clone() const override
+  {
+    return new TestAdder{};
+  }
+public:
+  TestAdder(): SimpleElement(adder_module) {}
+  using SimpleElement::sample_iterate;
+  using SimpleElement::block_iterate;
+  Input<double> x;
+  Input<double> y;
+  Output<double> output;
+
+  void tick_samples(const TickData& td, unsigned nsamples)
+  {
+    sample_iterate(td, nsamples, {}, tie(x, y), tie(output),
+                   [&](double x, double y, double& o)
+                   {
+                     o = x + y;
+                   });
+  }
+
+  void tick_blocks(const TickData& td, unsigned nsamples)
+  {
+    block_iterate(td, nsamples, {}, tie(x, y), tie(output),
+                  [&](unsigned n, const double *x, const double *y,
+                      double *o)
+                  {
+                    for (auto i = 0u; i < n; ++i)
+                      o[i] = x[i] + y[i];
+                  });
+  }
+};
+
+SimpleModule adder_module
+{
+  "adder",
+  "Adder",
+  "test",
+  {},
+  {
+    { "x", &TestAdder::x },
+    { "y", &TestAdder::y }
+  },
+  {
+    { "output", &TestAdder::output }
+  }
+};
+
+TEST(ElementTest, TestBlockIterateBroadcastsConstants)
+{
+  TestAdder e;
+  e.set("x", 1.0);
+  e.set("y", 2.0);
+  auto result = vector<double>{};
+  auto td = TickData{0, 1};
+  e.block_iterate(td, 4, {}, tie(e.x, e.y), tie(e.output),
+                  [&](unsigned n, const double *x, const double *y,
+                      double *)
+                  {
+                    for (auto i = 0u; i < n; ++i)
+                      result.push_back(x[i] * 10 + y[i]);
+                  });
+  EXPECT_EQ(vector<double>(4, 12.0), result);
+}
+
+TEST(ElementTest, TestSampleIterateConstantFullAndShortInputs)
+{
+  TestAdder e;
+  e.set("y", 10.0);
+  e.x.set_sample_rate(4);
+  Output<double> xs;
+  xs.connect(nullptr, &e, e.x);
+  auto td = TickData{0, 1};
+  auto result = vector<double>{};
+  auto run = [&]()
+  {
+    result.clear();
+    e.sample_iterate(td, 4, {}, tie(e.x, e.y), tie(e.output),
+                     [&](double x, double y, double&)
+                     {
+                       result.push_back(x + y);
+                     });
+  };
+
+  // Constant
+  EXPECT_TRUE(e.x.is_constant());
+  EXPECT_TRUE(e.y.is_constant());
+  run();
+  EXPECT_EQ(vector<double>(4, 10.0), result);
+  e.reset();
+
+  // Full length
+  {
+    auto xb = xs.get_buffer(td);
+    xb.data = {1, 2, 3, 4};
+  }
+  EXPECT_FALSE(e.x.is_constant());
+  run();
+  EXPECT_EQ((vector<double>{11, 12, 13, 14}), result);
+  e.x.reset();
+
+  // Short - padded with last sample
+  {
+    auto xb = xs.get_buffer(td);
+    xb.data = {5, 6};
+  }
+  run();
+  EXPECT_EQ((vector<double>{15, 16, 16, 16}), result);
+}
+
+// Compares sample_iterate with block_iterate on a simple kernel - disabled
+// since it only reports timings; run with --gtest_also_run_disabled_tests
+TEST(ElementTest, DISABLED_TestBlockIterateBenchmark)
+{
+  const auto nsamples = 1u << 16;
+  const auto repeats = 200;
+  TestAdder e;
+  Output<double> xs, ys;
+  e.x.set_sample_rate(nsamples);
+  e.y.set_sample_rate(nsamples);
+  xs.connect(nullptr, &e, e.x);
+  ys.connect(nullptr, &e, e.y);
+  auto td = TickData{0, 1};
+
+  // Fill source buffers, which are then shared with the inputs
+  auto fill = [&]()
+  {
+    auto xb = xs.get_buffer(td);
+    auto yb = ys.get_buffer(td);
+    for (auto i = 0u; i < nsamples; ++i)
+    {
+      xb.data.push_back(i);
+      yb.data.push_back(nsamples - i);
+    }
+  };
+
+  auto time = [&](function<void()> tick)
+  {
+    auto total = chrono::nanoseconds{};
+    for (auto i = 0; i < repeats; ++i)
+    {
+      fill();
+      const auto start = chrono::steady_clock::now();
+      tick();
+      total += chrono::steady_clock::now() - start;
+      e.reset();
+    }
+    return chrono::duration_cast<chrono::microseconds>(total).count();
+  };
+
+  const auto sample_us = time([&]() { e.tick_samples(td, nsamples); });
+  const auto block_us = time([&]() { e.tick_blocks(td, nsamples); });
+  cout << "sample_iterate: " << sample_us << "us, block_iterate: "
+       << block_us << "us for " << repeats << " x " << nsamples
+       << " samples" << endl;
+}
+
 } // anonymous namespace
 
 int main(int argc, char **argv)
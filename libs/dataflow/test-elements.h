@@ -67,10 +67,14 @@ public:
   Input<double> input;
   Output<double> output;
   string *tick_order{nullptr};
+  bool feedback{false};  // Doesn't wait for input, so can live in a loop
 
   // Construct
   using SimpleElement::SimpleElement;
 
+  // Wait for input?
+  bool waits_for_inputs() const override { return !feedback; }
+
   // Process some data
   void tick(const TickData& td) override
   {
@@ -108,6 +108,185 @@ TEST_F(GraphTest, TestGraphTickOrderingWithoutRouting)
   EXPECT_EQ("S1S2", tick_order);
 }
 
+TEST_F(GraphTest, TestGraphTickOrderingWithFeedbackLoop)
+{
+  TestGraph graph(engine);
+  auto& source_e = graph.add("test/test-source", "S");
+  auto& filter1_e = graph.add("test/test-filter", "f1");
+  auto& filter2_e = graph.add("test/test-filter", "f2");
+
+  source_e.connect("output", filter1_e, "input");
+  filter1_e.connect("output", filter2_e, "input");
+  filter2_e.connect("output", filter1_e, "input");
+  graph.setup();
+
+  string tick_order;
+
+  auto source = graph.get<TestSource>("S");
+  ASSERT_NE(nullptr, source);
+  source->tick_order = &tick_order;
+
+  auto filter1 = graph.get<TestFilter>("f1");
+  ASSERT_NE(nullptr, filter1);
+  filter1->tick_order = &tick_order;
+
+  auto filter2 = graph.get<TestFilter>("f2");
+  ASSERT_NE(nullptr, filter2);
+  filter2->tick_order = &tick_order;
+
+  // Unbroken loop deadlocks, so only the source ticks
+  ASSERT_NO_THROW(engine.tick(Time::Duration{1}));
+  EXPECT_EQ("S", tick_order);
+
+  // Breaking the loop lets the rest be scheduled
+  filter1->feedback = true;
+  engine.update_elements();
+  tick_order.clear();
+  ASSERT_NO_THROW(engine.tick(Time::Duration{2}));
+  EXPECT_EQ("Sf1f2", tick_order);
+}
+
+TEST_F(GraphTest, TestGraphScheduleClustersLinearChains)
+{
+  TestGraph graph(engine);
+  auto& source = graph.add("test/test-source");
+  auto& filter1 = graph.add("test/test-filter");
+  auto& filter2 = graph.add("test/test-filter");
+  auto& filter3 = graph.add("test/test-filter");
+  auto& sink = graph.add("test/test-sink");
+
+  // source -> filter1 -> filter2 -> sink, source -> filter3 -> sink
+  source.connect("output", filter1, "input");
+  filter1.connect("output", filter2, "input");
+  filter2.connect("output", sink, "input");
+  source.connect("output", filter3, "input");
+  filter3.connect("output", sink, "input");
+  graph.setup();
+
+  const auto stats = engine.get_schedule_stats();
+  EXPECT_EQ(5, stats.elements);
+  EXPECT_EQ(0, stats.deadlocked);
+  EXPECT_EQ(4, stats.tasks);  // source, filter1-filter2, filter3, sink
+  EXPECT_EQ(1, stats.chains);
+  EXPECT_EQ(2, stats.chained_elements);
+  EXPECT_EQ(2, stats.longest_chain);
+  EXPECT_EQ(4, stats.critical_path);
+  EXPECT_EQ(1, stats.roots);
+}
+
+TEST_F(GraphTest, TestGraphTickWithWorkStealingThreads)
+{
+  TestGraph graph(engine);
+  auto& source = graph.add("test/test-source");
+  auto& filter1 = graph.add("test/test-filter").set("value", 2.0);
+  auto& filter2 = graph.add("test/test-filter").set("value", 3.0);
+  auto& sinke = graph.add("test/test-sink", "SINK");
+
+  source.connect("output", filter1, "input");
+  source.connect("output", filter2, "input");
+  filter1.connect("output", sinke, "input");
+  filter2.connect("output", sinke, "input");
+  graph.setup();
+  engine.set_threads(4, Engine::Scheduler::work_stealing);
+
+  auto sink = graph.get<TestSink>("SINK");
+  ASSERT_NE(nullptr, sink);
+
+  ASSERT_NO_THROW(engine.tick(Time::Duration{1}));
+  EXPECT_EQ(5, sink->received_data);
+  ASSERT_NO_THROW(engine.tick(Time::Duration{2}));
+  EXPECT_EQ(15, sink->received_data);
+
+  engine.set_threads(0);
+}
+
+TEST_F(GraphTest, TestGraphBurstCatchUpSkipsTicks)
+{
+  TestGraph graph(engine);
+  graph.add("test/test-source");
+  graph.setup();
+  engine.set_tick_interval(Time::Duration{1});
+
+  ASSERT_NO_THROW(engine.tick(Time::Duration{1}));
+  ASSERT_NO_THROW(engine.tick(Time::Duration{10}));
+
+  const auto stats = engine.get_timing_stats();
+  EXPECT_EQ(4, stats.ticks);
+  EXPECT_EQ(1, stats.late_calls);
+  EXPECT_EQ(6, stats.skipped_ticks);
+  EXPECT_EQ(0, stats.stretched_ticks);
+  EXPECT_EQ(2, stats.lateness.get_count());
+  EXPECT_EQ(Time::Duration{11}, engine.get_next_tick_time());
+}
+
+TEST_F(GraphTest, TestGraphStretchCatchUpDelaysTicks)
+{
+  TestGraph graph(engine);
+  graph.add("test/test-source");
+  graph.setup();
+  engine.set_tick_interval(Time::Duration{1});
+  engine.set_catch_up(Engine::CatchUp::stretch, 2);
+
+  ASSERT_NO_THROW(engine.tick(Time::Duration{1}));
+  ASSERT_NO_THROW(engine.tick(Time::Duration{10}));
+
+  const auto stats = engine.get_timing_stats();
+  EXPECT_EQ(4, stats.ticks);
+  EXPECT_EQ(0, stats.skipped_ticks);
+  EXPECT_EQ(6, stats.stretched_ticks);
+  EXPECT_EQ(Time::Duration{11}, engine.get_next_tick_time());
+}
+
+TEST_F(GraphTest, TestGraphSteadyStateTickDoesNotAllocateBuffers)
+{
+  TestGraph graph(engine);
+  auto& source = graph.add("test/test-source");
+  auto& filter1 = graph.add("test/test-filter").set("value", 2.0);
+  auto& filter2 = graph.add("test/test-filter").set("value", 3.0);
+  auto& sinke = graph.add("test/test-sink", "SINK");
+
+  source.connect("output", filter1, "input");
+  source.connect("output", filter2, "input");
+  filter1.connect("output", sinke, "input");
+  filter2.connect("output", sinke, "input");
+  graph.setup();
+  engine.set_tick_interval(Time::Duration{1});
+
+  ASSERT_NO_THROW(engine.tick(Time::Duration{1}));
+  const auto allocations = get_buffer_allocations();
+  for (auto t = 2; t <= 10; ++t)
+    ASSERT_NO_THROW(engine.tick(Time::Duration(t)));
+  EXPECT_EQ(allocations, get_buffer_allocations());
+}
+
+TEST_F(GraphTest, TestGraphFanOutSharesBufferWithoutCorruption)
+{
+  TestGraph graph(engine);
+  auto& source = graph.add("test/test-source");
+  auto& filter = graph.add("test/test-filter").set("value", 2.0);
+  auto& sink1e = graph.add("test/test-sink", "SINK1");
+  auto& sink2e = graph.add("test/test-sink", "SINK2");
+
+  // Sink 1 combines the shared source buffer with the filter's output
+  source.connect("output", filter, "input");
+  source.connect("output", sink1e, "input");
+  source.connect("output", sink2e, "input");
+  filter.connect("output", sink1e, "input");
+  graph.setup();
+
+  auto sink1 = graph.get<TestSink>("SINK1");
+  ASSERT_NE(nullptr, sink1);
+  auto sink2 = graph.get<TestSink>("SINK2");
+  ASSERT_NE(nullptr, sink2);
+
+  ASSERT_NO_THROW(engine.tick(Time::Duration{1}));
+  EXPECT_EQ(3, sink1->received_data);
+  EXPECT_EQ(1, sink2->received_data);
+  ASSERT_NO_THROW(engine.tick(Time::Duration{2}));
+  EXPECT_EQ(9, sink1->received_data);
+  EXPECT_EQ(3, sink2->received_data);
+}
+
 } // anonymous namespace
 
 int main(int argc, char **argv)
@@ -0,0 +1,100 @@
+//==========================================================================
+// ViGraph dataflow machine: test-profile.cc
+//
+// Tests for tick profiling
+//
+// Copyright (c) 2020 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-dataflow.h"
+#include <gtest/gtest.h>
+#include "ot-log.h"
+
+namespace {
+
+#include "test-elements.h"
+
+TEST(TickHistogramTest, TestEmptyHistogram)
+{
+  TickHistogram h;
+  EXPECT_EQ(0, h.get_count());
+  EXPECT_EQ(0, h.get_max());
+  EXPECT_EQ(0, h.get_percentile(0.5));
+}
+
+TEST(TickHistogramTest, TestPercentiles)
+{
+  TickHistogram h;
+  for (auto i = 0; i < 98; ++i)
+    h.add(1000);
+  h.add(100000);
+  h.add(200000);
+  EXPECT_EQ(100, h.get_count());
+  EXPECT_EQ(98000 + 300000, h.get_total());
+  EXPECT_EQ(200000, h.get_max());
+
+  // 1000 is in bucket [896, 1024)
+  EXPECT_EQ(1024, h.get_percentile(0.5));
+
+  // 100000 is in bucket [98304, 114688)
+  EXPECT_EQ(114688, h.get_percentile(0.99));
+
+  // Never more than max
+  EXPECT_EQ(200000, h.get_percentile(1.0));
+}
+
+TEST(TickHistogramTest, TestSmallValuesRoundToBucket)
+{
+  TickHistogram h;
+  h.add(3);
+  h.add(5);
+  EXPECT_EQ(4, h.get_percentile(0.5));
+  EXPECT_EQ(5, h.get_percentile(1.0));
+}
+
+TEST_F(GraphTest, TestProfileRecordsEveryElementTick)
+{
+  TestGraph graph(engine);
+  auto& source = graph.add("test/test-source", "S");
+  auto& filter = graph.add("test/test-filter", "f");
+  auto& sink = graph.add("test/test-sink", "s");
+
+  source.connect("output", filter, "input");
+  filter.connect("output", sink, "input");
+  graph.setup();
+
+  EXPECT_FALSE(engine.get_profile().enabled);
+  engine.enable_profiling(true);
+
+  ASSERT_NO_THROW(engine.tick(Time::Duration{1}));
+  ASSERT_NO_THROW(engine.tick(Time::Duration{2}));
+
+  const auto profile = engine.get_profile();
+  EXPECT_TRUE(profile.enabled);
+  EXPECT_EQ(2, profile.ticks.get_count());
+  ASSERT_EQ(3, profile.elements.size());
+  EXPECT_EQ("S", profile.elements[0].id);
+  EXPECT_EQ("test/test-source", profile.elements[0].type);
+  EXPECT_EQ("f", profile.elements[1].id);
+  EXPECT_EQ("s", profile.elements[2].id);
+  for (const auto& e: profile.elements)
+    EXPECT_EQ(2, e.histogram.get_count());
+
+  engine.enable_profiling(false);
+  ASSERT_NO_THROW(engine.tick(Time::Duration{3}));
+  EXPECT_EQ(2, engine.get_profile().ticks.get_count());
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+  if (argc > 1 && string(argv[1]) == "-v")
+  {
+    auto chan_out = new Log::StreamChannel{&cout};
+    Log::logger.connect(chan_out);
+  }
+  Init::Sequence::run();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
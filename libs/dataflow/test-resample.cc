@@ -0,0 +1,108 @@
+//==========================================================================
+// ViGraph dataflow machine: test-resample.cc
+//
+// Tests for sample rate conversion
+//
+// Copyright (c) 2020 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-dataflow.h"
+#include <gtest/gtest.h>
+#include "ot-log.h"
+
+namespace {
+
+using namespace ViGraph::Dataflow;
+
+TEST(ResampleTest, TestNearestDownsample)
+{
+  auto from = vector<Number>{1, 2, 3, 4};
+  auto to = vector<Number>(2);
+  ResampleState<Number> state;
+  resample(from, to, Resampling::nearest, state);
+  EXPECT_EQ(1, to[0]);
+  EXPECT_EQ(3, to[1]);
+}
+
+TEST(ResampleTest, TestLinearUpsample)
+{
+  auto from = vector<Number>{0, 1};
+  auto to = vector<Number>(4);
+  ResampleState<Number> state;
+  resample(from, to, Resampling::linear, state);
+  EXPECT_DOUBLE_EQ(0, to[0]);
+  EXPECT_DOUBLE_EQ(0, to[1]);
+  EXPECT_DOUBLE_EQ(0.5, to[2]);
+  EXPECT_DOUBLE_EQ(1, to[3]);
+
+  // Continues from last tick's samples
+  from = {3, 5};
+  resample(from, to, Resampling::linear, state);
+  EXPECT_DOUBLE_EQ(2, to[0]);
+  EXPECT_DOUBLE_EQ(3, to[1]);
+  EXPECT_DOUBLE_EQ(4, to[2]);
+  EXPECT_DOUBLE_EQ(5, to[3]);
+}
+
+TEST(ResampleTest, TestPolyphasePassesDC)
+{
+  auto from = vector<Number>(100, 1.0);
+  auto to = vector<Number>(10);
+  ResampleState<Number> state;
+  resample(from, to, Resampling::polyphase, state);
+  for (const auto v: to)
+    EXPECT_NEAR(1.0, v, 1e-9);
+}
+
+TEST(ResampleTest, TestPolyphaseRejectsAliases)
+{
+  // Nyquist frequency at input rate, which nearest would alias to DC
+  auto from = vector<Number>(200);
+  for (auto i = 0u; i < from.size(); ++i)
+    from[i] = (i & 1) ? -1.0 : 1.0;
+  auto to = vector<Number>(50);
+  ResampleState<Number> state;
+  resample(from, to, Resampling::polyphase, state);
+  resample(from, to, Resampling::polyphase, state);
+  for (const auto v: to)
+    EXPECT_GT(0.05, fabs(v));
+
+  resample(from, to, Resampling::nearest, state);
+  EXPECT_EQ(1.0, to[0]);
+}
+
+TEST(ResampleTest, TestTriggersSumWhenDownsampled)
+{
+  auto from = vector<Trigger>{1, 0, 1, 1};
+  auto to = vector<Trigger>(2);
+  ResampleState<Trigger> state;
+  resample(from, to, Resampling::linear, state);
+  EXPECT_EQ(1, to[0]);
+  EXPECT_EQ(2, to[1]);
+}
+
+TEST(ResampleTest, TestDefaultMode)
+{
+  EXPECT_EQ(Resampling::nearest, get_default_resampling());
+  set_default_resampling(Resampling::polyphase);
+  EXPECT_EQ(Resampling::polyphase, get_default_resampling());
+  Input<Number> input;
+  EXPECT_EQ(Resampling::polyphase, input.get_resampling());
+  input.set_resampling(Resampling::linear);
+  EXPECT_EQ(Resampling::linear, input.get_resampling());
+  set_default_resampling(Resampling::nearest);
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+  if (argc > 1 && string(argv[1]) == "-v")
+  {
+    auto chan_out = new Log::StreamChannel{&cout};
+    Log::logger.connect(chan_out);
+  }
+  Init::Sequence::run();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
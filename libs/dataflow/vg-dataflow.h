@@ -11,7 +11,10 @@
 
 #include <map>
 #include <set>
+#include <array>
+#include <memory>
 #include <string>
+#include <chrono>
 #include <functional>
 #include <cmath>
 #include "ot-mt.h"
@@ -168,6 +171,94 @@ inline JSON::Value get_as_json(const bool& value)
   return {value ? JSON::Value::TRUE_ : JSON::Value::FALSE_};
 }
 
+//==========================================================================
+// Sample rate conversion between outputs and inputs of different rates
+
+// Resampling modes
+enum class Resampling
+{
+  global,     // Use the global default
+  nearest,    // Nearest sample (summed for triggers)
+  linear,     // Linear interpolation
+  polyphase   // Windowed-sinc polyphase FIR
+};
+
+// Global default mode for inputs which don't set one - initially nearest
+void set_default_resampling(Resampling mode);
+Resampling get_default_resampling();
+
+// Windowed-sinc lowpass kernel, tabulated for a number of fractional
+// phases.  Cutoff is a fraction of the input Nyquist frequency
+class PolyphaseKernel
+{
+public:
+  static const unsigned min_taps = 16;
+  static const unsigned max_taps = 128;
+  static const unsigned phases = 64;
+
+private:
+  double cutoff;
+  unsigned taps;
+  vector<double> coeffs;   // (phases + 1) * taps
+
+public:
+  PolyphaseKernel(double _cutoff);
+  double get_cutoff() const { return cutoff; }
+  unsigned get_taps() const { return taps; }
+
+  // Resample fsize samples at 'in' to tsize at 'out'; 'in' must be
+  // preceded by get_taps()-1 samples of history
+  void resample(const double *in, unsigned fsize,
+                double *out, unsigned tsize) const;
+};
+
+// Resampler for a single stream, keeping history between ticks
+class SampleResampler
+{
+  static const unsigned history = PolyphaseKernel::max_taps;
+  vector<double> work;     // History followed by this tick's input
+  unique_ptr<PolyphaseKernel> kernel;
+
+public:
+  void resample(const double *from, unsigned fsize,
+                double *to, unsigned tsize, Resampling mode);
+};
+
+// Per-connection resampling state - only needed for types which can be
+// interpolated
+template<typename T>
+struct ResampleState
+{
+  static const bool interpolates = false;
+};
+
+// Resample a tick's buffer - defaults to nearest sample
+template<typename T>
+inline void resample(const vector<T>& from, vector<T>& to, Resampling,
+                     ResampleState<T>&)
+{
+  downsample(from, to);
+}
+
+// Specialisation for <Number>
+template<>
+struct ResampleState<Number>
+{
+  static const bool interpolates = true;
+  SampleResampler resampler;
+};
+
+template<>
+inline void resample(const vector<Number>& from, vector<Number>& to,
+                     Resampling mode, ResampleState<Number>& state)
+{
+  if (mode == Resampling::nearest)
+    downsample(from, to);
+  else
+    state.resampler.resample(from.data(), from.size(),
+                             to.data(), to.size(), mode);
+}
+
 //==========================================================================
 // Tick data - data that is passed for each tick
 struct TickData
@@ -564,6 +655,74 @@ public:
 
 template<typename T> class Output;
 
+//==========================================================================
+// Sample buffer sizing
+// Input and output buffers keep their capacity from tick to tick, so a
+// steady-state tick should make no heap allocations - all growth is
+// counted so this can be checked
+extern atomic<uint64_t> buffer_allocations;
+
+// Resize a buffer, counting if it needs to grow
+template<typename T>
+inline void resize_buffer(vector<T>& buffer, size_t size)
+{
+  if (size > buffer.capacity())
+    buffer_allocations.fetch_add(1, memory_order_relaxed);
+  buffer.resize(size);
+}
+
+// Copy a buffer, counting if the destination needs to grow
+template<typename T>
+inline void copy_buffer(const vector<T>& from, vector<T>& to)
+{
+  if (from.size() > to.capacity())
+    buffer_allocations.fetch_add(1, memory_order_relaxed);
+  to = from;
+}
+
+// Empty a buffer ready for the next tick - block types which carry their
+// own sample storage specialise this to keep it
+template<typename T>
+inline void clear_buffer(vector<T>& buffer)
+{
+  buffer.clear();
+}
+
+// Carry the last sample of a tick over, for use if the next is short or
+// empty - block types, whose one sample is the whole tick, specialise this
+// to keep only its end rather than copy the block every tick
+template<typename T>
+inline void keep_last_value(const vector<T>& buffer, T& last_value)
+{
+  if (!buffer.empty())
+    last_value = buffer.back();
+}
+
+// Get the number of buffer growths since startup
+inline uint64_t get_buffer_allocations()
+{
+  return buffer_allocations.load(memory_order_relaxed);
+}
+
+// Resample a tick's buffer for an input at a different rate, if needed -
+// returns false if the buffer can be shared as it is.  Only types which
+// can be interpolated are upsampled
+template<typename T>
+inline bool resample_tick(const vector<T>& from, vector<T>& to,
+                          size_t nsamples, Resampling mode,
+                          ResampleState<T>& state)
+{
+  if (from.size() > nsamples
+      || (ResampleState<T>::interpolates && mode != Resampling::nearest
+          && !from.empty() && from.size() < nsamples))
+  {
+    resize_buffer(to, nsamples);
+    resample(from, to, mode, state);
+    return true;
+  }
+  return false;
+}
+
 //==========================================================================
 // Element input template
 template<typename T>
@@ -574,14 +733,31 @@ private:
 
   T last_value;
   double sample_rate = 0.0;
+  Resampling resampling = Resampling::global;
   struct Data
   {
     GraphElement *element = nullptr;
-    vector<T> data;
+    vector<T> data;                    // Own copy, if resampled or combined
+    const vector<T> *shared = nullptr; // Output's buffer, if same rate
+    ResampleState<T> resample_state;
     atomic<bool> ready{false};
+
+    const vector<T>& get() const { return shared ? *shared : data; }
+
+    // Take a private copy of a shared buffer so it can be modified
+    vector<T>& get_writable()
+    {
+      if (shared)
+      {
+        copy_buffer(*shared, data);
+        shared = nullptr;
+      }
+      return data;
+    }
   };
   map<Output<T> *, Data> input_data;
   vector<T> dummy_buffer;
+  vector<T> block_buffer;   // Padded copy for get_block()
   bool combined = false;
 
 
@@ -590,17 +766,18 @@ private:
   template<typename U = T, class = decltype(declval<U&>() += declval<U>())>
   void combine(decltype(input_data.begin()) it, bool)
   {
+    auto& data = it->second.get_writable();
     for (auto i = input_data.begin(); i != input_data.end(); ++i)
     {
       if (i == it)
         continue;
-      if (!it->second.data.empty())
+      if (!data.empty())
       {
-        auto c = it->second.data.begin();
-        for (const auto& b: i->second.data)
+        auto c = data.begin();
+        for (const auto& b: i->second.get())
         {
           *c += b;
-          if (++c == it->second.data.end())
+          if (++c == data.end())
             break;
         }
       }
@@ -635,6 +812,18 @@ public:
     return sample_rate;
   }
 
+  // Set how connections at other rates are resampled to ours
+  void set_resampling(Resampling mode)
+  {
+    resampling = mode;
+  }
+
+  Resampling get_resampling() const
+  {
+    return resampling == Resampling::global ? get_default_resampling()
+                                            : resampling;
+  }
+
   void set_sample_rate(double rate) override
   {
     sample_rate = rate;
@@ -669,7 +858,33 @@ public:
     if (!combined && input_data.size() > 1)
       combine(it, true);
 
-    return it->second.data;
+    return it->second.get();
+  }
+
+  // Whether the input has the same value for the whole of this tick -
+  // unconnected, or connected but no samples this tick.  Block types keep
+  // their (cleared) block in the buffer, so connected audio inputs are
+  // never constant and don't take sample_iterate's constant fast path
+  bool is_constant()
+  {
+    return get_buffer().empty();
+  }
+
+  // Get the buffer as a contiguous block of 'count' samples, for block
+  // processing.  Short or empty buffers are padded with the value
+  // sample_iterate would use (last sample, last value or constant)
+  const T *get_block(unsigned count)
+  {
+    const auto& buffer = get_buffer();
+    if (buffer.size() >= count)
+      return buffer.data();
+
+    resize_buffer(block_buffer, count);
+    copy(buffer.begin(), buffer.end(), block_buffer.begin());
+    const auto& pad = !buffer.empty() ? buffer.back()
+                      : (connected() ? last_value : this->get());
+    fill(block_buffer.begin() + buffer.size(), block_buffer.end(), pad);
+    return block_buffer.data();
   }
 
   void reset() override
@@ -683,14 +898,14 @@ public:
         combine(it, true);
 
       // Store last value
-      if (!it->second.data.empty())
-        last_value = it->second.data.back();
+      keep_last_value(it->second.get(), last_value);
     }
     combined = false;
 
     for (auto& i: input_data)
     {
-      i.second.data.clear();
+      clear_buffer(i.second.data);
+      i.second.shared = nullptr;
       i.second.ready = false;
     }
   }
@@ -743,6 +958,7 @@ private:
     {}
   };
   map<Input<T> *, OutputData> output_data;
+  vector<T> buffer;         // Shared read-only with all same-rate inputs
   vector<T> dummy_buffer;
   Input<T> *primary_data = nullptr;
 
@@ -833,10 +1049,11 @@ public:
   {
     if (!primary_data)
     {
-      dummy_buffer.clear();
+      clear_buffer(dummy_buffer);
       return Buffer{td, nullptr, dummy_buffer};
     }
-    return Buffer{td, this, output_data[primary_data].input->data};
+    clear_buffer(buffer);
+    return Buffer{td, this, buffer};
   }
 
   vector<Connection> get_connections() const override
@@ -847,37 +1064,18 @@ public:
     return result;
   }
 
+  // Pass the buffer on to all connected inputs - those at the same rate
+  // share it, others get their own resampled copy
   void complete(const TickData& td)
   {
-    if (!output_data.empty())
+    for (auto& o: output_data)
     {
-      const auto& p = output_data[primary_data];
-
-      for (auto& o: output_data)
-      {
-        if (o.first != primary_data)
-        {
-          const auto nsamples = td.samples_in_tick(o.first->get_sample_rate());
-          if (p.input->data.size() > nsamples)
-          {
-            o.second.input->data.resize(nsamples);
-            downsample(p.input->data, o.second.input->data);
-          }
-          else
-          {
-            o.second.input->data = p.input->data;
-          }
-          o.second.input->ready = true;
-        }
-      }
-      const auto psamples = td.samples_in_tick(primary_data->get_sample_rate());
-      if (p.input->data.size() > psamples)
-      {
-        const auto t = p.input->data;
-        p.input->data.resize(psamples);
-        downsample(t, p.input->data);
-      }
-      p.input->ready = true;
+      auto& input = *o.second.input;
+      const auto nsamples = td.samples_in_tick(o.first->get_sample_rate());
+      if (!resample_tick(buffer, input.data, nsamples,
+                         o.first->get_resampling(), input.resample_state))
+        input.shared = &buffer;
+      input.ready = true;
     }
   }
 
@@ -1808,15 +2006,69 @@ private:
     auto outputs = make_tuple(get<Oc>(os).get_buffer(td)...);
     (void)outputs;
     // Resize all outputs to wanted size
-    int dummy[] = {0, (void(get<Oc>(outputs).data.resize(count)), 0)...};
+    int dummy[] = {0, (void(resize_buffer(get<Oc>(outputs).data, count)),
+                       0)...};
     (void)dummy;
-    for (auto i = 0u; i < count; ++i)
+
+    if (all_of_inputs({get<Ic>(inputs).empty()...}))
+    {
+      // All constant - fetch once into locals so anything derived from
+      // them can be hoisted out of the loop
+      const auto values = make_tuple(
+                            safe_input_buffer_get(get<Ic>(is),
+                                                  get<Ic>(inputs), 0)...);
+      (void)values;
+      for (auto i = 0u; i < count; ++i)
+        f(get<Sc>(settings)..., get<Ic>(values)...,
+          get<Oc>(outputs).data[i]...);
+    }
+    else if (all_of_inputs({(get<Ic>(inputs).size() >= count)...}))
     {
-      f(get<Sc>(settings)...,
-        safe_input_buffer_get(get<Ic>(is), get<Ic>(inputs), i)...,
-        get<Oc>(outputs).data[i]...
-       );
+      // All full length - index directly with no checks
+      for (auto i = 0u; i < count; ++i)
+        f(get<Sc>(settings)..., get<Ic>(inputs)[i]...,
+          get<Oc>(outputs).data[i]...);
     }
+    else
+    {
+      for (auto i = 0u; i < count; ++i)
+      {
+        f(get<Sc>(settings)...,
+          safe_input_buffer_get(get<Ic>(is), get<Ic>(inputs), i)...,
+          get<Oc>(outputs).data[i]...
+         );
+      }
+    }
+  }
+
+  static bool all_of_inputs(initializer_list<bool> conditions)
+  {
+    for (const auto c: conditions)
+      if (!c) return false;
+    return true;
+  }
+
+  template<typename... Ss, size_t... Sc, typename... Is, size_t... Ic,
+           typename... Os, size_t... Oc, typename F>
+  void block_iterate_impl(const TickData& td, unsigned int count,
+                          const tuple<Ss...>& ss, index_sequence<Sc...>,
+                          const tuple<Is...>& is, index_sequence<Ic...>,
+                          const tuple<Os...>& os, index_sequence<Oc...>,
+                          const F& f)
+  {
+    auto settings = tie(get<Sc>(ss).get()...);
+    (void)settings;
+    auto inputs = make_tuple(get<Ic>(is).get_block(count)...);
+    (void)inputs;
+    auto outputs = make_tuple(get<Oc>(os).get_buffer(td)...);
+    (void)outputs;
+    // Resize all outputs to wanted size
+    int dummy[] = {0, (void(resize_buffer(get<Oc>(outputs).data, count)),
+                       0)...};
+    (void)dummy;
+    f(count, get<Sc>(settings)...,
+      get<Ic>(inputs)...,
+      get<Oc>(outputs).data.data()...);
   }
 
   // Get a default constructed clone
@@ -1836,6 +2088,23 @@ protected:
                         f);
   }
 
+  // Block processing alternative to sample_iterate - calls f once with
+  // the sample count, settings, a contiguous 'const T *' for each input
+  // (padded to count) and a 'T *' for each output, so the loop inside
+  // can be vectorised
+  template<typename... Ss, typename... Is, typename... Os, typename F>
+  void block_iterate(const TickData& td, const unsigned count,
+                     const tuple<Ss...>& ss,
+                     const tuple<Is...>& is, const tuple<Os...>& os,
+                     const F& f)
+  {
+    block_iterate_impl(td, count,
+                       ss, index_sequence_for<Ss...>{},
+                       is, index_sequence_for<Is...>{},
+                       os, index_sequence_for<Os...>{},
+                       f);
+  }
+
   // Register an input
   void register_input(ElementInput *input)
   {
@@ -1859,8 +2128,15 @@ public:
   // Handle sample rate change
   void update_sample_rate() override;
 
+  // Does this element wait for its inputs before ticking?  Elements which
+  // can live in a loop (e.g. core/memory) override this to return false
+  virtual bool waits_for_inputs() const { return true; }
+
+  // Get elements which must tick before this one
+  vector<GraphElement *> get_tick_sources() const;
+
   // Is ready to process tick
-  virtual bool ready() const;
+  bool ready() const;
 
   // Tick
   virtual void tick(const TickData& /*tick data*/) {}
@@ -2589,34 +2865,232 @@ public:
   }
 };
 
+//==========================================================================
+// Tick timing histogram - log scale in nanoseconds, with four buckets per
+// octave, so percentiles are accurate to within about 20%
+class TickHistogram
+{
+private:
+  static const auto octaves = 40;  // Up to ~18 minutes!
+  static const auto buckets_per_octave = 4;
+  array<uint32_t, octaves * buckets_per_octave> buckets{};
+  uint64_t count = 0;
+  uint64_t total = 0;
+  uint64_t max = 0;
+
+public:
+  //------------------------------------------------------------------------
+  // Add a sample
+  void add(uint64_t ns);
+
+  //------------------------------------------------------------------------
+  // Get number of samples, and total and maximum time in ns
+  uint64_t get_count() const { return count; }
+  uint64_t get_total() const { return total; }
+  uint64_t get_max() const { return max; }
+
+  //------------------------------------------------------------------------
+  // Get the time at or below which the given fraction (0-1) of samples
+  // lie, in ns - upper bound of the bucket it falls in
+  uint64_t get_percentile(double fraction) const;
+};
+
+//==========================================================================
+// Work-stealing deque of element indices (Chase-Lev)
+// The owning thread pushes and pops at the bottom, other threads steal from
+// the top.  Capacity is fixed and indices are not wrapped, so it must be
+// cleared (while no threads are using it) before each round of pushes
+class WorkStealingDeque
+{
+private:
+  unique_ptr<atomic<unsigned>[]> items;
+  atomic<int64_t> top{0};
+  atomic<int64_t> bottom{0};
+
+public:
+  //------------------------------------------------------------------------
+  // Set capacity - not thread safe
+  void resize(unsigned capacity)
+  {
+    items.reset(new atomic<unsigned>[capacity]);
+    clear();
+  }
+
+  //------------------------------------------------------------------------
+  // Clear - not thread safe
+  void clear()
+  {
+    top.store(0, memory_order_relaxed);
+    bottom.store(0, memory_order_relaxed);
+  }
+
+  //------------------------------------------------------------------------
+  // Push an item - owner only
+  void push(unsigned item)
+  {
+    const auto b = bottom.load(memory_order_relaxed);
+    items[b].store(item, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    bottom.store(b + 1, memory_order_relaxed);
+  }
+
+  //------------------------------------------------------------------------
+  // Pop an item - owner only.  Returns whether one was available
+  bool pop(unsigned& item)
+  {
+    const auto b = bottom.load(memory_order_relaxed) - 1;
+    bottom.store(b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    auto t = top.load(memory_order_relaxed);
+    if (t > b)
+    {
+      bottom.store(b + 1, memory_order_relaxed);
+      return false;
+    }
+
+    item = items[b].load(memory_order_relaxed);
+    if (t == b)
+    {
+      // Last one - race against thieves for it
+      const auto won = top.compare_exchange_strong(t, t + 1,
+                                                   memory_order_seq_cst,
+                                                   memory_order_relaxed);
+      bottom.store(b + 1, memory_order_relaxed);
+      return won;
+    }
+    return true;
+  }
+
+  //------------------------------------------------------------------------
+  // Steal an item - any thread.  Returns whether one was taken
+  bool steal(unsigned& item)
+  {
+    auto t = top.load(memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    const auto b = bottom.load(memory_order_acquire);
+    if (t >= b)
+      return false;
+
+    item = items[t].load(memory_order_relaxed);
+    return top.compare_exchange_strong(t, t + 1,
+                                       memory_order_seq_cst,
+                                       memory_order_relaxed);
+  }
+};
+
 //==========================================================================
 // Engine class - wrapper containing Graph tree and Element registry
 class Engine: public VisitorAcceptor
 {
+public:
+  // Multi-threaded tick schedulers
+  enum class Scheduler
+  {
+    shared,         // Shared element list, scanned for ready under a lock
+    work_stealing   // Dependency counters with per-thread deques
+  };
+
+  // Statistics on the tick schedule
+  struct ScheduleStats
+  {
+    unsigned elements = 0;          // Total
+    unsigned deadlocked = 0;        // Never ticked, in unbroken loops
+    unsigned tasks = 0;             // Units of work for threads
+    unsigned chains = 0;            // Tasks with more than one element
+    unsigned chained_elements = 0;  // Elements in chains
+    unsigned longest_chain = 0;     // Elements in longest task
+    unsigned critical_path = 0;     // Elements on longest dependent path
+    unsigned roots = 0;             // Tasks with no dependencies
+    unsigned threads = 0;           // Tick threads, 0 if ticked serially
+    Scheduler scheduler = Scheduler::shared;
+  };
+
+  // Tick profile
+  struct ElementProfile
+  {
+    string id;
+    string type;
+    TickHistogram histogram;
+    ElementProfile(const string& _id, const string& _type):
+      id{_id}, type{_type}
+    {}
+  };
+  struct Profile
+  {
+    bool enabled = false;
+    TickHistogram ticks;
+    vector<ElementProfile> elements;
+  };
+
+  // Policy for catching up when ticks fall behind real time
+  enum class CatchUp
+  {
+    drop,     // Skip all missed ticks
+    burst,    // Run up to a maximum of missed ticks at once, skip the rest
+    stretch   // As burst, but delay tick time rather than skipping ticks
+  };
+
+  // Tick timing statistics
+  struct TimingStats
+  {
+    uint64_t ticks = 0;            // Run
+    uint64_t late_calls = 0;       // Calls with more than one tick due
+    uint64_t skipped_ticks = 0;    // Dropped by drop or burst
+    uint64_t stretched_ticks = 0;  // Delayed by stretch
+    TickHistogram lateness;        // Of first tick due in each call
+    TickHistogram wake_jitter;     // Of main loop after waiting for a tick
+  };
+
 private:
   // Graph structure
   mutable MT::RWMutex graph_mutex;
   unique_ptr<Dataflow::Graph> graph;
-  vector<Element *> tick_elements;
+  vector<Element *> tick_elements;  // In dependency order
+  vector<Element *>::size_type tick_schedule_size = 0; // Excludes deadlocked
+  vector<unsigned> tick_tasks;               // Start of each, plus end
+  vector<unsigned> tick_dependencies;        // Source tasks, by task
+  vector<vector<unsigned>> tick_successors;  // Dependent tasks, by task
+  vector<unsigned> tick_roots;               // Tasks with no dependencies
+  Scheduler scheduler = Scheduler::shared;
+  mutable MT::Mutex schedule_stats_mutex;
+  ScheduleStats schedule_stats;
   struct ParallelState
   {
     atomic<bool> shutdown{false};
     deque<MT::Condition> go;
-    MT::Mutex complete_threads_mutex;
-    vector<bool> complete_threads;
     MT::Condition complete;
     TickData td;
+
+    // Shared scheduler
+    MT::Mutex complete_threads_mutex;
+    vector<bool> complete_threads;
     MT::Mutex tick_elements_mutex;
-    vector<Element *>& tick_elements;
+    vector<unsigned> tick_elements;  // Indices into Engine::tick_elements
     unsigned ticked = 0;
-    ParallelState(vector<Element *>& _tick_elements):
-      tick_elements{_tick_elements}
-    {}
-  } parallel_state{tick_elements};
+
+    // Work-stealing scheduler
+    deque<WorkStealingDeque> deques;
+    unique_ptr<atomic<unsigned>[]> pending;  // Source tasks still to tick
+    unsigned capacity = 0;
+    atomic<unsigned> outstanding{0};         // Tasks still to tick
+    atomic<unsigned> running{0};             // Threads still in tick
+  } parallel_state;
   vector<thread> threads;
+
+  // Profiling - times are recorded by index in tick_elements during the
+  // tick, then added to the histograms under the mutex afterwards
+  bool profiling = false;
+  vector<uint64_t> profile_times;
+  mutable MT::Mutex profile_mutex;
+  Profile profile;
+
   Time::Duration tick_interval = default_tick_interval;
   Time::Duration start_time;
   uint64_t tick_number{0};
+  CatchUp catch_up = CatchUp::burst;
+  unsigned max_catch_up = 2;
+  mutable MT::Mutex timing_mutex;
+  TimingStats timing_stats;
   SetupContext context;
 
   //------------------------------------------------------------------------
@@ -2632,6 +3106,32 @@ private:
   // parallel tick of elements
   void parallel_tick_elements(const TickData& td);
 
+  //------------------------------------------------------------------------
+  // Tick a single element, by index, timing it if profiling
+  void tick_element(unsigned i, const TickData& td)
+  {
+    if (profiling)
+    {
+      const auto start = chrono::steady_clock::now();
+      tick_elements[i]->tick(td);
+      profile_times[i] = chrono::duration_cast<chrono::nanoseconds>(
+                           chrono::steady_clock::now() - start).count();
+    }
+    else
+    {
+      tick_elements[i]->tick(td);
+    }
+  }
+
+  //------------------------------------------------------------------------
+  // Reset profile for current elements
+  void reset_profile();
+
+  //------------------------------------------------------------------------
+  // Thread functions for each scheduler
+  void shared_tick_thread(unsigned n);
+  void work_stealing_tick_thread(unsigned n);
+
 public:
   Registry element_registry;
 
@@ -2643,14 +3143,45 @@ public:
   }
 
   //------------------------------------------------------------------------
-  // Set the number of threads
-  void set_threads(unsigned threads);
+  // Set the number of threads and how they are scheduled
+  void set_threads(unsigned threads, Scheduler scheduler = Scheduler::shared);
 
   //------------------------------------------------------------------------
   // Set/get the tick interval
   void set_tick_interval(const Time::Duration& d) { tick_interval = d; }
   Time::Duration get_tick_interval() const { return tick_interval; }
 
+  //------------------------------------------------------------------------
+  // Set catch-up policy, and maximum missed ticks to run in one go
+  void set_catch_up(CatchUp policy, unsigned max_ticks = 2)
+  {
+    catch_up = policy;
+    max_catch_up = max_ticks;
+  }
+
+  //------------------------------------------------------------------------
+  // Get the time the next tick is due, in the same terms as tick()
+  Time::Duration get_next_tick_time() const
+  {
+    return start_time + tick_interval * tick_number;
+  }
+
+  //------------------------------------------------------------------------
+  // Record how late the main loop woke after waiting for a tick
+  void record_wake_jitter(uint64_t ns)
+  {
+    MT::Lock lock{timing_mutex};
+    timing_stats.wake_jitter.add(ns);
+  }
+
+  //------------------------------------------------------------------------
+  // Get tick timing statistics
+  TimingStats get_timing_stats() const
+  {
+    MT::Lock lock{timing_mutex};
+    return timing_stats;
+  }
+
   //------------------------------------------------------------------------
   // Set resource directory
   void set_resource_dir(const File::Directory& dir)
@@ -2679,6 +3210,18 @@ public:
   // Update element list
   void update_elements();
 
+  //------------------------------------------------------------------------
+  // Get statistics on the tick schedule
+  ScheduleStats get_schedule_stats() const;
+
+  //------------------------------------------------------------------------
+  // Enable/disable per-element tick profiling - enabling resets the profile
+  void enable_profiling(bool enable);
+
+  //------------------------------------------------------------------------
+  // Get a copy of the tick profile
+  Profile get_profile() const;
+
   //------------------------------------------------------------------------
   // Tick the graph
   void tick(const Time::Duration& t);
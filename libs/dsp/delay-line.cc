@@ -0,0 +1,42 @@
+//==========================================================================
+// ViGraph DSP library: delay-line.cc
+//
+// Power-of-two circular delay line
+//
+// Copyright (c) 2019 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-dsp.h"
+#include <algorithm>
+
+namespace ViGraph { namespace DSP {
+
+//--------------------------------------------------------------------------
+// Make sure we can read delays up to max_delay
+void DelayLine::ensure(size_t max_delay)
+{
+  // Need the delayed sample and the one after it for interpolation
+  const auto needed = max_delay + 2;
+  if (needed <= buffer.size()) return;
+
+  auto size = size_t{1};
+  while (size < needed) size <<= 1;
+
+  // Unroll existing history oldest first, so delays are preserved
+  auto grown = vector<float>(size);
+  for (auto i = 0u; i < buffer.size(); ++i)
+    grown[i] = buffer[(pos + i) & mask];
+
+  pos = buffer.size() & (size - 1);
+  mask = size - 1;
+  buffer.swap(grown);
+}
+
+//--------------------------------------------------------------------------
+// Clear to silence
+void DelayLine::clear()
+{
+  fill(buffer.begin(), buffer.end(), 0.0f);
+}
+
+}} // namespaces
@@ -0,0 +1,61 @@
+//==========================================================================
+// ViGraph DSP library: fdn-reverb.cc
+//
+// Feedback delay network reverb
+//
+// Copyright (c) 2019 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-dsp.h"
+
+namespace ViGraph { namespace DSP {
+
+namespace {
+
+// Line lengths relative to the longest - spread out and unrelated so
+// their echoes don't pile up on each other
+const FDNReverb::Lines line_ratios =
+  { 1.000f, 0.919f, 0.847f, 0.781f, 0.713f, 0.659f, 0.601f, 0.547f };
+
+// Diffuser delays in seconds, and gain
+const array<double, FDNReverb::ndiffusers> diffuser_times =
+  { 0.0048, 0.0036, 0.0127, 0.0093 };
+const auto diffuser_gain = 0.7f;
+
+}
+
+const size_t FDNReverb::nlines;
+const size_t FDNReverb::ndiffusers;
+constexpr float FDNReverb::damping;
+constexpr float FDNReverb::gain;
+
+//--------------------------------------------------------------------------
+// Set the sample rate
+void FDNReverb::set_sample_rate(double sample_rate, double spread)
+{
+  for (auto k = 0u; k < nlines; ++k)
+    ratios[k] = line_ratios[k] * (1.0 + spread);
+  for (auto i = 0u; i < ndiffusers; ++i)
+    diffusers[i].set(static_cast<size_t>(diffuser_times[i] * sample_rate
+                                         * (1.0 + spread)),
+                     diffuser_gain);
+}
+
+//--------------------------------------------------------------------------
+// Make sure the lines can take the given time
+void FDNReverb::ensure(double max_time)
+{
+  for (auto k = 0u; k < nlines; ++k)
+    lines[k].ensure(static_cast<size_t>(max(max_time * ratios[k], 1.0)));
+}
+
+//--------------------------------------------------------------------------
+// Clear to silence
+void FDNReverb::clear()
+{
+  for (auto& line: lines) line.clear();
+  for (auto& d: diffusers) d.clear();
+  damped.fill(0.0f);
+}
+
+}} // namespaces
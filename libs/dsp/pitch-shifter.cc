@@ -0,0 +1,68 @@
+//==========================================================================
+// ViGraph DSP library: pitch-shifter.cc
+//
+// Dual-tap delay line pitch shifter
+//
+// Copyright (c) 2019 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-dsp.h"
+
+namespace ViGraph { namespace DSP {
+
+//--------------------------------------------------------------------------
+// Set the window length and number of channels
+void PitchShifter::setup(double window_samples, unsigned nchannels)
+{
+  window = max(window_samples, 2.0);
+  if (lines.size() < nchannels)
+    lines.resize(nchannels);
+  for (auto& line: lines)
+    line.ensure(static_cast<size_t>(window) + 1);
+}
+
+//--------------------------------------------------------------------------
+// Process some samples
+void PitchShifter::process(const float *const *in, float *const *out,
+                           unsigned nchannels, size_t n,
+                           const double *ratios)
+{
+  // Work out the taps once for all channels
+  taps.resize(n);
+  for (auto i = 0u; i < n; ++i)
+  {
+    // Second tap is half a window on
+    auto p2 = phase + 0.5;
+    if (p2 >= 1.0) p2 -= 1.0;
+    const auto s1 = sin(M_PI * phase);
+    const auto s2 = sin(M_PI * p2);
+    taps[i] = {{ { phase * window, static_cast<float>(s1 * s1) },
+                 { p2 * window, static_cast<float>(s2 * s2) } }};
+
+    // Delay shrinks (reading faster) to shift up, grows to shift down
+    phase += (1.0 - ratios[i]) / window;
+    phase -= floor(phase);
+  }
+
+  for (auto c = 0u; c < nchannels; ++c)
+  {
+    auto o = out[c];
+    if (c >= lines.size())
+    {
+      fill(o, o + n, 0.0f);
+      continue;
+    }
+
+    auto& line = lines[c];
+    const auto s = in[c];
+    for (auto i = 0u; i < n; ++i)
+    {
+      line.write(s[i]);
+      const auto& t = taps[i];
+      o[i] = line.read(t[0].delay) * t[0].gain
+           + line.read(t[1].delay) * t[1].gain;
+    }
+  }
+}
+
+}} // namespaces
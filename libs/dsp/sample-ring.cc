@@ -0,0 +1,25 @@
+//==========================================================================
+// ViGraph DSP library: sample-ring.cc
+//
+// Lock-free single-producer, single-consumer sample ring
+//
+// Copyright (c) 2019 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-dsp.h"
+
+namespace ViGraph { namespace DSP {
+
+//--------------------------------------------------------------------------
+// Set the capacity
+void SampleRing::resize(size_t capacity)
+{
+  auto size = size_t{1};
+  while (size < capacity) size <<= 1;
+  buffer.assign(size, 0.0f);
+  mask = size - 1;
+  write_pos = 0;
+  read_pos = 0;
+}
+
+}} // namespaces
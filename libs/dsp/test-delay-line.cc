@@ -0,0 +1,86 @@
+//==========================================================================
+// ViGraph DSP library: test-delay-line.cc
+//
+// Tests for delay line
+//
+// Copyright (c) 2019 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-dsp.h"
+#include <gtest/gtest.h>
+
+namespace {
+
+using namespace ViGraph;
+using namespace ViGraph::DSP;
+
+TEST(DelayLineTest, TestSizeIsPowerOfTwo)
+{
+  DelayLine line{100};
+  EXPECT_EQ(128, line.get_size());
+  EXPECT_EQ(126, line.get_max_delay());
+  line.ensure(50);
+  EXPECT_EQ(128, line.get_size());
+}
+
+TEST(DelayLineTest, TestWholeDelays)
+{
+  DelayLine line{10};
+  for (auto i = 1; i <= 20; ++i)
+    line.write(i);
+  EXPECT_EQ(20.0, line.read(size_t{0}));
+  EXPECT_EQ(19.0, line.read(size_t{1}));
+  EXPECT_EQ(11.0, line.read(size_t{9}));
+}
+
+TEST(DelayLineTest, TestFractionalDelaysInterpolate)
+{
+  DelayLine line{10};
+  for (auto i = 1; i <= 20; ++i)
+    line.write(i);
+  EXPECT_FLOAT_EQ(19.5, line.read(0.5));
+  EXPECT_FLOAT_EQ(17.25, line.read(2.75));
+}
+
+TEST(DelayLineTest, TestGrowingKeepsHistory)
+{
+  DelayLine line{4};
+  for (auto i = 1; i <= 6; ++i)
+    line.write(i);
+  line.ensure(100);
+  EXPECT_EQ(128, line.get_size());
+  EXPECT_EQ(6.0, line.read(size_t{0}));
+  EXPECT_EQ(3.0, line.read(size_t{3}));
+  line.write(7);
+  EXPECT_EQ(7.0, line.read(size_t{0}));
+  EXPECT_EQ(4.0, line.read(size_t{3}));
+}
+
+TEST(DelayLineTest, TestClear)
+{
+  DelayLine line{4};
+  line.write(1);
+  line.clear();
+  EXPECT_EQ(0.0, line.read(size_t{0}));
+}
+
+TEST(DelayLineTest, TestGlideSmoothsJumps)
+{
+  Glide glide;
+  glide.set_time(10);
+  EXPECT_EQ(5.0, glide.next(5.0));
+  const auto v = glide.next(15.0);
+  EXPECT_LT(5.0, v);
+  EXPECT_GT(15.0, v);
+  for (auto i = 0; i < 1000; ++i)
+    glide.next(15.0);
+  EXPECT_NEAR(15.0, glide.get(), 1e-6);
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,84 @@
+//==========================================================================
+// ViGraph DSP library: test-fdn-reverb.cc
+//
+// Tests for feedback delay network reverb
+//
+// Copyright (c) 2019 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-dsp.h"
+#include <gtest/gtest.h>
+
+namespace {
+
+using namespace ViGraph;
+using namespace ViGraph::DSP;
+
+const auto sample_rate = 10000.0;
+
+// Energy of the impulse response in a window of samples
+vector<double> impulse_energy(double time, float feedback,
+                              size_t window, size_t nwindows)
+{
+  FDNReverb reverb;
+  reverb.set_sample_rate(sample_rate);
+  reverb.ensure(time);
+  auto energy = vector<double>(nwindows);
+  for (auto i = 0u; i < window * nwindows; ++i)
+  {
+    const auto v = reverb.process(i ? 0.0f : 1.0f, time, feedback);
+    energy[i / window] += v * v;
+  }
+  return energy;
+}
+
+TEST(FDNReverbTest, TestSilenceInSilenceOut)
+{
+  FDNReverb reverb;
+  reverb.set_sample_rate(sample_rate);
+  reverb.ensure(1000);
+  for (auto i = 0; i < 10000; ++i)
+    EXPECT_EQ(0.0f, reverb.process(0.0f, 1000, 0.9f));
+}
+
+TEST(FDNReverbTest, TestImpulseGivesDecayingTail)
+{
+  const auto energy = impulse_energy(500, 0.9f, 2000, 10);
+  EXPECT_LT(0.0, energy[0]);
+  EXPECT_LT(0.0, energy[5]);
+  for (auto i = 1u; i < energy.size(); ++i)
+    EXPECT_GT(energy[i-1], energy[i]) << i;
+}
+
+TEST(FDNReverbTest, TestMoreFeedbackRingsLonger)
+{
+  const auto short_tail = impulse_energy(500, 0.5f, 2000, 5);
+  const auto long_tail = impulse_energy(500, 0.95f, 2000, 5);
+  EXPECT_LT(short_tail[4], long_tail[4]);
+}
+
+TEST(FDNReverbTest, TestFullFeedbackStaysBounded)
+{
+  const auto energy = impulse_energy(300, 1.0f, 10000, 5);
+  for (auto e: energy)
+    EXPECT_GT(1.0, e);
+}
+
+TEST(FDNReverbTest, TestClear)
+{
+  FDNReverb reverb;
+  reverb.set_sample_rate(sample_rate);
+  reverb.ensure(100);
+  reverb.process(1.0f, 100, 0.9f);
+  reverb.clear();
+  for (auto i = 0; i < 1000; ++i)
+    EXPECT_EQ(0.0f, reverb.process(0.0f, 100, 0.9f));
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,100 @@
+//==========================================================================
+// ViGraph DSP library: test-pitch-shifter.cc
+//
+// Tests for pitch shifter
+//
+// Copyright (c) 2019 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-dsp.h"
+#include <gtest/gtest.h>
+
+namespace {
+
+using namespace ViGraph;
+using namespace ViGraph::DSP;
+
+const auto sample_rate = 10000.0;
+
+// Run a sine through at the given ratio and count zero crossings in the
+// output after it has settled
+unsigned count_crossings(double ratio, double frequency)
+{
+  const auto n = 20000u;
+  auto input = vector<float>(n);
+  for (auto i = 0u; i < n; ++i)
+    input[i] = sin(2 * M_PI * frequency * i / sample_rate);
+  auto output = vector<float>(n);
+  const auto ratios = vector<double>(n, ratio);
+
+  PitchShifter shifter;
+  shifter.setup(500, 1);
+  const float *in[] = { input.data() };
+  float *out[] = { output.data() };
+  shifter.process(in, out, 1, n, ratios.data());
+
+  auto crossings = 0u;
+  for (auto i = 10001u; i < n; ++i)
+    if ((output[i-1] < 0) != (output[i] < 0)) crossings++;
+  return crossings;
+}
+
+TEST(PitchShifterTest, TestUnityIsPureDelay)
+{
+  PitchShifter shifter;
+  shifter.setup(100, 2);
+  EXPECT_EQ(50, shifter.get_latency());
+
+  auto left = vector<float>(200);
+  auto right = vector<float>(200);
+  left[10] = 1.0;
+  right[20] = -1.0;
+  auto left_out = vector<float>(200);
+  auto right_out = vector<float>(200);
+  const auto ratios = vector<double>(200, 1.0);
+  const float *in[] = { left.data(), right.data() };
+  float *out[] = { left_out.data(), right_out.data() };
+  shifter.process(in, out, 2, 200, ratios.data());
+
+  for (auto i = 0u; i < 200; ++i)
+  {
+    EXPECT_NEAR(i == 60 ? 1.0 : 0.0, left_out[i], 1e-6) << i;
+    EXPECT_NEAR(i == 70 ? -1.0 : 0.0, right_out[i], 1e-6) << i;
+  }
+}
+
+TEST(PitchShifterTest, TestOctaveUpDoublesFrequency)
+{
+  const auto crossings = count_crossings(2.0, 100);
+  // 100Hz for 1 second is 200 crossings, so expect around 400
+  EXPECT_NEAR(400, crossings, 20);
+}
+
+TEST(PitchShifterTest, TestOctaveDownHalvesFrequency)
+{
+  const auto crossings = count_crossings(0.5, 200);
+  EXPECT_NEAR(200, crossings, 20);
+}
+
+TEST(PitchShifterTest, TestExtraChannelsAreSilent)
+{
+  PitchShifter shifter;
+  shifter.setup(100, 1);
+  auto input = vector<float>(10, 1.0f);
+  auto out0 = vector<float>(10);
+  auto out1 = vector<float>(10, 1.0f);
+  const auto ratios = vector<double>(10, 1.0);
+  const float *in[] = { input.data(), input.data() };
+  float *out[] = { out0.data(), out1.data() };
+  shifter.process(in, out, 2, 10, ratios.data());
+  for (auto v: out1)
+    EXPECT_EQ(0.0, v);
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
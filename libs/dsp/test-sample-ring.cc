@@ -0,0 +1,115 @@
+//==========================================================================
+// ViGraph DSP library: test-sample-ring.cc
+//
+// Tests for lock-free sample ring
+//
+// Copyright (c) 2019 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-dsp.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace {
+
+using namespace ViGraph;
+using namespace ViGraph::DSP;
+
+TEST(SampleRingTest, TestCapacityIsPowerOfTwo)
+{
+  SampleRing ring{100};
+  EXPECT_EQ(128, ring.get_capacity());
+  EXPECT_EQ(0, ring.available());
+}
+
+TEST(SampleRingTest, TestWriteAndReadAcrossWrap)
+{
+  SampleRing ring{8};
+  float out[6];
+  for (auto pass = 0; pass < 5; ++pass)
+  {
+    const float in[6] = { 1, 2, 3, 4, 5, static_cast<float>(pass) };
+    ASSERT_TRUE(ring.write(in, 6));
+    EXPECT_EQ(6, ring.available());
+    ASSERT_TRUE(ring.read(out, 6));
+    for (auto i = 0; i < 6; ++i)
+      EXPECT_EQ(in[i], out[i]) << pass << ":" << i;
+  }
+  EXPECT_EQ(0, ring.get_underruns());
+  EXPECT_EQ(0, ring.get_overruns());
+}
+
+TEST(SampleRingTest, TestOverrunWritesNothing)
+{
+  SampleRing ring{8};
+  const float in[6] = { 1, 2, 3, 4, 5, 6 };
+  ASSERT_TRUE(ring.write(in, 6));
+  EXPECT_FALSE(ring.write(in, 6));
+  EXPECT_EQ(1, ring.get_overruns());
+  EXPECT_EQ(6, ring.available());
+}
+
+TEST(SampleRingTest, TestUnderrunReadsNothing)
+{
+  SampleRing ring{8};
+  const float in[2] = { 1, 2 };
+  ASSERT_TRUE(ring.write(in, 2));
+  float out[4];
+  EXPECT_FALSE(ring.read(out, 4));
+  EXPECT_EQ(1, ring.get_underruns());
+  EXPECT_EQ(2, ring.available());
+}
+
+TEST(SampleRingTest, TestPeekAndSkip)
+{
+  SampleRing ring{8};
+  const float in[4] = { 1, 2, 3, 4 };
+  ASSERT_TRUE(ring.write(in, 4));
+  float out[8];
+  EXPECT_EQ(4, ring.peek(out, 8));
+  EXPECT_EQ(4, ring.available());
+  EXPECT_EQ(3, out[2]);
+  ring.skip(3);
+  EXPECT_EQ(1, ring.available());
+  ring.skip(3);
+  EXPECT_EQ(0, ring.available());
+}
+
+TEST(SampleRingTest, TestProducerAndConsumerThreads)
+{
+  SampleRing ring{64};
+  const auto total = 100000u;
+  thread producer([&ring, total]()
+  {
+    for (auto i = 0u; i < total; )
+    {
+      const float in[2] = { static_cast<float>(i), static_cast<float>(i+1) };
+      if (ring.write(in, 2))
+        i += 2;
+      else
+        this_thread::yield();
+    }
+  });
+
+  auto errors = 0u;
+  for (auto i = 0u; i < total; )
+  {
+    float out[2];
+    if (ring.read(out, 2))
+    {
+      if (out[0] != i || out[1] != i+1) errors++;
+      i += 2;
+    }
+    else this_thread::yield();
+  }
+  producer.join();
+  EXPECT_EQ(0, errors);
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,393 @@
+//==========================================================================
+// ViGraph DSP library: vg-dsp.h
+//
+// Audio signal processing building blocks
+//
+// Copyright (c) 2019 Paul Clark.  All rights reserved
+//==========================================================================
+
+#ifndef __VG_DSP_H
+#define __VG_DSP_H
+
+#include <vector>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <algorithm>
+
+namespace ViGraph { namespace DSP {
+
+// Make our lives easier without polluting anyone else
+using namespace std;
+
+//==========================================================================
+// Delay line - circular buffer of power-of-two size, so wrapping is a
+// mask rather than a modulo.  Sized up front and only ever grows, so
+// steady state processing never allocates.
+// Delay 0 is the most recently written sample
+class DelayLine
+{
+  vector<float> buffer;
+  size_t mask{0};
+  size_t pos{0};       // Next position to write
+
+public:
+  //------------------------------------------------------------------------
+  // Constructors
+  DelayLine() {}
+  DelayLine(size_t max_delay) { ensure(max_delay); }
+
+  //------------------------------------------------------------------------
+  // Make sure we can read delays up to max_delay (plus one, for
+  // interpolation) - grows the buffer if required, keeping history
+  void ensure(size_t max_delay);
+
+  //------------------------------------------------------------------------
+  // Get the maximum delay we can read with interpolation
+  size_t get_max_delay() const
+  { return buffer.size() > 1 ? buffer.size() - 2 : 0; }
+
+  //------------------------------------------------------------------------
+  // Get the current buffer size (for testing)
+  size_t get_size() const { return buffer.size(); }
+
+  //------------------------------------------------------------------------
+  // Clear to silence, keeping the storage
+  void clear();
+
+  //------------------------------------------------------------------------
+  // Write a sample
+  void write(float sample)
+  {
+    buffer[pos] = sample;
+    pos = (pos + 1) & mask;
+  }
+
+  //------------------------------------------------------------------------
+  // Read a sample a whole number of samples ago
+  float read(size_t delay) const
+  {
+    return buffer[(pos - 1 - delay) & mask];
+  }
+
+  //------------------------------------------------------------------------
+  // Read a sample a fractional number of samples ago, linearly interpolated
+  float read(double delay) const
+  {
+    const auto whole = static_cast<size_t>(delay);
+    const auto frac = static_cast<float>(delay - whole);
+    const auto a = read(whole);
+    const auto b = read(whole + 1);
+    return a + (b - a) * frac;
+  }
+};
+
+//==========================================================================
+// Glide - one-pole smoothing of a control value, so that a jump (e.g. in
+// delay time) becomes a short glide rather than a click.  Starts at the
+// first value given
+class Glide
+{
+  double value{0.0};
+  double coeff{1.0};
+  bool started{false};
+
+public:
+  //------------------------------------------------------------------------
+  // Set the time constant, in samples.  0 disables smoothing
+  void set_time(double samples)
+  {
+    coeff = samples > 1.0 ? 1.0 - exp(-1.0 / samples) : 1.0;
+  }
+
+  //------------------------------------------------------------------------
+  // Move towards the target and get the new value
+  double next(double target)
+  {
+    if (started)
+      value += (target - value) * coeff;
+    else
+    {
+      value = target;
+      started = true;
+    }
+    return value;
+  }
+
+  //------------------------------------------------------------------------
+  // Get the current value
+  double get() const { return value; }
+};
+
+//==========================================================================
+// Allpass diffuser - Schroeder allpass over a fixed delay, smears
+// transients without colouring the spectrum
+class Allpass
+{
+  DelayLine line;
+  size_t delay{1};
+  float gain{0.7f};
+
+public:
+  //------------------------------------------------------------------------
+  // Set up, delay in samples
+  void set(size_t _delay, float _gain)
+  {
+    delay = max<size_t>(_delay, 1);
+    gain = _gain;
+    line.ensure(delay);
+  }
+
+  //------------------------------------------------------------------------
+  // Process a sample
+  float process(float input)
+  {
+    const auto delayed = line.read(delay - 1);
+    const auto w = input + gain * delayed;
+    line.write(w);
+    return delayed - gain * w;
+  }
+
+  //------------------------------------------------------------------------
+  // Clear to silence
+  void clear() { line.clear(); }
+};
+
+//==========================================================================
+// Feedback delay network reverb - input diffused through a chain of
+// allpasses, then circulated round eight delay lines of unrelated lengths
+// mixed by a Hadamard matrix, with gentle high frequency damping.
+// All per-line work is done on fixed width arrays so the compiler can
+// vectorise it across the lines
+class FDNReverb
+{
+public:
+  static const size_t nlines = 8;
+  static const size_t ndiffusers = 4;
+  using Lines = array<float, nlines>;
+
+private:
+  array<DelayLine, nlines> lines;
+  array<Allpass, ndiffusers> diffusers;
+  Lines ratios{};     // Of each line length to the room time
+  Lines damped{};     // Low-pass state for each line
+  static constexpr float damping = 0.8f;
+  static constexpr float gain = 0.35355339f;  // 1/sqrt(nlines)
+
+  //------------------------------------------------------------------------
+  // In-place normalised fast Walsh-Hadamard transform across the lines
+  static void hadamard(Lines& x)
+  {
+    for (auto h = 1u; h < nlines; h *= 2)
+      for (auto i = 0u; i < nlines; i += 2*h)
+        for (auto j = i; j < i+h; ++j)
+        {
+          const auto a = x[j];
+          const auto b = x[j+h];
+          x[j] = a + b;
+          x[j+h] = a - b;
+        }
+    for (auto& v: x) v *= gain;
+  }
+
+public:
+  //------------------------------------------------------------------------
+  // Set the sample rate, which sets up the diffusers, and the spread
+  // (fraction) of line lengths to decorrelate this instance from others
+  void set_sample_rate(double sample_rate, double spread = 0.0);
+
+  //------------------------------------------------------------------------
+  // Make sure the lines can take a room time up to max_time samples
+  void ensure(double max_time);
+
+  //------------------------------------------------------------------------
+  // Clear to silence
+  void clear();
+
+  //------------------------------------------------------------------------
+  // Process a sample, with the longest line at 'time' samples and
+  // 'feedback' gain round the network; returns only the reverberation
+  float process(float input, double time, float feedback)
+  {
+    auto diffused = input;
+    for (auto& d: diffusers)
+      diffused = d.process(diffused);
+
+    Lines out;
+    for (auto k = 0u; k < nlines; ++k)
+      out[k] = lines[k].read(max(time * ratios[k], 1.0) - 1.0);
+
+    for (auto k = 0u; k < nlines; ++k)
+      damped[k] += (out[k] - damped[k]) * damping;
+
+    auto mix = damped;
+    hadamard(mix);
+
+    const auto in = diffused * gain;
+    auto wet = 0.0f;
+    for (auto k = 0u; k < nlines; ++k)
+    {
+      lines[k].write((k & 1 ? -in : in) + mix[k] * feedback);
+      wet += k & 2 ? -out[k] : out[k];
+    }
+
+    return wet * gain;
+  }
+};
+
+//==========================================================================
+// Pitch shifter - reads each channel's delay line through two taps which
+// sweep across a window at a rate set by the pitch ratio, each faded in
+// and out with a Hann window half a window apart so they sum to unity.
+// Latency is half the window; longer windows are smoother but smear
+// transients more.  Works on planar channels with scratch that persists
+// between calls
+class PitchShifter
+{
+  vector<DelayLine> lines;      // One per channel
+  double window{0.0};           // Samples
+  double phase{0.0};            // 0..1 across window, first tap
+  struct Tap
+  {
+    double delay;
+    float gain;
+  };
+  vector<array<Tap, 2>> taps;   // Per sample, shared by all channels
+
+public:
+  //------------------------------------------------------------------------
+  // Set the window length in samples, and the number of channels
+  void setup(double window_samples, unsigned nchannels);
+
+  //------------------------------------------------------------------------
+  // Get the latency in samples
+  double get_latency() const { return window / 2; }
+
+  //------------------------------------------------------------------------
+  // Process n samples of each channel, with per-sample pitch ratios
+  // (2 = octave up).  Channels beyond those set up are silent
+  void process(const float *const *in, float *const *out,
+               unsigned nchannels, size_t n, const double *ratios);
+};
+
+//==========================================================================
+// Sample ring - lock-free single-producer, single-consumer ring of samples
+// for passing audio between the engine and a real-time audio thread.
+// Writes and reads are all-or-nothing so interleaved frames stay aligned;
+// those that can't be satisfied are counted as overruns and underruns
+class SampleRing
+{
+  vector<float> buffer;
+  size_t mask{0};
+  atomic<size_t> write_pos{0};  // Total written, only moved by producer
+  atomic<size_t> read_pos{0};   // Total read, only moved by consumer
+  atomic<uint64_t> overruns{0};
+  atomic<uint64_t> underruns{0};
+
+  //------------------------------------------------------------------------
+  // Copy n samples out from the given position, handling wrap
+  void copy_out(size_t from, float *data, size_t n) const
+  {
+    const auto start = from & mask;
+    const auto first = min(n, buffer.size() - start);
+    copy(buffer.data() + start, buffer.data() + start + first, data);
+    copy(buffer.data(), buffer.data() + (n - first), data + first);
+  }
+
+public:
+  //------------------------------------------------------------------------
+  // Constructors
+  SampleRing() {}
+  SampleRing(size_t capacity) { resize(capacity); }
+
+  //------------------------------------------------------------------------
+  // Set the capacity, rounded up to a power of two, and empty it.
+  // Not thread safe - only use when neither side is running
+  void resize(size_t capacity);
+
+  //------------------------------------------------------------------------
+  // Get the capacity
+  size_t get_capacity() const { return buffer.size(); }
+
+  //------------------------------------------------------------------------
+  // Get the number of samples waiting to be read
+  size_t available() const
+  {
+    return write_pos.load(memory_order_acquire)
+         - read_pos.load(memory_order_acquire);
+  }
+
+  //------------------------------------------------------------------------
+  // Producer: write n samples, or count an overrun and write nothing
+  bool write(const float *data, size_t n)
+  {
+    const auto w = write_pos.load(memory_order_relaxed);
+    const auto r = read_pos.load(memory_order_acquire);
+    if (buffer.size() - (w - r) < n)
+    {
+      overruns++;
+      return false;
+    }
+
+    const auto start = w & mask;
+    const auto first = min(n, buffer.size() - start);
+    copy(data, data + first, buffer.data() + start);
+    copy(data + first, data + n, buffer.data());
+    write_pos.store(w + n, memory_order_release);
+    return true;
+  }
+
+  //------------------------------------------------------------------------
+  // Consumer: read n samples, or count an underrun and read nothing
+  bool read(float *data, size_t n)
+  {
+    const auto r = read_pos.load(memory_order_relaxed);
+    const auto w = write_pos.load(memory_order_acquire);
+    if (w - r < n)
+    {
+      underruns++;
+      return false;
+    }
+
+    copy_out(r, data, n);
+    read_pos.store(r + n, memory_order_release);
+    return true;
+  }
+
+  //------------------------------------------------------------------------
+  // Consumer: copy up to n samples without reading them, returns the
+  // number copied
+  size_t peek(float *data, size_t n) const
+  {
+    const auto r = read_pos.load(memory_order_relaxed);
+    const auto w = write_pos.load(memory_order_acquire);
+    n = min(n, w - r);
+    copy_out(r, data, n);
+    return n;
+  }
+
+  //------------------------------------------------------------------------
+  // Consumer: discard up to n samples
+  void skip(size_t n)
+  {
+    const auto r = read_pos.load(memory_order_relaxed);
+    const auto w = write_pos.load(memory_order_acquire);
+    read_pos.store(r + min(n, w - r), memory_order_release);
+  }
+
+  //------------------------------------------------------------------------
+  // Count an underrun/overrun the caller detected itself
+  void note_underrun() { underruns++; }
+  void note_overrun() { overruns++; }
+
+  //------------------------------------------------------------------------
+  // Get the counters
+  uint64_t get_underruns() const { return underruns.load(); }
+  uint64_t get_overruns() const { return overruns.load(); }
+};
+
+//==========================================================================
+}} //namespaces
+#endif // !__VG_DSP_H
@@ -0,0 +1,291 @@
+//==========================================================================
+// ViGraph Ether Dream protocol library: async.cc
+//
+// Asynchronous operation of the interface from its own I/O thread
+//
+// Copyright (c) 2020 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-etherdream.h"
+#include "ot-log.h"
+
+namespace ViGraph { namespace EtherDream {
+
+static const size_t max_outstanding_commands = 8;
+static const auto idle_poll_interval = chrono::milliseconds(100);
+static const auto max_pace_wait = chrono::milliseconds(5);
+
+//--------------------------------------------------------------------------
+// Start the I/O thread
+void Interface::start_thread(size_t max_queued_frames, size_t buffer_capacity)
+{
+  if (async.io_thread) return;
+
+  async.frames.resize(max(max_queued_frames, static_cast<size_t>(1)));
+  async.queue_head = async.queue_count = 0;
+  async.buffer_capacity = buffer_capacity;
+  async.outstanding.clear();
+  async.unacked_points = 0;
+  async.status_time = chrono::steady_clock::now();
+  async.stop_io_thread = false;
+  async.failed = false;
+  async.io_thread.reset(new thread([this]() { run_io_thread(); }));
+}
+
+//--------------------------------------------------------------------------
+// Queue a frame for the I/O thread
+bool Interface::queue_frame(const vector<Point>& points, double duration)
+{
+  if (!async.io_thread || async.failed || points.empty()) return false;
+
+  auto ok = true;
+  {
+    lock_guard<mutex> lock(async.queue_mutex);
+    const auto nslots = async.frames.size();
+    if (async.queue_count == nslots)
+    {
+      // Drop the oldest - we want the latest on the laser
+      async.queue_head = (async.queue_head+1) % nslots;
+      async.queue_count--;
+      async.frames_dropped++;
+      ok = false;
+    }
+
+    // Slots keep their capacity, so this doesn't allocate once warmed up
+    auto& slot = async.frames[(async.queue_head+async.queue_count) % nslots];
+    slot.points.from(points);
+    slot.point_rate = static_cast<uint32_t>(points.size() / duration + 0.5);
+    async.queue_count++;
+  }
+
+  async.queue_ready.notify_one();
+  return ok;
+}
+
+//--------------------------------------------------------------------------
+// Stop the I/O thread
+void Interface::stop_thread()
+{
+  if (!async.io_thread) return;
+
+  {
+    lock_guard<mutex> lock(async.queue_mutex);
+    async.stop_io_thread = true;
+  }
+  async.queue_ready.notify_one();
+  async.io_thread->join();
+  async.io_thread.reset();
+}
+
+//--------------------------------------------------------------------------
+// Send a command (already written to the channel) and note that we expect
+// a response to it
+void Interface::send_command(uint8_t command, size_t points)
+{
+  async.outstanding.push_back({command, points});
+  async.unacked_points += points;
+}
+
+//--------------------------------------------------------------------------
+// Read and process the response to the oldest outstanding command
+// Returns false, marking us failed, if the channel failed
+bool Interface::process_response()
+{
+  uint8_t response;
+  if (!read_response(response))
+  {
+    Log::Error log;
+    log << "Ether Dream connection failed - stopping output\n";
+    async.failed = true;
+    return false;
+  }
+
+  async.status_time = chrono::steady_clock::now();
+  if (!async.outstanding.empty())
+  {
+    // Status now includes any points from this one, if it was accepted
+    async.unacked_points -= async.outstanding.front().points;
+    async.outstanding.pop_front();
+  }
+
+  check_response(response);
+  return true;
+}
+
+//--------------------------------------------------------------------------
+// Is a command of the given type waiting for its response?
+bool Interface::is_outstanding(uint8_t command) const
+{
+  for(const auto& c: async.outstanding)
+    if (c.command == command) return true;
+  return false;
+}
+
+//--------------------------------------------------------------------------
+// Estimate the device buffer fullness now, from the last status, points
+// sent since, and time elapsed if it is playing
+double Interface::estimate_fullness() const
+{
+  double fullness = last_status.buffer_fullness + async.unacked_points;
+  if (last_status.playback_state == Status::PlaybackState::playing)
+  {
+    const chrono::duration<double> elapsed =
+      chrono::steady_clock::now() - async.status_time;
+    fullness -= elapsed.count() * last_status.point_rate;
+  }
+  return max(fullness, 0.0);
+}
+
+//--------------------------------------------------------------------------
+// Start playing if not already
+void Interface::begin_playback(uint32_t point_rate)
+{
+  if (last_status.playback_state != Status::PlaybackState::playing
+      && !is_outstanding('b'))
+  {
+    Log::Detail log;
+    log << "Ether Dream: Start playing\n";
+    commands.begin_playback(point_rate);
+    send_command('b');
+  }
+}
+
+//--------------------------------------------------------------------------
+// Start playing if not already, once the buffer has built up
+void Interface::begin_playback_if_ready(uint32_t point_rate)
+{
+  if (estimate_fullness() >= min_fullness_for_start)
+    begin_playback(point_rate);
+}
+
+//--------------------------------------------------------------------------
+// Send a frame, with any commands needed to get the device ready first -
+// none of these wait for a response, since the device handles them in order
+void Interface::send_frame(const QueuedFrame& frame)
+{
+  if (last_status.light_engine_state == Status::LightEngineState::e_stop
+      && !is_outstanding('c'))
+  {
+    Log::Summary log;
+    log << "Ether Dream: Trying to clear e-stop state\n";
+    commands.clear_emergency_stop();
+    send_command('c');
+  }
+
+  if (last_status.playback_state == Status::PlaybackState::idle
+      && !is_outstanding('p'))
+  {
+    Log::Detail log;
+    log << "Ether Dream: preparing\n";
+    commands.prepare();
+    send_command('p');
+  }
+
+  commands.queue_rate_change(frame.point_rate);
+  send_command('q');
+  commands.send(frame.points, true);
+  send_command('d', frame.points.size());
+
+  begin_playback_if_ready(frame.point_rate);
+}
+
+//--------------------------------------------------------------------------
+// I/O thread
+void Interface::run_io_thread()
+{
+  QueuedFrame sending;
+  auto have_frame = false;
+
+  while (!async.stop_io_thread)
+  {
+    // Keep the number of commands in flight bounded
+    if (async.outstanding.size() > max_outstanding_commands)
+    {
+      if (!process_response()) break;
+      continue;
+    }
+
+    // Take the next frame, swapping storage with the slot
+    if (!have_frame)
+    {
+      unique_lock<mutex> lock(async.queue_mutex);
+      if (!async.queue_count && async.outstanding.empty()
+          && !async.stop_io_thread)
+        async.queue_ready.wait_for(lock, idle_poll_interval);
+      if (async.stop_io_thread) break;
+
+      if (async.queue_count)
+      {
+        auto& slot = async.frames[async.queue_head];
+        swap(sending.points, slot.points);
+        sending.point_rate = slot.point_rate;
+        async.queue_head = (async.queue_head+1) % async.frames.size();
+        async.queue_count--;
+        have_frame = true;
+      }
+    }
+
+    if (!have_frame)
+    {
+      // Collect any responses, or ping to keep status fresh when idle
+      if (!async.outstanding.empty())
+      {
+        if (!process_response()) break;
+      }
+      else
+      {
+        commands.ping();
+        send_command('?');
+      }
+      continue;
+    }
+
+    if (sending.points.size() > async.buffer_capacity)
+    {
+      Log::Error log;
+      log << "Ether Dream frame of " << sending.points.size()
+          << " points can never fit buffer of " << async.buffer_capacity
+          << " - frame skipped\n";
+      have_frame = false;
+      continue;
+    }
+
+    // Pace - wait for room in the device buffer
+    const auto fullness = estimate_fullness();
+    const auto excess = fullness + sending.points.size()
+                      - async.buffer_capacity;
+    if (excess > 0)
+    {
+      if (!async.outstanding.empty())
+      {
+        // Fresher status will be along shortly
+        if (!process_response()) break;
+      }
+      else if (last_status.playback_state == Status::PlaybackState::playing
+               && last_status.point_rate)
+      {
+        this_thread::sleep_for(min<chrono::steady_clock::duration>(
+          chrono::duration_cast<chrono::steady_clock::duration>(
+            chrono::duration<double>(excess / last_status.point_rate)),
+          max_pace_wait));
+      }
+      else
+      {
+        // Not draining, so get it going - even below the usual start level,
+        // since otherwise this frame would never fit
+        begin_playback(sending.point_rate);
+        if (async.outstanding.empty())
+        {
+          commands.ping();
+          send_command('?');
+        }
+      }
+      continue;
+    }
+
+    send_frame(sending);
+    have_frame = false;
+  }
+}
+
+}} // namespaces
@@ -81,6 +81,33 @@ void CommandSender::send(const vector<Point>& points, bool change_rate)
   channel.send(data);
 }
 
+// Send compact data, with option to send rate change on first point
+void CommandSender::send(const CompactPoints& points, bool change_rate)
+{
+  const auto n = points.size();
+  vector<uint8_t> data(3+18*n);
+  Channel::BlockWriter bw(data);
+
+  bw.write_byte(Command::write_data);
+  bw.write_le_16(n);
+
+  for(size_t i=0; i<n; i++)
+  {
+    bw.write_le_16(change_rate?(1<<15):0);  // control
+    change_rate = false;
+    bw.write_le_16(static_cast<int16_t>(65535*points.x[i]));
+    bw.write_le_16(static_cast<int16_t>(65535*points.y[i]));
+    bw.write_le_16(static_cast<uint16_t>(257*points.r[i]));  // 255 -> 65535
+    bw.write_le_16(static_cast<uint16_t>(257*points.g[i]));
+    bw.write_le_16(static_cast<uint16_t>(257*points.b[i]));
+    bw.write_le_16(0);  // i ?intensity?
+    bw.write_le_16(0);  // u1
+    bw.write_le_16(0);  // u2
+  }
+
+  channel.send(data);
+}
+
 // Stop
 void CommandSender::stop_playback()
 {
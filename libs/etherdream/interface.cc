@@ -11,8 +11,6 @@
 
 namespace ViGraph { namespace EtherDream {
 
-static const int min_fullness_for_start = 1500;
-
 // Log stats at intervals
 void Interface::log_stats()
 {
@@ -36,60 +34,68 @@ void Interface::log_stats()
   }
 }
 
-// Get response with status as last_status
-// Returns true if OK
-bool Interface::get_response()
+// Read a response into last_status, waiting for it if necessary
+// Returns false if the channel fails
+bool Interface::read_response(uint8_t& response)
 {
-  for(;;)
+  const auto length = 2 + Status::size;  // response, command, status
+  while (receive_buffer.size() < length)
   {
-    if (receive_buffer.size() >= 22)  // 2 + status response
-    {
-      auto response = receive_buffer.front();
-
-      // Remove response and command, which we ignore
-      receive_buffer.erase(receive_buffer.begin(), receive_buffer.begin()+2);
-
-      if (!last_status.read(receive_buffer))
-        return false;
-
-      // Log error conditions
-      if (last_status.playback_flags & Status::PlaybackFlags::underflow)
-      {
-        Log::Error log;
-        log << "Ether Dream: Underflow\n";
-      }
-
-      if (last_status.playback_flags & Status::PlaybackFlags::e_stop)
-      {
-        Log::Error log;
-        log << "Ether Dream: E-Stop!\n";
-      }
-
-      if (response == 'a')
-      {
-        log_stats();
-        return true;
-      }
-
-      Log::Error log;
-      log << "Ether Dream error response: " << response << " - ";
-      switch (response)
-      {
-        case 'F': log << "buffer full"; break;
-        case 'I': log << "invalid"; break;
-        case '!': log << "emergency stop"; break;
-        default: log << "UNKNOWN!";
-      }
-
-      log << endl;
-      last_status.dump(log);
+    if (!receive_buffer.fill(channel))
       return false;
-    }
+  }
 
-    // Get some more
-    if (!channel.receive(receive_buffer))
-      return false;
+  // Ignore command, which we know
+  response = receive_buffer[0];
+  const auto ok = last_status.read(receive_buffer.get()+2, Status::size);
+  receive_buffer.consume(length);
+  return ok;
+}
+
+// Check a response, logging any problems
+// Returns true if it was an ACK
+bool Interface::check_response(uint8_t response)
+{
+  // Log error conditions
+  if (last_status.playback_flags & Status::PlaybackFlags::underflow)
+  {
+    Log::Error log;
+    log << "Ether Dream: Underflow\n";
+  }
+
+  if (last_status.playback_flags & Status::PlaybackFlags::e_stop)
+  {
+    Log::Error log;
+    log << "Ether Dream: E-Stop!\n";
+  }
+
+  if (response == 'a')
+  {
+    log_stats();
+    return true;
+  }
+
+  Log::Error log;
+  log << "Ether Dream error response: " << response << " - ";
+  switch (response)
+  {
+    case 'F': log << "buffer full"; break;
+    case 'I': log << "invalid"; break;
+    case '!': log << "emergency stop"; break;
+    default: log << "UNKNOWN!";
   }
+
+  log << endl;
+  last_status.dump(log);
+  return false;
+}
+
+// Get response with status as last_status
+// Returns true if OK
+bool Interface::get_response()
+{
+  uint8_t response;
+  return read_response(response) && check_response(response);
 }
 
 // Start the interface
@@ -11,11 +11,11 @@
 
 namespace ViGraph { namespace EtherDream {
 
-// Read and remove from raw data
-bool Status::read(vector<uint8_t>& data)
+// Read from raw data, without removing it
+bool Status::read(const uint8_t *data, size_t length)
 {
-  if (data.size() < 20) return false;
-  Channel::BlockReader br(data);
+  if (length < size) return false;
+  Channel::BlockReader br(data, length);
   try
   {
     protocol = br.read_byte();
@@ -34,7 +34,14 @@ bool Status::read(vector<uint8_t>& data)
     return false;
   }
 
-  data.erase(data.begin(), data.begin()+20);
+  return true;
+}
+
+// Read and remove from raw data
+bool Status::read(vector<uint8_t>& data)
+{
+  if (!read(data.data(), data.size())) return false;
+  data.erase(data.begin(), data.begin()+size);
   return true;
 }
 
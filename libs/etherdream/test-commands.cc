@@ -166,6 +166,32 @@ TEST(CommandsTest, test_sending_top_left_rgb)
   EXPECT_EQ(expected, channel.received_data);
 }
 
+TEST(CommandsTest, test_sending_compact_points)
+{
+  TestChannel channel;
+  CommandSender commands(channel);
+  vector<Point> points;
+  points.push_back(Point(-0.5,0.5,Colour::RGB(0,0.5,1)));
+  commands.send(CompactPoints(points), true);
+
+  vector<uint8_t> expected
+  {
+    'd', 1, 0,
+    0,0x80, // control with rate change
+    1,0x80, // x - 0x8001
+    0xff,0x7f, // y - 0x7fff
+    0,0,       // r
+    0x80,0x80, // g - 8-bit 128 = 0x8080
+    0xff,0xff, // b
+    0, 0, // i
+    0, 0, // u1
+    0, 0  // u2
+  };
+
+  ASSERT_EQ(21, channel.received_data.size());
+  EXPECT_EQ(expected, channel.received_data);
+}
+
 TEST(CommandsTest, test_sending_two_points_with_rate_change)
 {
   TestChannel channel;
@@ -11,6 +11,10 @@
 
 #include <gtest/gtest.h>
 #include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
 
 namespace {
 
@@ -259,6 +263,225 @@ TEST(InterfaceTest, test_buffer_points_available_after_startup)
   ASSERT_EQ(3000-1025, intf.get_buffer_points_available());
 }
 
+// Fake DAC channel for async tests - ACKs every command from another
+// thread's point of view, tracking the playback state and buffer, and
+// blocks receive until there is something to read
+class FakeDACChannel: public DataChannel
+{
+  mutex mtx;
+  condition_variable cv;
+  vector<uint8_t> responses;
+  bool holding{false};
+  bool failing{false};
+  Status::PlaybackState playback_state{Status::PlaybackState::idle};
+  size_t fullness{0};
+  uint32_t point_rate{0};
+
+  void respond(uint8_t command)
+  {
+    vector<uint8_t> r(22);
+    r[0] = 'a';
+    r[1] = command;
+    r[4] = static_cast<uint8_t>(playback_state);
+    r[12] = fullness & 0xff;
+    r[13] = fullness >> 8;
+    r[14] = point_rate & 0xff;
+    r[15] = (point_rate >> 8) & 0xff;
+    r[16] = (point_rate >> 16) & 0xff;
+    responses.insert(responses.end(), r.begin(), r.end());
+  }
+
+  void send(const vector<uint8_t>& data) override
+  {
+    unique_lock<mutex> lock(mtx);
+    const auto command = data[0];
+    commands.push_back(command);
+    switch (command)
+    {
+      case 'p':
+        playback_state = Status::PlaybackState::prepared;
+      break;
+
+      case 'b':
+        playback_state = Status::PlaybackState::playing;
+        point_rate = data[3] | data[4] << 8 | data[5] << 16;
+      break;
+
+      case 'd':
+      {
+        const size_t n = data[1] | data[2] << 8;
+        frame_sizes.push_back(n);
+        fullness += n;
+        // Play out the oldest points immediately once playing, to keep
+        // room in the buffer
+        if (playback_state == Status::PlaybackState::playing)
+          fullness = n;
+      }
+      break;
+    }
+
+    respond(command);
+    cv.notify_all();
+  }
+
+  size_t receive(vector<uint8_t>& data) override
+  {
+    unique_lock<mutex> lock(mtx);
+    cv.wait(lock, [this]()
+            { return failing || (!holding && !responses.empty()); });
+    if (failing) return 0;
+    data.insert(data.end(), responses.begin(), responses.end());
+    const auto n = responses.size();
+    responses.clear();
+    return n;
+  }
+
+public:
+  vector<uint8_t> commands;
+  vector<size_t> frame_sizes;
+
+  FakeDACChannel() { respond(0); }  // Startup 'response'
+
+  // Hold back responses
+  void hold(bool h)
+  {
+    lock_guard<mutex> lock(mtx);
+    holding = h;
+    cv.notify_all();
+  }
+
+  // Fail the connection
+  void fail()
+  {
+    lock_guard<mutex> lock(mtx);
+    failing = true;
+    cv.notify_all();
+  }
+
+  // Wait for a number of data commands to arrive
+  bool wait_for_frames(size_t n)
+  {
+    unique_lock<mutex> lock(mtx);
+    return cv.wait_for(lock, chrono::seconds(5),
+                       [this, n]() { return frame_sizes.size() >= n; });
+  }
+
+  // Wait for a command to arrive
+  bool wait_for_command(uint8_t command)
+  {
+    unique_lock<mutex> lock(mtx);
+    return cv.wait_for(lock, chrono::seconds(5),
+                       [this, command]()
+                       { return find(commands.begin(), commands.end(),
+                                     command) != commands.end(); });
+  }
+};
+
+TEST(InterfaceTest, test_async_prepares_sends_and_starts_playing)
+{
+  FakeDACChannel channel;
+  Interface intf(channel);
+  ASSERT_TRUE(intf.start());
+  intf.start_thread();
+
+  vector<Point> points(500, Point(0, 0, Colour::white));
+  for(auto i=0; i<4; i++)
+  {
+    ASSERT_TRUE(channel.wait_for_frames(i));
+    intf.queue_frame(points, 0.05);  // 10000 pps
+  }
+
+  ASSERT_TRUE(channel.wait_for_command('b'));
+  intf.stop_thread();
+
+  // Ping from start, then prepare, and data pipelined with rate changes
+  ASSERT_LE(9, channel.commands.size());
+  EXPECT_EQ('?', channel.commands[0]);
+  EXPECT_EQ('p', channel.commands[1]);
+  EXPECT_EQ('q', channel.commands[2]);
+  EXPECT_EQ('d', channel.commands[3]);
+  EXPECT_EQ('q', channel.commands[4]);
+  EXPECT_EQ('d', channel.commands[5]);
+  EXPECT_EQ('q', channel.commands[6]);
+  EXPECT_EQ('d', channel.commands[7]);
+
+  // Playback starts only once enough is buffered
+  EXPECT_EQ('b', channel.commands[8]);
+  EXPECT_EQ(0, intf.get_frames_dropped());
+}
+
+TEST(InterfaceTest, test_async_queue_drops_oldest_frame_when_full)
+{
+  FakeDACChannel channel;
+  Interface intf(channel);
+  ASSERT_TRUE(intf.start());
+  intf.start_thread(2);
+
+  // Let the first frame go, then stall the device
+  channel.hold(true);
+  ASSERT_TRUE(intf.queue_frame(vector<Point>(10), 0.01));
+  ASSERT_TRUE(channel.wait_for_frames(1));
+
+  // Queue fills without blocking, then drops the oldest
+  EXPECT_TRUE(intf.queue_frame(vector<Point>(20), 0.01));
+  EXPECT_TRUE(intf.queue_frame(vector<Point>(30), 0.01));
+  EXPECT_FALSE(intf.queue_frame(vector<Point>(40), 0.01));
+  EXPECT_EQ(1, intf.get_frames_dropped());
+
+  channel.hold(false);
+  ASSERT_TRUE(channel.wait_for_frames(3));
+  intf.stop_thread();
+
+  ASSERT_EQ(3, channel.frame_sizes.size());
+  EXPECT_EQ(10, channel.frame_sizes[0]);
+  EXPECT_EQ(30, channel.frame_sizes[1]);
+  EXPECT_EQ(40, channel.frame_sizes[2]);
+}
+
+TEST(InterfaceTest, test_async_starts_playing_when_next_frame_cannot_fit)
+{
+  FakeDACChannel channel;
+  Interface intf(channel);
+  ASSERT_TRUE(intf.start());
+  intf.start_thread();
+
+  // First frame leaves the buffer below the start level, but with too
+  // little room left for the second
+  intf.queue_frame(vector<Point>(1400, Point(0, 0, Colour::white)), 0.05);
+  ASSERT_TRUE(channel.wait_for_frames(1));
+  intf.queue_frame(vector<Point>(1700, Point(0, 0, Colour::white)), 0.05);
+  ASSERT_TRUE(channel.wait_for_frames(2));
+  intf.stop_thread();
+
+  // Playback was started to make room
+  const auto b = find(channel.commands.begin(), channel.commands.end(), 'b');
+  ASSERT_NE(channel.commands.end(), b);
+  EXPECT_EQ(1, count(channel.commands.begin(), b, 'd'));
+  ASSERT_EQ(2, channel.frame_sizes.size());
+  EXPECT_EQ(1700, channel.frame_sizes[1]);
+}
+
+TEST(InterfaceTest, test_async_stops_queuing_when_connection_fails)
+{
+  FakeDACChannel channel;
+  Interface intf(channel);
+  ASSERT_TRUE(intf.start());
+  intf.start_thread();
+
+  channel.fail();
+  vector<Point> points(10, Point(0, 0, Colour::white));
+  intf.queue_frame(points, 0.01);
+  for(auto i=0; i<500 && !intf.has_failed(); i++)
+    this_thread::sleep_for(chrono::milliseconds(10));
+  ASSERT_TRUE(intf.has_failed());
+
+  // Nothing more is queued, so nothing is dropped either
+  for(auto i=0; i<5; i++)
+    EXPECT_FALSE(intf.queue_frame(points, 0.01));
+  EXPECT_EQ(0, intf.get_frames_dropped());
+  intf.stop_thread();
+}
+
 } // anonymous namespace
 
 int main(int argc, char **argv)
@@ -14,6 +14,12 @@
 #include "ot-net.h"
 #include "ot-time.h"
 #include "vg-geometry.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <chrono>
 
 namespace ViGraph { namespace EtherDream {
 
@@ -79,6 +85,12 @@ struct Status
   uint32_t point_rate{0};
   uint32_t point_count{0};
 
+  // Size on the wire
+  static const size_t size = 20;
+
+  // Read from raw data, leaving it in place
+  bool read(const uint8_t *data, size_t length);
+
   // Read and remove from raw data
   bool read(vector<uint8_t>& data);
 
@@ -100,6 +112,47 @@ class DataChannel
   virtual ~DataChannel() {}
 };
 
+//==========================================================================
+// Receive buffer
+// Responses are consumed from the front by moving a read offset rather than
+// shifting the remaining data down; the storage is reset when it empties,
+// which with request/response traffic is nearly every time, and only
+// compacted if a long backlog builds up
+class ReceiveBuffer
+{
+  vector<uint8_t> data;
+  size_t start{0};
+
+ public:
+  static const size_t compact_threshold = 4096;
+
+  // Get number of unconsumed bytes
+  size_t size() const { return data.size()-start; }
+
+  // Access unconsumed data
+  const uint8_t *get() const { return data.data()+start; }
+  uint8_t operator[](size_t i) const { return data[start+i]; }
+
+  // Read more from the channel - returns false if it fails
+  bool fill(DataChannel& channel) { return channel.receive(data) > 0; }
+
+  // Consume bytes from the front
+  void consume(size_t n)
+  {
+    start += n;
+    if (start >= data.size())
+    {
+      data.clear();
+      start = 0;
+    }
+    else if (start >= compact_threshold)
+    {
+      data.erase(data.begin(), data.begin()+start);
+      start = 0;
+    }
+  }
+};
+
 //==========================================================================
 // EtherDream command sender
 // Separated out for one-way message testing
@@ -122,6 +175,7 @@ class CommandSender
 
   // Send data, with option to send rate change on first point
   void send(const vector<Point>& points, bool change_rate = false);
+  void send(const CompactPoints& points, bool change_rate = false);
 
   // Stop
   void stop_playback();
@@ -138,11 +192,12 @@ class CommandSender
 
 //==========================================================================
 // Ether Dream Interface
-// Handles request/response using the given data channel
+// Handles request/response using the given data channel, either directly
+// or from its own I/O thread - see start_thread()
 class Interface
 {
   DataChannel& channel;
-  vector<uint8_t> receive_buffer;
+  ReceiveBuffer receive_buffer;
   Status last_status;
   CommandSender commands;
 
@@ -158,11 +213,63 @@ class Interface
     uint16_t min_fullness{UINT16_MAX};
   } stats;
 
+  // Asynchronous operation
+  // Held compact - float coordinates still exceed the device's 16 bits,
+  // and colour is cut to 8 bits as in ILDA true-colour
+  struct QueuedFrame
+  {
+    CompactPoints points;
+    uint32_t point_rate{0};
+  };
+
+  struct SentCommand
+  {
+    uint8_t command;
+    size_t points;
+  };
+
+  struct Async
+  {
+    unique_ptr<thread> io_thread;
+    atomic<bool> stop_io_thread{false};
+    atomic<bool> failed{false};       // Connection lost, thread has stopped
+
+    // Frame queue, fixed ring of slots
+    mutex queue_mutex;
+    condition_variable queue_ready;
+    vector<QueuedFrame> frames;
+    size_t queue_head{0};
+    size_t queue_count{0};
+    atomic<uint64_t> frames_dropped{0};
+
+    // I/O thread only
+    deque<SentCommand> outstanding;       // Sent, waiting for response
+    size_t unacked_points{0};         // Points in outstanding data commands
+    chrono::steady_clock::time_point status_time;  // When last_status came
+    size_t buffer_capacity{0};
+  } async;
+
   // Internal
   void log_stats();
+  bool read_response(uint8_t& response);
+  bool check_response(uint8_t response);
   bool get_response();
 
+  // Async internals
+  void run_io_thread();
+  void send_command(uint8_t command, size_t points = 0);
+  bool process_response();
+  bool is_outstanding(uint8_t command) const;
+  double estimate_fullness() const;
+  void begin_playback(uint32_t point_rate);
+  void begin_playback_if_ready(uint32_t point_rate);
+  void send_frame(const QueuedFrame& frame);
+
  public:
+  static const size_t min_fullness_for_start = 1500;
+  static const size_t default_buffer_capacity = 3000;
+  static const size_t default_max_queued_frames = 2;
+
   Interface(DataChannel& c):
    channel(c), commands(c) {}
 
@@ -189,8 +296,29 @@ class Interface
   // Get estimate of buffer availability
   size_t get_buffer_points_available();
 
+  // Start the I/O thread, after start() - from then on, frames are only
+  // passed in with queue_frame(), and the thread prepares the device,
+  // sends commands without waiting for each response, and paces points
+  // by the buffer fullness reported back
+  void start_thread(size_t max_queued_frames = default_max_queued_frames,
+                    size_t buffer_capacity = default_buffer_capacity);
+
+  // Queue a frame for the I/O thread - never blocks.  If the queue is full
+  // the oldest frame is dropped and this returns false; it also returns
+  // false, queuing nothing, if the thread isn't running or has failed
+  bool queue_frame(const vector<Point>& points, double duration);
+
+  // Whether the I/O thread has stopped because the connection failed
+  bool has_failed() const { return async.failed; }
+
+  // Get number of frames dropped from the queue
+  uint64_t get_frames_dropped() const { return async.frames_dropped; }
+
+  // Stop the I/O thread
+  void stop_thread();
+
   // Virtual destructor
-  virtual ~Interface() {}
+  virtual ~Interface() { stop_thread(); }
 };
 
 //==========================================================================
@@ -226,6 +354,9 @@ class TCPInterface: public Interface
 
   // Start the interface
   bool start() override;
+
+  // Stop the I/O thread before the channel and client go
+  ~TCPInterface() { stop_thread(); }
 };
 
 //==========================================================================
@@ -0,0 +1,203 @@
+//==========================================================================
+// ViGraph vector library: compact-points.cc
+//
+// Implementation of compact (structure-of-arrays) points
+//
+// Copyright (c) 2020 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-geometry.h"
+
+namespace ViGraph { namespace Geometry {
+
+namespace
+{
+  // Intensity conversions
+  inline CompactPoints::intens_t to_compact(Colour::intens_t i)
+  {
+    if (!(i > 0.0)) return 0;
+    if (i >= 1.0) return 255;
+    return static_cast<CompactPoints::intens_t>(i*255.0 + 0.5);
+  }
+
+  inline Colour::intens_t from_compact(CompactPoints::intens_t i)
+  {
+    return i/255.0;
+  }
+
+  // Scale an 8-bit intensity, saturating
+  inline CompactPoints::intens_t scale_intens(CompactPoints::intens_t i,
+                                              float f)
+  {
+    const auto v = i*f + 0.5f;
+    return static_cast<CompactPoints::intens_t>(
+      v < 0.0f ? 0.0f : (v < 255.0f ? v : 255.0f));
+  }
+}
+
+// Resize all arrays
+void CompactPoints::resize(size_t n)
+{
+  x.resize(n);
+  y.resize(n);
+  z.resize(n);
+  r.resize(n);
+  g.resize(n);
+  b.resize(n);
+}
+
+// Convert from Points
+void CompactPoints::from(const std::vector<Point>& points)
+{
+  const auto n = points.size();
+  resize(n);
+  for(size_t i=0; i<n; i++)
+  {
+    const auto& p = points[i];
+    x[i] = p.x;
+    y[i] = p.y;
+    z[i] = p.z;
+    r[i] = to_compact(p.c.r);
+    g[i] = to_compact(p.c.g);
+    b[i] = to_compact(p.c.b);
+  }
+}
+
+// Convert to Points
+void CompactPoints::to(std::vector<Point>& points) const
+{
+  const auto n = size();
+  points.resize(n);
+  for(size_t i=0; i<n; i++)
+  {
+    auto& p = points[i];
+    p.x = x[i];
+    p.y = y[i];
+    p.z = z[i];
+    p.c.r = from_compact(r[i]);
+    p.c.g = from_compact(g[i]);
+    p.c.b = from_compact(b[i]);
+  }
+}
+
+// Translate all points
+void CompactPoints::translate(const Vector& v)
+{
+  const auto n = size();
+  const float vx = v.x, vy = v.y, vz = v.z;
+  auto px = x.data(), py = y.data(), pz = z.data();
+  for(size_t i=0; i<n; i++) px[i] += vx;
+  for(size_t i=0; i<n; i++) py[i] += vy;
+  for(size_t i=0; i<n; i++) pz[i] += vz;
+}
+
+// Scale all points
+void CompactPoints::scale(const Vector& f)
+{
+  const auto n = size();
+  const float fx = f.x, fy = f.y, fz = f.z;
+  auto px = x.data(), py = y.data(), pz = z.data();
+  for(size_t i=0; i<n; i++) px[i] *= fx;
+  for(size_t i=0; i<n; i++) py[i] *= fy;
+  for(size_t i=0; i<n; i++) pz[i] *= fz;
+}
+
+// Rotate all points - same sequence as vector/rotate
+void CompactPoints::rotate(const Vector& angles)
+{
+  const auto n = size();
+  const float sinx = sin(angles.x), cosx = cos(angles.x);
+  const float siny = sin(angles.y), cosy = cos(angles.y);
+  const float sinz = sin(angles.z), cosz = cos(angles.z);
+  auto px = x.data(), py = y.data(), pz = z.data();
+  for(size_t i=0; i<n; i++)
+  {
+    const auto xy = cosx*py[i] - sinx*pz[i];
+    const auto xz = sinx*py[i] + cosx*pz[i];
+    const auto yz = cosy*xz    - siny*px[i];
+    const auto yx = siny*xz    + cosy*px[i];
+    px[i] = cosz*yx - sinz*xy;
+    py[i] = sinz*yx + cosz*xy;
+    pz[i] = yz;
+  }
+}
+
+// Fade all lit points
+void CompactPoints::fade(double alpha)
+{
+  const auto n = size();
+  const float a = alpha;
+  auto pr = r.data(), pg = g.data(), pb = b.data();
+  for(size_t i=0; i<n; i++)
+  {
+    // Blanked points stay blank anyway, so no need to test
+    pr[i] = scale_intens(pr[i], a);
+    pg[i] = scale_intens(pg[i], a);
+    pb[i] = scale_intens(pb[i], a);
+  }
+}
+
+// Clip to a box
+void CompactPoints::clip(const Vector& min, const Vector& max, bool exclude,
+                         double alpha)
+{
+  const auto n = size();
+
+  // Work out which points are unwanted in a branch-free pass
+  const float min_x = min.x, min_y = min.y, min_z = min.z;
+  const float max_x = max.x, max_y = max.y, max_z = max.z;
+  const uint8_t invert = exclude?1:0;
+  std::vector<uint8_t> unwanted(n);
+  auto px = x.data(), py = y.data(), pz = z.data();
+  for(size_t i=0; i<n; i++)
+  {
+    const uint8_t outside = (px[i] < min_x) | (py[i] < min_y)
+                          | (pz[i] < min_z) | (px[i] > max_x)
+                          | (py[i] > max_y) | (pz[i] > max_z);
+    unwanted[i] = outside ^ invert;
+  }
+
+  // Then apply it in order, since blanking depends on the previous point
+  const float a = alpha;
+  bool last_was_blanked{false};
+  size_t last_unclipped{n};  // n = none yet, use origin
+  for(size_t i=0; i<n; i++)
+  {
+    // If last one was blanked, blank this too to avoid a line from an
+    // invalid point
+    if (last_was_blanked) r[i] = g[i] = b[i] = 0;
+
+    if (unwanted[i])
+    {
+      if (alpha > 0.0)
+      {
+        r[i] = scale_intens(r[i], a);
+        g[i] = scale_intens(g[i], a);
+        b[i] = scale_intens(b[i], a);
+      }
+      else
+      {
+        // Blank and shift to last good one
+        if (last_unclipped < n)
+        {
+          x[i] = x[last_unclipped];
+          y[i] = y[last_unclipped];
+          z[i] = z[last_unclipped];
+        }
+        else
+        {
+          x[i] = y[i] = z[i] = 0;
+        }
+        r[i] = g[i] = b[i] = 0;
+        last_was_blanked = true;
+      }
+    }
+    else
+    {
+      last_was_blanked = false;
+      last_unclipped = i;
+    }
+  }
+}
+
+}} // namespaces
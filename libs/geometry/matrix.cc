@@ -0,0 +1,104 @@
+//==========================================================================
+// ViGraph vector library: matrix.cc
+//
+// Implementation of affine transform matrices
+//
+// Copyright (c) 2020 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-geometry.h"
+
+namespace ViGraph { namespace Geometry {
+
+// Translation
+Matrix Matrix::translation(const Vector& v)
+{
+  Matrix r;
+  r.m[0][3] = v.x;
+  r.m[1][3] = v.y;
+  r.m[2][3] = v.z;
+  return r;
+}
+
+// Scaling
+Matrix Matrix::scaling(const Vector& f)
+{
+  Matrix r;
+  r.m[0][0] = f.x;
+  r.m[1][1] = f.y;
+  r.m[2][2] = f.z;
+  return r;
+}
+
+// Rotation around X, then Y, then Z
+Matrix Matrix::rotation(const Vector& angles)
+{
+  const auto sinx = sin(angles.x), cosx = cos(angles.x);
+  const auto siny = sin(angles.y), cosy = cos(angles.y);
+  const auto sinz = sin(angles.z), cosz = cos(angles.z);
+
+  Matrix rx, ry, rz;
+  rx.m[1][1] = cosx; rx.m[1][2] = -sinx;
+  rx.m[2][1] = sinx; rx.m[2][2] = cosx;
+
+  ry.m[0][0] = cosy;  ry.m[0][2] = siny;
+  ry.m[2][0] = -siny; ry.m[2][2] = cosy;
+
+  rz.m[0][0] = cosz; rz.m[0][1] = -sinz;
+  rz.m[1][0] = sinz; rz.m[1][1] = cosz;
+
+  return rz * ry * rx;
+}
+
+// Composition
+Matrix Matrix::operator*(const Matrix& o) const
+{
+  Matrix r;
+  for(auto i=0; i<4; i++)
+    for(auto j=0; j<4; j++)
+      r.m[i][j] = m[i][0]*o.m[0][j] + m[i][1]*o.m[1][j]
+                + m[i][2]*o.m[2][j] + m[i][3]*o.m[3][j];
+  return r;
+}
+
+// Equality
+bool Matrix::operator==(const Matrix& o) const
+{
+  for(auto i=0; i<4; i++)
+    for(auto j=0; j<4; j++)
+      if (m[i][j] != o.m[i][j]) return false;
+  return true;
+}
+
+// Apply to points
+void Matrix::apply(const std::vector<Point>& from,
+                   std::vector<Point>& to) const
+{
+  to.resize(from.size());
+  const auto n = from.size();
+  for(size_t i=0; i<n; i++)
+  {
+    const auto& p = from[i];
+    auto& q = to[i];
+    const auto v = apply(p);
+    q.x = v.x;
+    q.y = v.y;
+    q.z = v.z;
+    q.c = p.c;
+  }
+}
+
+std::ostream& operator<<(std::ostream& s, const Matrix& m)
+{
+  s << '[';
+  for(auto i=0; i<4; i++)
+  {
+    if (i) s << ' ';
+    s << '(' << m.m[i][0] << ',' << m.m[i][1] << ','
+      << m.m[i][2] << ',' << m.m[i][3] << ')';
+  }
+  s << ']';
+  return s;
+}
+
+}} // namespaces
@@ -0,0 +1,129 @@
+//==========================================================================
+// ViGraph vector graphics: test-compact-points.cc
+//
+// Tests for compact (structure-of-arrays) points
+//
+// Copyright (c) 2020 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-geometry.h"
+#include <gtest/gtest.h>
+
+namespace {
+
+using namespace std;
+using namespace ViGraph;
+using namespace ViGraph::Geometry;
+
+const double loose_filter = 1e-5;
+
+TEST(CompactPointsTest, TestRoundTripConversion)
+{
+  vector<Point> points;
+  points.push_back(Point(0.1, -0.2, 0.3, Colour::RGB(1.0, 0.5, 0)));
+  points.push_back(Point(-0.5, 0.5));
+
+  CompactPoints cp(points);
+  ASSERT_EQ(2, cp.size());
+  EXPECT_TRUE(cp.is_lit(0));
+  EXPECT_FALSE(cp.is_lit(1));
+  EXPECT_EQ(255, cp.r[0]);
+  EXPECT_EQ(128, cp.g[0]);
+  EXPECT_EQ(0, cp.b[0]);
+
+  vector<Point> out;
+  cp.to(out);
+  ASSERT_EQ(2, out.size());
+  EXPECT_NEAR(0.1, out[0].x, loose_filter);
+  EXPECT_NEAR(-0.2, out[0].y, loose_filter);
+  EXPECT_NEAR(0.3, out[0].z, loose_filter);
+  EXPECT_DOUBLE_EQ(1.0, out[0].c.r);
+  EXPECT_NEAR(0.5, out[0].c.g, 1.0/255);
+  EXPECT_TRUE(out[1].is_blanked());
+  EXPECT_NEAR(-0.5, out[1].x, loose_filter);
+}
+
+TEST(CompactPointsTest, TestTranslateAndScale)
+{
+  vector<Point> points;
+  points.push_back(Point(1, 2, 3));
+  CompactPoints cp(points);
+  cp.scale(Vector(2, 3, 4));
+  cp.translate(Vector(0.5, -1, 1));
+  EXPECT_NEAR(2.5, cp.x[0], loose_filter);
+  EXPECT_NEAR(5, cp.y[0], loose_filter);
+  EXPECT_NEAR(13, cp.z[0], loose_filter);
+}
+
+TEST(CompactPointsTest, TestRotateAroundZ)
+{
+  vector<Point> points;
+  points.push_back(Point(0.5, 0, 0));
+  CompactPoints cp(points);
+  cp.rotate(Vector(0, 0, pi/2));
+  EXPECT_NEAR(0, cp.x[0], loose_filter);
+  EXPECT_NEAR(0.5, cp.y[0], loose_filter);
+  EXPECT_NEAR(0, cp.z[0], loose_filter);
+}
+
+TEST(CompactPointsTest, TestFadeSaturatesAndKeepsBlanks)
+{
+  vector<Point> points;
+  points.push_back(Point(0, 0, Colour::RGB(1.0, 0.5, 0.2)));
+  points.push_back(Point(0, 0));
+  CompactPoints cp(points);
+
+  cp.fade(0.5);
+  EXPECT_EQ(128, cp.r[0]);
+  EXPECT_EQ(64, cp.g[0]);
+  EXPECT_FALSE(cp.is_lit(1));
+
+  cp.fade(4.0);
+  EXPECT_EQ(255, cp.r[0]);
+  EXPECT_EQ(255, cp.g[0]);
+  EXPECT_FALSE(cp.is_lit(1));
+}
+
+TEST(CompactPointsTest, TestClipBlanksAndMovesOutsidePoints)
+{
+  vector<Point> points;
+  points.push_back(Point(0.1, 0.1, Colour::white));
+  points.push_back(Point(0.9, 0.1, Colour::white));
+  points.push_back(Point(0.2, 0.2, Colour::white));
+  points.push_back(Point(0.3, 0.3, Colour::white));
+  CompactPoints cp(points);
+
+  cp.clip(Vector(-0.5, -0.5, -0.5), Vector(0.5, 0.5, 0.5), false, 0);
+
+  EXPECT_TRUE(cp.is_lit(0));
+  // Moved back to the last good point and blanked
+  EXPECT_FALSE(cp.is_lit(1));
+  EXPECT_NEAR(0.1, cp.x[1], loose_filter);
+  EXPECT_NEAR(0.1, cp.y[1], loose_filter);
+  // Following point also blanked
+  EXPECT_FALSE(cp.is_lit(2));
+  EXPECT_NEAR(0.2, cp.x[2], loose_filter);
+  EXPECT_TRUE(cp.is_lit(3));
+}
+
+TEST(CompactPointsTest, TestClipExcludeWithAlphaFades)
+{
+  vector<Point> points;
+  points.push_back(Point(0, 0, Colour::white));
+  points.push_back(Point(0.9, 0.9, Colour::white));
+  CompactPoints cp(points);
+
+  cp.clip(Vector(-0.1, -0.1, -0.1), Vector(0.1, 0.1, 0.1), true, 0.5);
+
+  EXPECT_EQ(128, cp.r[0]);
+  EXPECT_EQ(255, cp.r[1]);
+  EXPECT_NEAR(0, cp.x[0], loose_filter);
+}
+
+} // anon
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
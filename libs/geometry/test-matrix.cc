@@ -0,0 +1,79 @@
+//==========================================================================
+// ViGraph vector graphics: test-matrix.cc
+//
+// Tests for affine transform matrices
+//
+// Copyright (c) 2020 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-geometry.h"
+#include <gtest/gtest.h>
+
+namespace {
+
+using namespace std;
+using namespace ViGraph;
+using namespace ViGraph::Geometry;
+
+const double loose_filter = 1e-10;
+
+TEST(MatrixTest, TestDefaultIsIdentity)
+{
+  Matrix m;
+  EXPECT_TRUE(m.is_identity());
+  EXPECT_EQ(Vector(1, 2, 3), m.apply(Vector(1, 2, 3)));
+}
+
+TEST(MatrixTest, TestTranslationAndScaling)
+{
+  auto t = Matrix::translation(Vector(1, 2, 3));
+  EXPECT_EQ(Vector(2, 3, 4), t.apply(Vector(1, 1, 1)));
+  auto s = Matrix::scaling(Vector(2, 3, 4));
+  EXPECT_EQ(Vector(2, 3, 4), s.apply(Vector(1, 1, 1)));
+}
+
+TEST(MatrixTest, TestCompositionAppliesRightFirst)
+{
+  auto m = Matrix::translation(Vector(1, 0, 0))
+         * Matrix::scaling(Vector(2, 2, 2));
+  EXPECT_EQ(Vector(3, 2, 2), m.apply(Vector(1, 1, 1)));
+  EXPECT_NE(m, Matrix::scaling(Vector(2, 2, 2))
+             * Matrix::translation(Vector(1, 0, 0)));
+}
+
+TEST(MatrixTest, TestRotationMatchesSequentialAxisRotation)
+{
+  // Same sequence as vector/rotate - X, then Y, then Z
+  const double ax = 0.3, ay = -1.1, az = 2.0;
+  const Vector p(0.1, -0.2, 0.3);
+  auto xy = cos(ax)*p.y - sin(ax)*p.z;
+  auto xz = sin(ax)*p.y + cos(ax)*p.z;
+  auto yz = cos(ay)*xz  - sin(ay)*p.x;
+  auto yx = sin(ay)*xz  + cos(ay)*p.x;
+  auto zx = cos(az)*yx  - sin(az)*xy;
+  auto zy = sin(az)*yx  + cos(az)*xy;
+
+  auto v = Matrix::rotation(Vector(ax, ay, az)).apply(p);
+  EXPECT_NEAR(zx, v.x, loose_filter);
+  EXPECT_NEAR(zy, v.y, loose_filter);
+  EXPECT_NEAR(yz, v.z, loose_filter);
+}
+
+TEST(MatrixTest, TestApplyToPointsKeepsColour)
+{
+  vector<Point> from{Point(1, 2, 3, Colour::red), Point(0, 0)};
+  vector<Point> to;
+  Matrix::translation(Vector(1, 1, 1)).apply(from, to);
+  ASSERT_EQ(2, to.size());
+  EXPECT_EQ(Point(2, 3, 4), to[0]);
+  EXPECT_EQ(Colour::red, to[0].c);
+  EXPECT_TRUE(to[1].is_blanked());
+}
+
+} // anon
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -14,6 +14,7 @@
 #include <math.h>
 #include <limits>
 #include <vector>
+#include <cstdint>
 
 namespace ViGraph { namespace Geometry {
 
@@ -122,6 +123,44 @@ struct Point: public Vector
   coord_t distance_to(const Point& o) const { return (o-*this).length(); }
 };
 
+// Affine transform matrix (4x4, homogeneous, column vectors - so a*b
+// applies b first, then a)
+struct Matrix
+{
+  coord_t m[4][4]{{1,0,0,0},{0,1,0,0},{0,0,1,0},{0,0,0,1}};
+
+  // default, identity
+  Matrix() {}
+
+  // Constructors for basic transforms
+  static Matrix translation(const Vector& v);
+  static Matrix scaling(const Vector& f);
+  // Rotation around X, Y and Z axes in turn (radians)
+  static Matrix rotation(const Vector& angles);
+
+  // Composition
+  Matrix operator*(const Matrix& o) const;
+
+  // Equality
+  bool operator==(const Matrix& o) const;
+  bool operator!=(const Matrix& o) const { return !(*this == o); }
+  bool is_identity() const { return *this == Matrix(); }
+
+  // Apply to a vector
+  Vector apply(const Vector& v) const
+  {
+    return Vector(m[0][0]*v.x + m[0][1]*v.y + m[0][2]*v.z + m[0][3],
+                  m[1][0]*v.x + m[1][1]*v.y + m[1][2]*v.z + m[1][3],
+                  m[2][0]*v.x + m[2][1]*v.y + m[2][2]*v.z + m[2][3]);
+  }
+
+  // Apply to a set of points, in a single pass, keeping colours
+  void apply(const std::vector<Point>& from, std::vector<Point>& to) const;
+};
+
+// >> operator to write to ostream
+std::ostream& operator<<(std::ostream& s, const Matrix& m);
+
 // Line
 struct Line
 {
@@ -210,6 +249,58 @@ struct Rectangle
 
 std::ostream& operator<<(std::ostream& s, const Rectangle& r);
 
+// -------------------------------------------------------------------------
+// Compact points - structure-of-arrays form of a vector of Points, with
+// float coordinates and 8-bit colour channels, for bulk processing and
+// for holding frames bound for laser DACs, which take no more precision.
+// Kernels are plain loops over the arrays, written so the compiler can
+// vectorise them
+struct CompactPoints
+{
+  typedef uint8_t intens_t;
+
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> z;
+  std::vector<intens_t> r;
+  std::vector<intens_t> g;
+  std::vector<intens_t> b;
+
+  CompactPoints() {}
+  CompactPoints(const std::vector<Point>& points) { from(points); }
+
+  // Size
+  size_t size() const { return x.size(); }
+  bool empty() const { return x.empty(); }
+  void resize(size_t n);
+  void clear() { resize(0); }
+
+  // Conversion from and to Points
+  void from(const std::vector<Point>& points);
+  void to(std::vector<Point>& points) const;
+
+  // Is a point lit?
+  bool is_lit(size_t i) const { return r[i] || g[i] || b[i]; }
+
+  // Translate all points by the given vector
+  void translate(const Vector& v);
+
+  // Scale all points by the given factors
+  void scale(const Vector& f);
+
+  // Rotate all points around the X, Y and Z axes in turn (radians)
+  void rotate(const Vector& angles);
+
+  // Fade all lit points by alpha
+  void fade(double alpha);
+
+  // Clip to the box (min, max), or exclude the box if 'exclude' is set.
+  // Unwanted points are faded by alpha if alpha > 0, otherwise blanked and
+  // moved onto the last wanted point
+  void clip(const Vector& min, const Vector& max, bool exclude,
+            double alpha);
+};
+
 //==========================================================================
 }} //namespaces
 #endif // !__VG_GEOMETRY_H
@@ -7,8 +7,8 @@
 //==========================================================================
 
 #include "vg-laser.h"
-#include <map>
-#include <list>
+#include <algorithm>
+#include <chrono>
 
 namespace ViGraph { namespace Laser {
 
@@ -17,45 +17,11 @@ namespace ViGraph { namespace Laser {
 vector<Point> Optimiser::add_blanking_anchors(const vector<Point>& points,
                                               int leading, int trailing)
 {
-  Point last_point;
-  bool last_point_valid{false};
+  BlankingAnchorsStage stage(leading, trailing);
+  Pipeline pipeline;
+  pipeline.add(stage);
   vector<Point> new_points;
-
-  for(const auto& p: points)
-  {
-    if (last_point_valid)
-    {
-      if (last_point.is_lit() && p.is_blanked())
-      {
-        // Repeat last lit point
-        for(auto i=0; i<trailing; i++)
-          new_points.emplace_back(last_point);
-
-        // Repeat this blanked point
-        for(auto i=0; i<leading; i++)
-          new_points.emplace_back(p);
-      }
-    }
-    else
-    {
-      // First point - insert leading blanks
-      for(auto i=0; i<leading; i++)
-        new_points.emplace_back(Point(p));
-    }
-    new_points.emplace_back(p);
-
-    last_point = p;
-    last_point_valid = true;
-  }
-
-  // Last point - insert trailing lit
-  if (last_point_valid)
-  {
-    // Repeat last lit point
-    for(auto i=0; i<trailing; i++)
-      new_points.emplace_back(last_point);
-  }
-
+  pipeline.run(points, new_points);
   return new_points;
 }
 
@@ -65,39 +31,11 @@ vector<Point> Optimiser::add_vertex_repeats(const vector<Point>& points,
                                             double max_angle, // radians
                                             int repeats)
 {
-  Point last_point;
-  bool last_point_valid{false};
-  Vector last_vector;
-  bool last_vector_valid{false};
+  VertexRepeatsStage stage(max_angle, repeats);
+  Pipeline pipeline;
+  pipeline.add(stage);
   vector<Point> new_points;
-
-  for(const auto& p: points)
-  {
-    // Check for vertex with maximum angle
-    if (last_vector_valid)
-    {
-      Vector this_vector = p-last_point;
-      coord_t angle = last_vector.angle_to(this_vector);
-      if (angle > pi) angle-=2*pi;  // Fix direction
-      if (angle > max_angle || angle < -max_angle)  // Turning either way
-      {
-        // Repeat point at vertex
-        for(auto i=0; i<repeats; i++)
-          new_points.emplace_back(last_point);
-      }
-    }
-
-    new_points.emplace_back(p);
-
-    if (last_point_valid)
-    {
-      last_vector = p-last_point;
-      last_vector_valid = true;
-    }
-    last_point = p;
-    last_point_valid = true;
-  }
-
+  pipeline.run(points, new_points);
   return new_points;
 }
 
@@ -107,126 +45,325 @@ vector<Point> Optimiser::infill_lines(const vector<Point>& points,
                                       coord_t max_distance_lit,
                                       coord_t max_distance_blanked)
 {
-  Point last_point;
-  bool last_point_valid{false};
+  InfillStage stage(max_distance_lit, max_distance_blanked);
+  Pipeline pipeline;
+  pipeline.add(stage);
   vector<Point> new_points;
+  pipeline.run(points, new_points);
+  return new_points;
+}
+
+//-----------------------------------------------------------------------
+// Segment reordering helpers
+namespace {
+
+// Segment of points, inclusive indices
+struct Segment
+{
+  unsigned start;
+  unsigned end;
+};
+
+// Segment placed in a path, possibly reversed
+struct Placement
+{
+  unsigned segment;
+  bool reversed;
+};
+
+// Uniform grid of segment end points for nearest neighbour queries.  Each
+// segment has an entry for its start and, if reversal is allowed, its end
+// (entering there means drawing it reversed).  Used segments are removed
+// lazily as they are found
+class EndpointGrid
+{
+  const vector<Point>& points;
+  const vector<Segment>& segments;
+  const vector<bool>& used;
+  coord_t min_x{0}, min_y{0};
+  coord_t cell_size{1};
+  int nx{1}, ny{1};
+  vector<unsigned> cell_start;  // Index into entries, per cell
+  vector<unsigned> cell_count;  // Live entries, per cell
+  vector<Placement> entries;
+
+  const Point& entry_point(const Placement& e) const
+  { return points[e.reversed ? segments[e.segment].end
+                             : segments[e.segment].start]; }
+
+  int cell_x(coord_t x) const
+  { return max(0, min(nx-1, static_cast<int>((x-min_x)/cell_size))); }
+  int cell_y(coord_t y) const
+  { return max(0, min(ny-1, static_cast<int>((y-min_y)/cell_size))); }
+
+ public:
+  EndpointGrid(const vector<Point>& _points,
+               const vector<Segment>& _segments,
+               const vector<bool>& _used, bool allow_reverse):
+    points(_points), segments(_segments), used(_used)
+  {
+    // Collect entries and bounds
+    for(auto i=0u; i<segments.size(); i++)
+    {
+      entries.push_back({i, false});
+      if (allow_reverse && segments[i].end != segments[i].start)
+        entries.push_back({i, true});
+    }
+
+    auto max_x = coord_min_range, max_y = coord_min_range;
+    min_x = min_y = coord_max_range;
+    for(const auto& e: entries)
+    {
+      const auto& p = entry_point(e);
+      min_x = min(min_x, p.x);  max_x = max(max_x, p.x);
+      min_y = min(min_y, p.y);  max_y = max(max_y, p.y);
+    }
+
+    // Square cells, roughly two entries per cell
+    const auto side = max(1.0, ceil(sqrt(entries.size()/2.0)));
+    cell_size = max(max_x-min_x, max_y-min_y)/side;
+    if (!(cell_size > 0)) cell_size = 1;
+    nx = static_cast<int>((max_x-min_x)/cell_size)+1;
+    ny = static_cast<int>((max_y-min_y)/cell_size)+1;
+
+    // Bucket entries by cell
+    vector<unsigned> cells(entries.size());
+    cell_count.assign(nx*ny, 0);
+    for(auto i=0u; i<entries.size(); i++)
+    {
+      const auto& p = entry_point(entries[i]);
+      cells[i] = cell_y(p.y)*nx + cell_x(p.x);
+      cell_count[cells[i]]++;
+    }
+    cell_start.assign(nx*ny+1, 0);
+    for(auto c=0; c<nx*ny; c++)
+      cell_start[c+1] = cell_start[c] + cell_count[c];
+
+    vector<Placement> sorted(entries.size());
+    vector<unsigned> fill(cell_start.begin(), cell_start.end()-1);
+    for(auto i=0u; i<entries.size(); i++)
+      sorted[fill[cells[i]]++] = entries[i];
+    entries.swap(sorted);
+  }
 
-  for(const auto& p: points)
+  // Find the nearest entry to the given point of an unused segment -
+  // returns false if there are none left
+  bool nearest(const Point& from, Placement& result)
   {
-    // Maximum distance in-fills
-    if (last_point_valid)
+    const auto cx = cell_x(from.x);
+    const auto cy = cell_y(from.y);
+    const auto max_r = max(nx, ny);
+    auto best_d = coord_max_range;
+    auto found = false;
+
+    for(auto r=0; r<=max_r; r++)
     {
-      // Check point against last
-      coord_t d = last_point.distance_to(p);
-      coord_t max_distance = p.is_lit()?max_distance_lit:max_distance_blanked;
-      if (max_distance && d > max_distance)
+      for(auto y=cy-r; y<=cy+r; y++)
       {
-        // Spread along a line, using new point's colour
-        Point p0(last_point, p.c);
-        Line l(p0, p);
-        // Get first equal interval that satisfies the constraint
-        coord_t interval = 1.0/ceil(d/max_distance);
-        for(coord_t t=interval; t<1.0-interval/2; t+=interval)
-          new_points.emplace_back(l.interpolate(t));
+        if (y < 0 || y >= ny) continue;
+        const auto edge = (y == cy-r || y == cy+r);
+        for(auto x=cx-r; x<=cx+r; x += (edge || r == 0) ? 1 : 2*r)
+        {
+          if (x < 0 || x >= nx) continue;
+          const auto c = y*nx+x;
+          auto i = cell_start[c];
+          while (i < cell_start[c] + cell_count[c])
+          {
+            const auto& e = entries[i];
+            if (used[e.segment])
+            {
+              // Remove by swapping with last live one
+              swap(entries[i], entries[cell_start[c] + --cell_count[c]]);
+              continue;
+            }
+
+            const auto d = from.distance_to(entry_point(e));
+            if (d < best_d
+                || (d == best_d
+                    && (e.segment < result.segment
+                        || (e.segment == result.segment && !e.reversed))))
+            {
+              best_d = d;
+              result = e;
+              found = true;
+            }
+            i++;
+          }
+        }
       }
+
+      // Anything further out is at least r cells away
+      if (found && best_d < r*cell_size) break;
     }
 
-    new_points.emplace_back(p);
+    return found;
+  }
+};
+
+// Path improver - 2-opt and Or-opt moves on a closed path (since the frame
+// repeats) with the first segment fixed
+class PathImprover
+{
+  const vector<Point>& points;
+  const vector<Segment>& segments;
+  vector<Placement>& path;
 
-    last_point = p;
-    last_point_valid = true;
+  const Point& entry(unsigned pos) const
+  {
+    const auto& pl = path[pos % path.size()];
+    return points[pl.reversed ? segments[pl.segment].end
+                              : segments[pl.segment].start];
   }
 
-  // If we are filling blanked lines, do the flyback to the start point as
-  // well
-  if (max_distance_blanked && last_point_valid)
+  const Point& exit(unsigned pos) const
   {
-    const auto& p = points[0];
-    coord_t d = last_point.distance_to(p);
-    if (d > max_distance_blanked)
+    const auto& pl = path[pos % path.size()];
+    return points[pl.reversed ? segments[pl.segment].start
+                              : segments[pl.segment].end];
+  }
+
+  static coord_t d(const Point& a, const Point& b) { return a.distance_to(b); }
+
+ public:
+  PathImprover(const vector<Point>& _points,
+               const vector<Segment>& _segments,
+               vector<Placement>& _path):
+    points(_points), segments(_segments), path(_path) {}
+
+  // Reverse a run of the path - positions i..j - including the segments
+  // themselves, if it shortens it
+  bool two_opt(unsigned i, unsigned j)
+  {
+    const auto delta = d(exit(i-1), exit(j)) + d(entry(i), entry(j+1))
+                     - d(exit(i-1), entry(i)) - d(exit(j), entry(j+1));
+    if (delta > -1e-9) return false;
+
+    reverse(path.begin()+i, path.begin()+j+1);
+    for(auto k=i; k<=j; k++) path[k].reversed = !path[k].reversed;
+    return true;
+  }
+
+  // Move the segment at position i to after position k, possibly reversed,
+  // if it shortens the path
+  bool or_opt(unsigned i, unsigned k, bool allow_reverse)
+  {
+    if (k == i || k+1 == i) return false;
+
+    const auto removed = d(exit(i-1), entry(i)) + d(exit(i), entry(i+1))
+                       - d(exit(i-1), entry(i+1));
+    const auto old_edge = d(exit(k), entry(k+1));
+    auto added = d(exit(k), entry(i)) + d(exit(i), entry(k+1)) - old_edge;
+    auto flip = false;
+    if (allow_reverse)
     {
-      Point p0(last_point, Colour::black);  // blanked
-      Line l(p0, p);
-      coord_t interval = 1.0/ceil(d/max_distance_blanked);
-      for(coord_t t=interval; t<1.0-interval/2; t+=interval)
-        new_points.emplace_back(l.interpolate(t));
+      const auto added_rev = d(exit(k), exit(i)) + d(entry(i), entry(k+1))
+                           - old_edge;
+      if (added_rev < added)
+      {
+        added = added_rev;
+        flip = true;
+      }
     }
+    if (added - removed > -1e-9) return false;
+
+    auto moved = path[i];
+    if (flip) moved.reversed = !moved.reversed;
+    path.erase(path.begin()+i);
+    path.insert(path.begin()+(k < i ? k+1 : k), moved);
+    return true;
   }
+};
 
-  return new_points;
-}
+} // anon
 
 //-----------------------------------------------------------------------
 // Reorder segments of points to find optimal path
-vector<Point> Optimiser::reorder_segments(const vector<Point>& points)
+vector<Point> Optimiser::reorder_segments(const vector<Point>& points,
+                                          bool allow_reverse,
+                                          double improve_time)
 {
   if (points.empty()) return points;
 
-  // Find segments delimited by blanks
-  map<int, int> segments;  // start index (blank) -> end index (last lit, excl)
-  Point last_point(points.back(), Colour::white);
-  int i=0;
-  for(const auto& p: points)
+  // Find segments delimited by blanks following lit points
+  vector<Segment> segments;
+  for(auto i=0u; i<points.size(); i++)
   {
-    if (p.is_blanked())
+    if (!i || (points[i].is_blanked() && points[i-1].is_lit()))
     {
-      // Note also on first point, when last_point will be end, lit
-      if (last_point.is_lit())
-      {
-        // Segment starts here
-        // Close last segment (if any)
-        if (!segments.empty()) segments.rbegin()->second = i-1;
-
-        // Open new one
-        segments[i] = -1;
-      }
+      if (!segments.empty()) segments.back().end = i-1;
+      segments.push_back({i, i});
     }
-    last_point = p;
-    i++;
   }
+  segments.back().end = points.size()-1;
+  if (segments.size() < 2) return points;
+
+  // Build path by nearest neighbour from the first segment, looking at
+  // both ends if reversal is allowed
+  vector<bool> used(segments.size());
+  vector<Placement> path;
+  path.reserve(segments.size());
+  path.push_back({0, false});
+  used[0] = true;
+
+  EndpointGrid grid(points, segments, used, allow_reverse);
+  Placement next{0, false};
+  for(;;)
+  {
+    const auto& last = path.back();
+    const auto& seg = segments[last.segment];
+    if (!grid.nearest(points[last.reversed ? seg.start : seg.end], next))
+      break;
 
-  // Close off last
-  if (segments.empty()) return points;
-  segments.rbegin()->second = i-1;
-
-  // Get segments in 'best' order - by naive method of just finding closest
-  // one to each one in turn
-  list<pair<int, int>> ordered_segments;
-
-  // Take the first one as starting point
-  auto current_segment = segments.begin();
-  ordered_segments.emplace_back(*current_segment);
-  last_point = points[current_segment->first];
-  segments.erase(current_segment);
+    path.push_back(next);
+    used[next.segment] = true;
+  }
 
-  // Loop through all the segments - this is O(N^2)!
-  while (!segments.empty())
+  // Improve it until no more gains or out of time
+  if (improve_time > 0 && path.size() > 2)
   {
-    // Find the nearest start to the last point of those remaining
-    auto best_segment = segments.end();
-    coord_t best_d = coord_max_range;
-    for(auto it = segments.begin(); it!=segments.end(); ++it)
+    const auto deadline = chrono::steady_clock::now()
+      + chrono::duration_cast<chrono::steady_clock::duration>(
+          chrono::duration<double>(improve_time));
+    PathImprover improver(points, segments, path);
+    const auto n = path.size();
+    auto improved = true;
+    auto timed_out = false;
+    while (improved && !timed_out)
     {
-      const Point& start_point = points[it->first];
-      coord_t d = last_point.distance_to(start_point);
-      if (d < best_d)
+      improved = false;
+      for(auto i=1u; i<n && !timed_out; i++)
       {
-        best_segment = it;
-        best_d = d;
+        if (allow_reverse)
+          for(auto j=i; j<n; j++)
+            improved |= improver.two_opt(i, j);
+
+        for(auto k=0u; k<n; k++)
+          improved |= improver.or_opt(i, k, allow_reverse);
+
+        timed_out = chrono::steady_clock::now() > deadline;
       }
     }
-
-    // Use this one and erase it
-    ordered_segments.emplace_back(*best_segment);
-    last_point = points[best_segment->first];
-    segments.erase(best_segment);
   }
 
-  // Copy points out in order
+  // Copy points out in order - a reversed segment starts blanked at its
+  // end, and each point takes the colour of the line it used to end
   vector<Point> new_points;
-  for(const auto& it: ordered_segments)
-    new_points.insert(new_points.end(), points.begin()+it.first,
-                      points.begin()+it.second+1);
+  new_points.reserve(points.size());
+  for(const auto& pl: path)
+  {
+    const auto& seg = segments[pl.segment];
+    if (pl.reversed)
+    {
+      new_points.emplace_back(Point(points[seg.end], Colour::black));
+      for(auto i=seg.end; i>seg.start; i--)
+        new_points.emplace_back(Point(points[i-1], points[i].c));
+    }
+    else
+    {
+      new_points.insert(new_points.end(), points.begin()+seg.start,
+                        points.begin()+seg.end+1);
+    }
+  }
 
   return new_points;
 }
@@ -236,21 +373,11 @@ vector<Point> Optimiser::reorder_segments(const vector<Point>& points)
 vector<Point> Optimiser::strip_blank_runs(const vector<Point>& points,
                                           int threshold)
 {
-  int blanks{0};
+  StripBlankRunsStage stage(threshold);
+  Pipeline pipeline;
+  pipeline.add(stage);
   vector<Point> new_points;
-
-  for(const auto& p: points)
-  {
-    if (p.is_blanked())
-      blanks++;
-    else
-      blanks=0;
-
-    // Only copy if lit or blanks less than threshold
-    if (blanks <= threshold)
-      new_points.emplace_back(p);
-  }
-
+  pipeline.run(points, new_points);
   return new_points;
 }
 
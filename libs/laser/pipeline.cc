@@ -0,0 +1,165 @@
+//==========================================================================
+// ViGraph laser graphics library: pipeline.cc
+//
+// Streaming optimiser pipeline stages
+//
+// Copyright (c) 2020 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-laser.h"
+
+namespace ViGraph { namespace Laser {
+
+//==========================================================================
+// Blanking anchors
+
+// Process a point
+void BlankingAnchorsStage::push(const Point& p)
+{
+  if (last_point_valid)
+  {
+    if (last_point.is_lit() && p.is_blanked())
+    {
+      // Repeat last lit point
+      for(auto i=0; i<trailing; i++)
+        emit(last_point);
+
+      // Repeat this blanked point
+      for(auto i=0; i<leading; i++)
+        emit(p);
+    }
+  }
+  else
+  {
+    // First point - insert leading blanks
+    for(auto i=0; i<leading; i++)
+      emit(p);
+  }
+  emit(p);
+
+  last_point = p;
+  last_point_valid = true;
+}
+
+// End of frame
+void BlankingAnchorsStage::finish()
+{
+  // Last point - insert trailing lit
+  if (last_point_valid)
+  {
+    for(auto i=0; i<trailing; i++)
+      emit(last_point);
+  }
+}
+
+//==========================================================================
+// Vertex repeats
+
+// Process a point
+void VertexRepeatsStage::push(const Point& p)
+{
+  // Check for vertex with maximum angle
+  if (last_vector_valid)
+  {
+    Vector this_vector = p-last_point;
+    coord_t angle = last_vector.angle_to(this_vector);
+    if (angle > pi) angle-=2*pi;  // Fix direction
+    if (angle > max_angle || angle < -max_angle)  // Turning either way
+    {
+      // Repeat point at vertex
+      for(auto i=0; i<repeats; i++)
+        emit(last_point);
+    }
+  }
+
+  emit(p);
+
+  if (last_point_valid)
+  {
+    last_vector = p-last_point;
+    last_vector_valid = true;
+  }
+  last_point = p;
+  last_point_valid = true;
+}
+
+//==========================================================================
+// Infill
+
+// Fill a line between two points, using the 'to' point's colour
+void InfillStage::fill(const Point& from, const Point& to,
+                       coord_t max_distance)
+{
+  coord_t d = from.distance_to(to);
+  if (max_distance && d > max_distance)
+  {
+    Point p0(from, to.c);
+    Line l(p0, to);
+    // Get first equal interval that satisfies the constraint
+    coord_t interval = 1.0/ceil(d/max_distance);
+    for(coord_t t=interval; t<1.0-interval/2; t+=interval)
+      emit(l.interpolate(t));
+  }
+}
+
+// Process a point
+void InfillStage::push(const Point& p)
+{
+  if (last_point_valid)
+    fill(last_point, p, p.is_lit()?max_distance_lit:max_distance_blanked);
+  else
+    first_point = p;
+
+  emit(p);
+
+  last_point = p;
+  last_point_valid = true;
+}
+
+// End of frame
+void InfillStage::finish()
+{
+  // If we are filling blanked lines, do the flyback to the start point as
+  // well
+  if (max_distance_blanked && last_point_valid)
+    fill(Point(last_point, Colour::black), Point(first_point, Colour::black),
+         max_distance_blanked);
+}
+
+//==========================================================================
+// Blank run stripping
+
+// Process a point
+void StripBlankRunsStage::push(const Point& p)
+{
+  if (p.is_blanked())
+    blanks++;
+  else
+    blanks=0;
+
+  // Only pass on if lit or blanks less than threshold
+  if (blanks <= threshold)
+    emit(p);
+}
+
+//==========================================================================
+// Pipeline
+
+// Run points through all stages
+void Pipeline::run(const vector<Point>& points, vector<Point>& output)
+{
+  output.clear();
+  sink.points = &output;
+
+  // Link up
+  for(auto i=0u; i<stages.size(); i++)
+    stages[i]->set_next(i+1 < stages.size() ? stages[i+1]
+                        : static_cast<PipelineStage *>(&sink));
+  PipelineStage *first = stages.empty() ? &sink : stages.front();
+
+  for(auto s: stages) s->start();
+  for(const auto& p: points) first->push(p);
+  for(auto s: stages) s->finish();
+}
+
+}} // namespaces
@@ -8,6 +8,7 @@
 
 #include "vg-laser.h"
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <sstream>
 
 namespace {
@@ -206,6 +207,121 @@ TEST(OptimiserTest, TestReorderingWithLastPointBlank)
   EXPECT_EQ(4, opoints[4].x);
 }
 
+TEST(OptimiserTest, TestReorderingReversesSegments)
+{
+  vector<Point> points;
+  points.push_back(Point(0, 0));
+  points.push_back(Point(1, 0, Colour::white));
+
+  points.push_back(Point(5, 0));
+  points.push_back(Point(3, 0, Colour::red));
+  points.push_back(Point(2, 0, Colour::green));
+
+  Optimiser optimiser;
+  vector<Point> opoints = optimiser.reorder_segments(points);
+  ASSERT_EQ(5, opoints.size());
+
+  EXPECT_EQ(Point(0, 0), opoints[0]);
+  EXPECT_EQ(Point(1, 0), opoints[1]);
+  // Reversed, starting blanked at the old end, lines keep their colours
+  EXPECT_EQ(Point(2, 0), opoints[2]);
+  EXPECT_TRUE(opoints[2].is_blanked());
+  EXPECT_EQ(Point(3, 0), opoints[3]);
+  EXPECT_EQ(Colour::green, opoints[3].c);
+  EXPECT_EQ(Point(5, 0), opoints[4]);
+  EXPECT_EQ(Colour::red, opoints[4].c);
+
+  // Not if disallowed
+  opoints = optimiser.reorder_segments(points, false);
+  ASSERT_EQ(5, opoints.size());
+  EXPECT_EQ(Point(5, 0), opoints[2]);
+  EXPECT_EQ(Point(2, 0), opoints[4]);
+}
+
+// Total blanked travel, including flyback to the start
+coord_t blank_travel(const vector<Point>& points)
+{
+  coord_t d = 0;
+  for(auto i=0u; i<points.size(); i++)
+  {
+    const auto& p = points[i];
+    const auto& last = points[i ? i-1 : points.size()-1];
+    if (p.is_blanked()) d += last.distance_to(p);
+  }
+  return d;
+}
+
+TEST(OptimiserTest, TestReorderingManySegmentsReducesBlanking)
+{
+  // Short random lines
+  vector<Point> points;
+  unsigned seed = 1;
+  auto rnd = [&seed]() { seed = seed*1103515245 + 12345;
+                         return ((seed >> 8) & 0xffff) / 65536.0 - 0.5; };
+  for(auto i=0; i<2000; i++)
+  {
+    const auto x = rnd(), y = rnd();
+    points.push_back(Point(x, y));
+    points.push_back(Point(x+rnd()/20, y+rnd()/20, Colour::white));
+    points.push_back(Point(x+rnd()/20, y+rnd()/20, Colour::white));
+  }
+
+  Optimiser optimiser;
+  const auto forward = optimiser.reorder_segments(points, false);
+  const auto nearest = optimiser.reorder_segments(points);
+  ASSERT_EQ(points.size(), forward.size());
+  ASSERT_EQ(points.size(), nearest.size());
+
+  EXPECT_LT(blank_travel(forward), blank_travel(points)/4);
+  EXPECT_LT(blank_travel(nearest), blank_travel(forward));
+}
+
+// Small fixed set of lines where nearest neighbour leaves a longer path
+// than 2-opt / Or-opt can find - the time allowed is far more than they
+// need to finish, so the result doesn't depend on machine speed
+vector<Point> improvable_lines()
+{
+  vector<Point> points;
+  const coord_t lines[][4] = { {  0.2,  0.1,  0.1,  0.3 },
+                               { -0.5, -0.1, -0.6, -0.1 },
+                               {  0.4,  0.0,  0.5,  0.2 },
+                               { -0.4,  0.2, -0.5,  0.2 },
+                               {  0.1,  0.0,  0.0,  0.0 } };
+  for(const auto& l: lines)
+  {
+    points.push_back(Point(l[0], l[1]));
+    points.push_back(Point(l[2], l[3], Colour::white));
+  }
+  return points;
+}
+
+TEST(OptimiserTest, TestOrOptImprovesNearestNeighbourPath)
+{
+  const auto points = improvable_lines();
+  Optimiser optimiser;
+  const auto nearest = optimiser.reorder_segments(points, false);
+  const auto improved = optimiser.reorder_segments(points, false, 10);
+  ASSERT_EQ(points.size(), improved.size());
+  EXPECT_NEAR(2.7246, blank_travel(nearest), 1e-3);
+  EXPECT_NEAR(2.2332, blank_travel(improved), 1e-3);
+}
+
+TEST(OptimiserTest, TestTwoOptWithReversalImprovesNearestNeighbourPath)
+{
+  const auto points = improvable_lines();
+  Optimiser optimiser;
+  const auto nearest = optimiser.reorder_segments(points, true);
+  const auto improved = optimiser.reorder_segments(points, true, 10);
+  ASSERT_EQ(points.size(), improved.size());
+  EXPECT_NEAR(2.7246, blank_travel(nearest), 1e-3);
+  EXPECT_NEAR(1.9523, blank_travel(improved), 1e-3);
+
+  const auto lit = [](const vector<Point>& ps)
+    { return count_if(ps.begin(), ps.end(),
+                      [](const Point& p) { return p.is_lit(); }); };
+  EXPECT_EQ(lit(points), lit(improved));
+}
+
 TEST(OptimiserTest, TestStripBlanks)
 {
   vector<Point> points;
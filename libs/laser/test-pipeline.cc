@@ -0,0 +1,81 @@
+//==========================================================================
+// ViGraph laser graphics library: test-pipeline.cc
+//
+// Tests for streaming optimiser pipeline
+//
+// Copyright (c) 2020 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-laser.h"
+#include <gtest/gtest.h>
+
+namespace {
+
+using namespace std;
+using namespace ViGraph;
+using namespace ViGraph::Laser;
+
+vector<Point> test_points()
+{
+  vector<Point> points;
+  points.push_back(Point(0, 0));
+  points.push_back(Point(0.1, 0, Colour::white));
+  points.push_back(Point(0.1, 0.2, Colour::red));
+  for(int i=0; i<10; i++)
+    points.push_back(Point(0.1, 0.2));
+  points.push_back(Point(-0.3, 0.4));
+  points.push_back(Point(-0.3, -0.1, Colour::green));
+  points.push_back(Point(0.2, -0.1, Colour::blue));
+  return points;
+}
+
+TEST(PipelineTest, TestEmptyPipelinePassesThrough)
+{
+  Pipeline pipeline;
+  const auto points = test_points();
+  vector<Point> output;
+  pipeline.run(points, output);
+  EXPECT_EQ(points, output);
+}
+
+TEST(PipelineTest, TestFusedPipelineMatchesSeparateStages)
+{
+  const auto points = test_points();
+
+  Optimiser optimiser;
+  auto expected = optimiser.strip_blank_runs(points, 5);
+  expected = optimiser.infill_lines(expected, 0.05, 0.1);
+  expected = optimiser.add_vertex_repeats(expected, pi/6, 3);
+  expected = optimiser.add_blanking_anchors(expected, 2, 4);
+
+  StripBlankRunsStage strip(5);
+  InfillStage infill(0.05, 0.1);
+  VertexRepeatsStage vertices(pi/6, 3);
+  BlankingAnchorsStage anchors(2, 4);
+  Pipeline pipeline;
+  pipeline.add(strip);
+  pipeline.add(infill);
+  pipeline.add(vertices);
+  pipeline.add(anchors);
+
+  vector<Point> output;
+  pipeline.run(points, output);
+  ASSERT_EQ(expected.size(), output.size());
+  EXPECT_EQ(expected, output);
+  for(auto i=0u; i<output.size(); i++)
+    EXPECT_EQ(expected[i].c, output[i].c) << i;
+
+  // Runs again from a clean state, reusing the buffer
+  const auto data = output.data();
+  pipeline.run(points, output);
+  EXPECT_EQ(expected, output);
+  EXPECT_EQ(data, output.data());
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -20,6 +20,140 @@ using namespace std;
 using namespace ViGraph;
 using namespace ViGraph::Geometry;
 
+//==========================================================================
+// Streaming optimiser pipeline
+// Each stage takes points one at a time and passes its output straight on
+// to the next, so a chain of stages makes a single pass over the frame and
+// writes directly into the caller's (reusable) buffer
+
+// Stage interface
+class PipelineStage
+{
+  PipelineStage *next{nullptr};
+
+ protected:
+  // Pass a point on to the next stage
+  void emit(const Point& p) { next->push(p); }
+
+ public:
+  // Set the next stage
+  void set_next(PipelineStage *_next) { next = _next; }
+
+  // Start a new frame
+  virtual void start() {}
+
+  // Process a point
+  virtual void push(const Point& p) = 0;
+
+  // End of the frame - flush anything held back
+  virtual void finish() {}
+
+  virtual ~PipelineStage() {}
+};
+
+// Add repeated points as blanking anchors
+class BlankingAnchorsStage: public PipelineStage
+{
+  int leading;
+  int trailing;
+  Point last_point;
+  bool last_point_valid{false};
+
+ public:
+  BlankingAnchorsStage(int _leading=0, int _trailing=0):
+    leading(_leading), trailing(_trailing) {}
+  void set(int _leading, int _trailing)
+  { leading = _leading; trailing = _trailing; }
+
+  void start() override { last_point_valid = false; }
+  void push(const Point& p) override;
+  void finish() override;
+};
+
+// Add repeated points at vertices
+class VertexRepeatsStage: public PipelineStage
+{
+  double max_angle;  // radians
+  int repeats;
+  Point last_point;
+  bool last_point_valid{false};
+  Vector last_vector;
+  bool last_vector_valid{false};
+
+ public:
+  VertexRepeatsStage(double _max_angle=0, int _repeats=0):
+    max_angle(_max_angle), repeats(_repeats) {}
+  void set(double _max_angle, int _repeats)
+  { max_angle = _max_angle; repeats = _repeats; }
+
+  void start() override { last_point_valid = last_vector_valid = false; }
+  void push(const Point& p) override;
+};
+
+// Infill points to enforce a maximum distance
+class InfillStage: public PipelineStage
+{
+  coord_t max_distance_lit;
+  coord_t max_distance_blanked;
+  Point first_point;
+  Point last_point;
+  bool last_point_valid{false};
+
+  void fill(const Point& from, const Point& to, coord_t max_distance);
+
+ public:
+  InfillStage(coord_t _max_distance_lit=0, coord_t _max_distance_blanked=0):
+    max_distance_lit(_max_distance_lit),
+    max_distance_blanked(_max_distance_blanked) {}
+  void set(coord_t _max_distance_lit, coord_t _max_distance_blanked)
+  { max_distance_lit = _max_distance_lit;
+    max_distance_blanked = _max_distance_blanked; }
+
+  void start() override { last_point_valid = false; }
+  void push(const Point& p) override;
+  void finish() override;
+};
+
+// Strip out long runs of blanks
+class StripBlankRunsStage: public PipelineStage
+{
+  int threshold;
+  int blanks{0};
+
+ public:
+  StripBlankRunsStage(int _threshold=0): threshold(_threshold) {}
+  void set(int _threshold) { threshold = _threshold; }
+
+  void start() override { blanks = 0; }
+  void push(const Point& p) override;
+};
+
+// Pipeline of stages - stages are not owned, and must outlive it
+class Pipeline
+{
+  // Final stage, writing to the output
+  class Sink: public PipelineStage
+  {
+   public:
+    vector<Point> *points{nullptr};
+    void push(const Point& p) override { points->push_back(p); }
+  };
+
+  vector<PipelineStage *> stages;
+  Sink sink;
+
+ public:
+  // Remove all stages
+  void clear() { stages.clear(); }
+
+  // Add a stage to the end
+  void add(PipelineStage& stage) { stages.push_back(&stage); }
+
+  // Run points through all stages into the output, which is cleared
+  // first but keeps its capacity
+  void run(const vector<Point>& points, vector<Point>& output);
+};
+
 //==========================================================================
 // Laser frame optimiser
 class Optimiser
@@ -49,7 +183,13 @@ class Optimiser
 
   //-----------------------------------------------------------------------
   // Reorder segments of points to find optimal path
-  vector<Point> reorder_segments(const vector<Point>& points);
+  // Segments may be drawn reversed if allow_reverse is set.  If
+  // improve_time (seconds) is given, the nearest neighbour path is then
+  // refined with 2-opt / Or-opt moves until it stops improving or the
+  // time runs out
+  vector<Point> reorder_segments(const vector<Point>& points,
+                                 bool allow_reverse = true,
+                                 double improve_time = 0);
 
   //-----------------------------------------------------------------------
   // Strip out long runs of blanks (longer than threshold)
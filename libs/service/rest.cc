@@ -601,6 +601,265 @@ bool CombinedURLHandler::handle_request(const Web::HTTPMessage& request,
   return true;
 }
 
+//==========================================================================
+// /schedule URL Handler
+// Operations:  GET
+
+// URL format:
+// /schedule                  Tick schedule statistics
+
+class ScheduleURLHandler: public Web::URLHandler
+{
+  Dataflow::Engine& engine;
+  bool handle_get(Web::HTTPMessage& response);
+  bool handle_request(const Web::HTTPMessage& request,
+                      Web::HTTPMessage& response,
+                      const SSL::ClientDetails& client);
+
+public:
+  ScheduleURLHandler(Dataflow::Engine& _engine):
+    URLHandler("/schedule"), engine(_engine)
+  {}
+};
+
+//--------------------------------------------------------------------------
+// Handle a GET request
+// Returns whether request was valid
+bool ScheduleURLHandler::handle_get(Web::HTTPMessage& response)
+{
+  Log::Streams log;
+  log.detail << "REST Schedule: GET request\n";
+  const auto stats = engine.get_schedule_stats();
+  JSON::Value json(JSON::Value::OBJECT);
+  json.put("threads", stats.threads);
+  json.put("scheduler",
+           stats.scheduler == Dataflow::Engine::Scheduler::work_stealing
+           ? "work-stealing" : "shared");
+  json.put("elements", stats.elements);
+  json.put("deadlocked", stats.deadlocked);
+  json.put("tasks", stats.tasks);
+  json.put("chains", stats.chains);
+  json.put("chained-elements", stats.chained_elements);
+  json.put("longest-chain", stats.longest_chain);
+  json.put("critical-path", stats.critical_path);
+  json.put("roots", stats.roots);
+  response.body = json.str(true);
+  return true;
+}
+
+//--------------------------------------------------------------------------
+// Handle the request
+bool ScheduleURLHandler::handle_request(const Web::HTTPMessage& request,
+                                        Web::HTTPMessage& response,
+                                        const SSL::ClientDetails& /* client */)
+{
+  if (request.method == "GET")
+  {
+    if (!handle_get(response))
+    {
+      response.code = 400;
+      response.reason = "Bad request";
+    }
+  }
+  else
+  {
+    response.code = 405;
+    response.reason = "Method not allowed";
+  }
+  return true;
+}
+
+//==========================================================================
+// /profile URL Handler
+// Operations:  GET, POST
+
+// URL format:
+// /profile                   Per-element tick timing (GET)
+//                            Enable/disable with {"enabled": true} (POST)
+// Times are in microseconds
+class ProfileURLHandler: public Web::URLHandler
+{
+  Dataflow::Engine& engine;
+  MainThreadRunner& runner;
+  bool handle_get(Web::HTTPMessage& response);
+  bool handle_post(const Web::HTTPMessage& request,
+                   Web::HTTPMessage& response);
+  bool handle_request(const Web::HTTPMessage& request,
+                      Web::HTTPMessage& response,
+                      const SSL::ClientDetails& client);
+
+public:
+  ProfileURLHandler(Dataflow::Engine& _engine, MainThreadRunner& _runner):
+    URLHandler("/profile"), engine(_engine), runner{_runner}
+  {}
+};
+
+namespace
+{
+//--------------------------------------------------------------------------
+// Get JSON for a histogram
+JSON::Value get_histogram_json(const Dataflow::TickHistogram& h)
+{
+  JSON::Value json(JSON::Value::OBJECT);
+  json.put("count", static_cast<int64_t>(h.get_count()));
+  json.put("p50", h.get_percentile(0.5) / 1000.0);
+  json.put("p99", h.get_percentile(0.99) / 1000.0);
+  json.put("max", h.get_max() / 1000.0);
+  json.put("total", h.get_total() / 1000.0);
+  return json;
+}
+}
+
+//--------------------------------------------------------------------------
+// Handle a GET request
+// Returns whether request was valid
+bool ProfileURLHandler::handle_get(Web::HTTPMessage& response)
+{
+  Log::Streams log;
+  log.detail << "REST Profile: GET request\n";
+  const auto profile = engine.get_profile();
+  JSON::Value json(JSON::Value::OBJECT);
+  json.put("enabled", profile.enabled ? JSON::Value::TRUE_
+                                      : JSON::Value::FALSE_);
+  json.put("ticks", get_histogram_json(profile.ticks));
+  auto& elements = json.put("elements", JSON::Value::ARRAY);
+  for (const auto& e: profile.elements)
+  {
+    auto& ej = elements.add(get_histogram_json(e.histogram));
+    ej.put("id", e.id);
+    ej.put("type", e.type);
+  }
+  response.body = json.str(true);
+  return true;
+}
+
+//--------------------------------------------------------------------------
+// Handle a POST request
+// Returns whether request was valid
+bool ProfileURLHandler::handle_post(const Web::HTTPMessage& request,
+                                    Web::HTTPMessage&)
+{
+  Log::Streams log;
+  log.detail << "REST Profile: POST" << endl;
+
+  // Parse JSON
+  istringstream iss(request.body);
+  ObTools::JSON::Parser parser(iss);
+  JSON::Value value;
+  try
+  {
+    value = parser.read_value();
+  }
+  catch (ObTools::JSON::Exception& e)
+  {
+    log.error << "REST: JSON parsing failed: " << e.error << endl;
+    return false;
+  }
+
+  const auto enable = value["enabled"].type == JSON::Value::TRUE_;
+  auto f = runner.run_function([this, enable]()
+  {
+    engine.enable_profiling(enable);
+  });
+  f.get();
+  return true;
+}
+
+//--------------------------------------------------------------------------
+// Handle the request
+bool ProfileURLHandler::handle_request(const Web::HTTPMessage& request,
+                                       Web::HTTPMessage& response,
+                                       const SSL::ClientDetails& /* client */)
+{
+  if (request.method == "GET")
+  {
+    if (!handle_get(response))
+    {
+      response.code = 400;
+      response.reason = "Bad request";
+    }
+  }
+  else if (request.method == "POST")
+  {
+    if (!handle_post(request, response))
+    {
+      response.code = 400;
+      response.reason = "Bad request";
+    }
+  }
+  else
+  {
+    response.code = 405;
+    response.reason = "Method not allowed";
+  }
+  return true;
+}
+
+//==========================================================================
+// /timing URL Handler
+// Operations:  GET
+
+// URL format:
+// /timing                    Tick lateness, wake jitter and catch-up counts,
+//                            and sample buffer allocations
+// Times are in microseconds
+class TimingURLHandler: public Web::URLHandler
+{
+  Dataflow::Engine& engine;
+  bool handle_get(Web::HTTPMessage& response);
+  bool handle_request(const Web::HTTPMessage& request,
+                      Web::HTTPMessage& response,
+                      const SSL::ClientDetails& client);
+
+public:
+  TimingURLHandler(Dataflow::Engine& _engine):
+    URLHandler("/timing"), engine(_engine)
+  {}
+};
+
+//--------------------------------------------------------------------------
+// Handle a GET request
+// Returns whether request was valid
+bool TimingURLHandler::handle_get(Web::HTTPMessage& response)
+{
+  Log::Streams log;
+  log.detail << "REST Timing: GET request\n";
+  const auto stats = engine.get_timing_stats();
+  JSON::Value json(JSON::Value::OBJECT);
+  json.put("ticks", static_cast<int64_t>(stats.ticks));
+  json.put("late-calls", static_cast<int64_t>(stats.late_calls));
+  json.put("skipped-ticks", static_cast<int64_t>(stats.skipped_ticks));
+  json.put("stretched-ticks", static_cast<int64_t>(stats.stretched_ticks));
+  json.put("lateness", get_histogram_json(stats.lateness));
+  json.put("wake-jitter", get_histogram_json(stats.wake_jitter));
+  json.put("buffer-allocations",
+           static_cast<int64_t>(Dataflow::get_buffer_allocations()));
+  response.body = json.str(true);
+  return true;
+}
+
+//--------------------------------------------------------------------------
+// Handle the request
+bool TimingURLHandler::handle_request(const Web::HTTPMessage& request,
+                                      Web::HTTPMessage& response,
+                                      const SSL::ClientDetails& /* client */)
+{
+  if (request.method == "GET")
+  {
+    if (!handle_get(response))
+    {
+      response.code = 400;
+      response.reason = "Bad request";
+    }
+  }
+  else
+  {
+    response.code = 405;
+    response.reason = "Method not allowed";
+  }
+  return true;
+}
+
 //==========================================================================
 // /version URL Handler
 // Operations:  GET
@@ -679,6 +938,9 @@ RESTInterface::RESTInterface(const XML::Element& config,
   http_server->add(new MetaURLHandler(engine));
   http_server->add(new LayoutURLHandler(layout));
   http_server->add(new CombinedURLHandler(engine, layout));
+  http_server->add(new ScheduleURLHandler(engine));
+  http_server->add(new ProfileURLHandler(engine, runner));
+  http_server->add(new TimingURLHandler(engine));
   http_server->add(new VersionURLHandler);
 
   // Allow cross-origin fetch from anywhere
@@ -8,10 +8,16 @@
 #include "vg-compiler.h"
 #include "vg-json.h"
 #include <SDL.h>
+#include <thread>
+#if !defined(PLATFORM_WINDOWS)
+#include <time.h>
+#include <errno.h>
+#endif
 
 namespace ViGraph { namespace Service {
 
 const auto default_section = "core";
+const auto max_tick_wait = Time::Duration{0.01};  // To service functions
 
 //--------------------------------------------------------------------------
 // Constructor
@@ -67,25 +73,59 @@ int Server::tick()
   SDL_PumpEvents();
 
   // Handle queued functions
-  MT::Lock lock{functions_mutex};
-  while (!functions.empty())
   {
-    auto ff = std::move(functions.front());
-    functions.pop();
-    try
-    {
-      ff.func();
-      ff.promise.set_value(true);
-    }
-    catch (...)
+    MT::Lock lock{functions_mutex};
+    while (!functions.empty())
     {
-      ff.promise.set_exception(current_exception());
+      auto ff = std::move(functions.front());
+      functions.pop();
+      try
+      {
+        ff.func();
+        ff.promise.set_value(true);
+      }
+      catch (...)
+      {
+        ff.promise.set_exception(current_exception());
+      }
     }
   }
 
+  wait_for_next_tick();
   return 0;
 }
 
+//--------------------------------------------------------------------------
+// Sleep until the next tick is due, or at most max_tick_wait so queued
+// functions still get run
+void Server::wait_for_next_tick()
+{
+  auto target = engine.get_next_tick_time();
+  const auto now = Time::Duration::clock();
+  if (target <= now) return;
+  if (target > now + max_tick_wait) target = now + max_tick_wait;
+  const auto wait = target - now;
+
+#if defined(PLATFORM_WINDOWS)
+  this_thread::sleep_for(chrono::duration<double>(wait.seconds()));
+#else
+  // Absolute deadline so restarts after signals don't accumulate drift
+  timespec deadline;
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+  const auto ns = deadline.tv_nsec
+                  + static_cast<long long>(wait.seconds() * 1e9);
+  deadline.tv_sec += ns / 1000000000;
+  deadline.tv_nsec = ns % 1000000000;
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr)
+         == EINTR)
+    ;
+#endif
+
+  const auto late = Time::Duration::clock() - target;
+  engine.record_wake_jitter(late > Time::Duration{}
+                            ? static_cast<uint64_t>(late.seconds() * 1e9) : 0);
+}
+
 //--------------------------------------------------------------------------
 // Run a function on the main thread
 future<bool> Server::run_function(function<void()> func)
@@ -149,18 +189,55 @@ void Server::reconfigure()
   // Shutdown any existing graph
   engine.shutdown();
 
-  // Get number of threads
-  unsigned threads = config_xml.get_child("thread").get_attr_int("count", 0);
-  engine.set_threads(threads);
+  // Get number of threads and scheduler
+  const auto& thread_e = config_xml.get_child("thread");
+  unsigned threads = thread_e.get_attr_int("count", 0);
+  const auto scheduler_s = thread_e.get_attr("scheduler", "shared");
+  auto scheduler = Dataflow::Engine::Scheduler::shared;
+  if (scheduler_s == "work-stealing")
+    scheduler = Dataflow::Engine::Scheduler::work_stealing;
+  else if (scheduler_s != "shared")
+    log.error << "Unknown thread scheduler '" << scheduler_s
+              << "' - using shared\n";
+  engine.set_threads(threads, scheduler);
 
   // Get tick interval from frequency
-  double freq = config_xml.get_child("tick").get_attr_real("frequency",
-                                           Dataflow::default_frequency);
+  const auto& tick_e = config_xml.get_child("tick");
+  double freq = tick_e.get_attr_real("frequency",
+                                     Dataflow::default_frequency);
   if (freq > 0)
     engine.set_tick_interval(Time::Duration(1/freq));
   else
     engine.set_tick_interval(Time::Duration(1/Dataflow::default_frequency));
 
+  // Catch-up policy when ticks fall behind
+  const auto catch_up_s = tick_e.get_attr("catch-up", "burst");
+  auto catch_up = Dataflow::Engine::CatchUp::burst;
+  if (catch_up_s == "drop")
+    catch_up = Dataflow::Engine::CatchUp::drop;
+  else if (catch_up_s == "stretch")
+    catch_up = Dataflow::Engine::CatchUp::stretch;
+  else if (catch_up_s != "burst")
+    log.error << "Unknown tick catch-up policy '" << catch_up_s
+              << "' - using burst\n";
+  engine.set_catch_up(catch_up, tick_e.get_attr_int("max-catch-up", 2));
+
+  // Default resampling between connections at different rates
+  const auto& resampling_e = config_xml.get_child("resampling");
+  const auto resampling_s = resampling_e.get_attr("mode", "nearest");
+  auto resampling = Dataflow::Resampling::nearest;
+  if (resampling_s == "linear")
+    resampling = Dataflow::Resampling::linear;
+  else if (resampling_s == "polyphase")
+    resampling = Dataflow::Resampling::polyphase;
+  else if (resampling_s != "nearest")
+    log.error << "Unknown resampling mode '" << resampling_s
+              << "' - using nearest\n";
+  Dataflow::set_default_resampling(resampling);
+
+  // Per-element tick profiling
+  engine.enable_profiling(tick_e.get_attr_bool("profile"));
+
   // (Re)load modules
   const XML::Element& modules_e = config_xml.get_child("modules");
   for(const auto dir_e: modules_e.get_children("directory"))
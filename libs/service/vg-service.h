@@ -132,6 +132,9 @@ class Server: public MainThreadRunner
   // Load a graph
   bool load_graph(const File::Path& path);
 
+  // Sleep until the next tick is due
+  void wait_for_next_tick();
+
 public:
   //------------------------------------------------------------------------
   // Constructor
@@ -0,0 +1,263 @@
+//==========================================================================
+// ViGraph WAV files: reader.cc
+//
+// Memory-mapped streaming WAV reader
+//
+// Copyright (c) 2019 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-wav.h"
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#if defined(PLATFORM_WINDOWS)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace ViGraph { namespace Wav {
+
+namespace {
+
+const auto format_tag_pcm = 1;
+const auto format_tag_float = 3;
+const auto format_tag_extensible = 0xFFFE;
+
+// Little-endian reads from possibly unaligned data
+uint16_t read_16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+uint32_t read_32(const uint8_t *p)
+{
+  return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+//--------------------------------------------------------------------------
+// Decode a strided run of one sample type, scaled to -1..1
+template<typename T>
+void decode(const uint8_t *p, size_t stride, size_t count, float *out,
+            float scale, float offset = 0.0f)
+{
+  for (auto i = 0u; i < count; ++i, p += stride)
+  {
+    T v;
+    memcpy(&v, p, sizeof(T));
+    out[i] = (static_cast<float>(v) - offset) * scale;
+  }
+}
+
+//--------------------------------------------------------------------------
+// Decode packed 24-bit
+void decode_24(const uint8_t *p, size_t stride, size_t count, float *out)
+{
+  for (auto i = 0u; i < count; ++i, p += stride)
+  {
+    const auto v = static_cast<int32_t>((p[0] << 8) | (p[1] << 16)
+                                        | (static_cast<uint32_t>(p[2]) << 24));
+    out[i] = (v >> 8) * (1.0f / 8388608.0f);
+  }
+}
+
+}
+
+//--------------------------------------------------------------------------
+// Open a file
+void Reader::open(const string& path)
+{
+  close();
+
+#if defined(PLATFORM_WINDOWS)
+  file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                     OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    file = nullptr;
+    throw runtime_error("Can't open "+path);
+  }
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || !size.QuadPart)
+  {
+    close();
+    throw runtime_error("Empty WAV file "+path);
+  }
+
+  map_size = size.QuadPart;
+  mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping) map = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!map)
+  {
+    close();
+    throw runtime_error("Can't map "+path);
+  }
+#else
+  fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw runtime_error("Can't open "+path+": "+strerror(errno));
+
+  struct stat st;
+  if (fstat(fd, &st) < 0 || !st.st_size)
+  {
+    close();
+    throw runtime_error("Empty WAV file "+path);
+  }
+
+  map_size = st.st_size;
+  map = mmap(nullptr, map_size, PROT_READ, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED)
+  {
+    map = nullptr;
+    close();
+    throw runtime_error("Can't map "+path+": "+strerror(errno));
+  }
+#endif
+
+  // Walk the chunks for the format and data
+  const auto base = static_cast<const uint8_t *>(map);
+  const auto end = base + map_size;
+  try
+  {
+    if (map_size < 12 || memcmp(base, "RIFF", 4) || memcmp(base+8, "WAVE", 4))
+      throw runtime_error("Not a WAV file");
+
+    auto have_format = false;
+    for (auto p = base + 12; p + 8 <= end;)
+    {
+      const auto size = static_cast<size_t>(read_32(p+4));
+      const auto body = p + 8;
+      const auto available = min<size_t>(size, end - body);
+
+      if (!memcmp(p, "fmt ", 4))
+      {
+        if (available < 16) throw runtime_error("Short format chunk");
+        auto tag = read_16(body);
+        format.nchannels = read_16(body+2);
+        format.sample_rate = read_32(body+4);
+        format.bits = read_16(body+14);
+        if (tag == format_tag_extensible && available >= 26)
+          tag = read_16(body+24);  // First part of sub-format GUID
+
+        if (tag == format_tag_pcm)
+          format.encoding = Format::Encoding::pcm;
+        else if (tag == format_tag_float)
+          format.encoding = Format::Encoding::ieee_float;
+        else
+          throw runtime_error("Unsupported format tag "+to_string(tag));
+
+        const auto supported = format.encoding == Format::Encoding::pcm
+          ? (format.bits == 8 || format.bits == 16 || format.bits == 24
+             || format.bits == 32)
+          : (format.bits == 32 || format.bits == 64);
+        if (!supported)
+          throw runtime_error("Unsupported sample size "
+                              +to_string(format.bits));
+        if (!format.nchannels)
+          throw runtime_error("No channels");
+        have_format = true;
+      }
+      else if (!memcmp(p, "data", 4))
+      {
+        if (!have_format) throw runtime_error("Data before format");
+        data = body;
+        nframes = available / format.frame_size();
+        break;
+      }
+
+      p = body + size + (size & 1);  // Chunks are word aligned
+    }
+
+    if (!data) throw runtime_error("No data");
+  }
+  catch (const runtime_error& e)
+  {
+    close();
+    throw runtime_error("Bad WAV file "+path+": "+e.what());
+  }
+
+#if !defined(PLATFORM_WINDOWS)
+  madvise(map, map_size, MADV_SEQUENTIAL);
+#endif
+}
+
+//--------------------------------------------------------------------------
+// Close the file
+void Reader::close()
+{
+#if defined(PLATFORM_WINDOWS)
+  if (map) UnmapViewOfFile(map);
+  if (mapping) CloseHandle(mapping);
+  if (file) CloseHandle(file);
+  mapping = file = nullptr;
+#else
+  if (map) munmap(map, map_size);
+  if (fd >= 0) ::close(fd);
+  fd = -1;
+#endif
+  map = nullptr;
+  map_size = 0;
+  data = nullptr;
+  nframes = 0;
+}
+
+//--------------------------------------------------------------------------
+// Decode frames of one channel
+void Reader::read_channel(unsigned channel, size_t start, size_t count,
+                          float *out) const
+{
+  const auto n = (data && channel < format.nchannels && start < nframes)
+                 ? min(count, nframes - start) : 0;
+  fill(out + n, out + count, 0.0f);
+  if (!n) return;
+
+  const auto stride = format.frame_size();
+  const auto p = data + start * stride + channel * (format.bits / 8);
+  if (format.encoding == Format::Encoding::ieee_float)
+  {
+    if (format.bits == 32)
+      decode<float>(p, stride, n, out, 1.0f);
+    else
+      decode<double>(p, stride, n, out, 1.0f);
+    return;
+  }
+
+  switch (format.bits)
+  {
+    case 8:
+      decode<uint8_t>(p, stride, n, out, 1.0f / 128.0f, 128.0f);
+      break;
+    case 16:
+      decode<int16_t>(p, stride, n, out, 1.0f / 32768.0f);
+      break;
+    case 24:
+      decode_24(p, stride, n, out);
+      break;
+    case 32:
+      decode<int32_t>(p, stride, n, out, 1.0f / 2147483648.0f);
+      break;
+  }
+}
+
+//--------------------------------------------------------------------------
+// Advise we'll want these frames soon
+void Reader::prefetch(size_t start, size_t count) const
+{
+#if defined(PLATFORM_WINDOWS)
+  // Left to the system's own read-ahead
+  (void)start; (void)count;
+#else
+  if (!data || start >= nframes) return;
+  count = min(count, nframes - start);
+
+  // madvise needs a page aligned start
+  const auto page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  const auto from = reinterpret_cast<uintptr_t>(data
+                                                + start * format.frame_size());
+  const auto aligned = from & ~(page - 1);
+  const auto length = from - aligned + count * format.frame_size();
+  madvise(reinterpret_cast<void *>(aligned), length, MADV_WILLNEED);
+#endif
+}
+
+}} // namespaces
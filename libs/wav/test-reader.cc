@@ -0,0 +1,150 @@
+//==========================================================================
+// ViGraph WAV files: test-reader.cc
+//
+// Tests for streaming WAV reader
+//
+// Copyright (c) 2019 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-wav.h"
+#include <gtest/gtest.h>
+#include <fstream>
+#include <vector>
+#include <cstdio>
+
+namespace {
+
+using namespace ViGraph;
+using namespace ViGraph::Wav;
+
+const auto test_file = "/tmp/vg-wav-test-reader.wav";
+
+// Little-endian bytes
+string le(uint32_t v, int n)
+{
+  string s;
+  for (auto i = 0; i < n; ++i) s += static_cast<char>((v >> (8*i)) & 0xff);
+  return s;
+}
+
+// Write a WAV file with the given format tag, channels, bits and data
+void write_file(unsigned tag, unsigned nchannels, unsigned bits,
+                const string& data, const string& extra_chunk = "")
+{
+
+  const auto frame = nchannels * bits / 8;
+  const auto fmt = le(tag, 2) + le(nchannels, 2) + le(1000, 4)
+                 + le(1000 * frame, 4) + le(frame, 2) + le(bits, 2);
+  const auto body = string("WAVE")
+                  + "fmt " + le(fmt.size(), 4) + fmt
+                  + extra_chunk
+                  + "data" + le(data.size(), 4) + data;
+  ofstream out(test_file, ios::binary);
+  out << "RIFF" << le(body.size(), 4) << body;
+}
+
+TEST(WavReaderTest, TestMissingFileThrows)
+{
+  Reader reader;
+  ASSERT_THROW(reader.open("/tmp/vg-wav-test-does-not-exist.wav"),
+               runtime_error);
+  EXPECT_FALSE(reader.is_open());
+}
+
+TEST(WavReaderTest, TestBogusFileThrows)
+{
+  {
+    ofstream out(test_file);
+    out << "BOGUS DATA IN HERE";
+  }
+  Reader reader;
+  ASSERT_THROW(reader.open(test_file), runtime_error);
+  EXPECT_FALSE(reader.is_open());
+  remove(test_file);
+}
+
+TEST(WavReaderTest, TestRead16BitStereo)
+{
+  // L: 0, 0.5, -1  R: -0.5, 0.25, 0
+  write_file(1, 2, 16, string("\x00\x00\x00\xc0"
+                              "\x00\x40\x00\x20"
+                              "\x00\x80\x00\x00", 12),
+             string("LIST\x03\x00\x00\x00xyz\x00", 12));
+  Reader reader(test_file);
+  ASSERT_TRUE(reader.is_open());
+  EXPECT_EQ(2, reader.get_format().nchannels);
+  EXPECT_EQ(1000, reader.get_format().sample_rate);
+  ASSERT_EQ(3, reader.get_nframes());
+
+  float left[4], right[4];
+  reader.read_channel(0, 0, 4, left);
+  reader.read_channel(1, 0, 4, right);
+  EXPECT_EQ(0.0, left[0]);
+  EXPECT_EQ(0.5, left[1]);
+  EXPECT_EQ(-1.0, left[2]);
+  EXPECT_EQ(0.0, left[3]);  // Off the end
+  EXPECT_EQ(-0.5, right[0]);
+  EXPECT_EQ(0.25, right[1]);
+  EXPECT_EQ(0.0, right[2]);
+  remove(test_file);
+}
+
+TEST(WavReaderTest, TestReadFromOffset)
+{
+  write_file(1, 1, 8, string("\x80\xc0\x40\x00", 4));
+  Reader reader(test_file);
+  ASSERT_EQ(4, reader.get_nframes());
+  float out[2];
+  reader.read_channel(0, 1, 2, out);
+  EXPECT_EQ(0.5, out[0]);
+  EXPECT_EQ(-0.5, out[1]);
+  remove(test_file);
+}
+
+TEST(WavReaderTest, TestRead24Bit)
+{
+  write_file(1, 1, 24, string("\x00\x00\x40\x00\x00\xc0", 6));
+  Reader reader(test_file);
+  ASSERT_EQ(2, reader.get_nframes());
+  float out[2];
+  reader.read_channel(0, 0, 2, out);
+  EXPECT_EQ(0.5, out[0]);
+  EXPECT_EQ(-0.5, out[1]);
+  remove(test_file);
+}
+
+TEST(WavReaderTest, TestReadFloatExtensible)
+{
+  const float samples[] = { 0.125f, -0.75f };
+  // Extensible header has cbSize, valid bits, mask and GUID after the base
+  const auto guid = string("\x16\x00\x20\x00\x04\x00\x00\x00"
+                           "\x03\x00\x00\x00\x00\x00\x10\x00"
+                           "\x80\x00\x00\xaa\x00\x38\x9b\x71", 24);
+  // Build our own so the format chunk is extended
+  const auto fmt = le(0xFFFE, 2) + le(1, 2) + le(1000, 4) + le(4000, 4)
+                 + le(4, 2) + le(32, 2) + guid;
+  const auto data = string(reinterpret_cast<const char *>(samples), 8);
+  const auto body = string("WAVE") + "fmt " + le(fmt.size(), 4) + fmt
+                  + "data" + le(data.size(), 4) + data;
+  {
+    ofstream out(test_file, ios::binary);
+    out << "RIFF" << le(body.size(), 4) << body;
+  }
+
+  Reader reader(test_file);
+  EXPECT_EQ(Format::Encoding::ieee_float, reader.get_format().encoding);
+  ASSERT_EQ(2, reader.get_nframes());
+  float out[2];
+  reader.read_channel(0, 0, 2, out);
+  EXPECT_EQ(0.125, out[0]);
+  EXPECT_EQ(-0.75, out[1]);
+  remove(test_file);
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,90 @@
+//==========================================================================
+// ViGraph WAV files: test-writer.cc
+//
+// Tests for WAV writer
+//
+// Copyright (c) 2019 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-wav.h"
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+using namespace ViGraph;
+using namespace ViGraph::Wav;
+
+const auto test_file = "/tmp/vg-wav-test-writer.wav";
+
+string read_file()
+{
+  ifstream in(test_file, ios::binary);
+  ostringstream oss;
+  oss << in.rdbuf();
+  return oss.str();
+}
+
+TEST(WavWriterTest, TestBadPathThrows)
+{
+  Writer writer;
+  ASSERT_THROW(writer.open("/nonexistent/dir/out.wav", 2, 44100),
+               runtime_error);
+  EXPECT_FALSE(writer.is_open());
+}
+
+TEST(WavWriterTest, TestWriteAndReadBack)
+{
+  const float samples[] = { 0.0f, -0.5f, 0.5f, 0.25f, -1.0f, 0.0f };
+  {
+    Writer writer;
+    writer.open(test_file, 2, 1000);
+    ASSERT_TRUE(writer.is_open());
+    writer.preallocate(1 << 20);
+    writer.write(samples, 4);
+    writer.write(samples + 4, 2);
+    EXPECT_EQ(3, writer.get_nframes());
+  }
+
+  // Preallocation mustn't change the size
+  EXPECT_EQ(44 + sizeof(samples), read_file().size());
+
+  Reader reader(test_file);
+  const auto& format = reader.get_format();
+  EXPECT_EQ(Format::Encoding::ieee_float, format.encoding);
+  EXPECT_EQ(2, format.nchannels);
+  EXPECT_EQ(1000, format.sample_rate);
+  ASSERT_EQ(3, reader.get_nframes());
+
+  float left[3], right[3];
+  reader.read_channel(0, 0, 3, left);
+  reader.read_channel(1, 0, 3, right);
+  for (auto i = 0; i < 3; ++i)
+  {
+    EXPECT_EQ(samples[i*2], left[i]) << i;
+    EXPECT_EQ(samples[i*2+1], right[i]) << i;
+  }
+  remove(test_file);
+}
+
+TEST(WavWriterTest, TestWriteRaw)
+{
+  const float samples[] = { 0.5f, -0.5f };
+  {
+    Writer writer;
+    writer.open(test_file, 1, 1000, true);
+    writer.write(samples, 2);
+  }
+  EXPECT_EQ(string(reinterpret_cast<const char *>(samples), sizeof(samples)),
+            read_file());
+  remove(test_file);
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,156 @@
+//==========================================================================
+// ViGraph WAV files: vg-wav.h
+//
+// Streaming reader and writer for RIFF WAVE audio files
+//
+// Copyright (c) 2019 Paul Clark.  All rights reserved
+//==========================================================================
+
+#ifndef __VG_WAV_H
+#define __VG_WAV_H
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace ViGraph { namespace Wav {
+
+// Make our lives easier without polluting anyone else
+using namespace std;
+
+//==========================================================================
+// Sample format
+struct Format
+{
+  enum class Encoding
+  {
+    pcm,         // Integer - unsigned if 8 bits, signed otherwise
+    ieee_float
+  };
+
+  Encoding encoding{Encoding::pcm};
+  unsigned bits{16};
+  unsigned nchannels{0};
+  unsigned sample_rate{0};
+
+  // Bytes per interleaved frame of all channels
+  unsigned frame_size() const { return nchannels * bits / 8; }
+};
+
+//==========================================================================
+// WAV reader - memory maps the file and decodes samples on demand, so
+// memory use is constant however long the file is and seeking is free
+class Reader
+{
+#if defined(PLATFORM_WINDOWS)
+  void *file{nullptr};     // HANDLEs
+  void *mapping{nullptr};
+#else
+  int fd{-1};
+#endif
+  void *map{nullptr};
+  size_t map_size{0};
+  const uint8_t *data{nullptr};  // Start of sample data in map
+  size_t nframes{0};
+  Format format;
+
+ public:
+  //-----------------------------------------------------------------------
+  // Constructors
+  Reader() {}
+  Reader(const string& path) { open(path); }
+  Reader(const Reader&) = delete;
+  Reader& operator=(const Reader&) = delete;
+
+  //-----------------------------------------------------------------------
+  // Open a file, closing any existing one
+  // Throws runtime_error if it fails
+  void open(const string& path);
+
+  //-----------------------------------------------------------------------
+  // Close the file
+  void close();
+
+  //-----------------------------------------------------------------------
+  // Is it open?
+  bool is_open() const { return data; }
+
+  //-----------------------------------------------------------------------
+  // Get the format and length
+  const Format& get_format() const { return format; }
+  size_t get_nframes() const { return nframes; }
+
+  //-----------------------------------------------------------------------
+  // Decode count frames of one channel from start, as floats -1..1
+  // Frames beyond the end are silent
+  void read_channel(unsigned channel, size_t start, size_t count,
+                    float *out) const;
+
+  //-----------------------------------------------------------------------
+  // Advise that we'll want these frames soon, so the OS can read ahead
+  void prefetch(size_t start, size_t count) const;
+
+  //-----------------------------------------------------------------------
+  // Destructor
+  ~Reader() { close(); }
+};
+
+//==========================================================================
+// WAV writer - writes 32-bit float samples, as a WAV file or raw, with the
+// header sizes fixed up on close.  Sizes over 4GB are clamped, which most
+// readers take as 'read to the end'
+class Writer
+{
+  FILE *file{nullptr};
+  Format format;
+  bool raw{false};
+  uint64_t data_bytes{0};
+  uint64_t allocated{0};    // Bytes of data reserved on disk
+
+  void write_header();
+
+ public:
+  //-----------------------------------------------------------------------
+  // Constructors
+  Writer() {}
+  Writer(const Writer&) = delete;
+  Writer& operator=(const Writer&) = delete;
+
+  //-----------------------------------------------------------------------
+  // Open a file for writing, replacing any existing one
+  // Throws runtime_error if it fails
+  void open(const string& path, unsigned nchannels, unsigned sample_rate,
+            bool raw = false);
+
+  //-----------------------------------------------------------------------
+  // Is it open?
+  bool is_open() const { return file; }
+
+  //-----------------------------------------------------------------------
+  // Write interleaved samples
+  // Throws runtime_error if it fails
+  void write(const float *data, size_t nsamples);
+
+  //-----------------------------------------------------------------------
+  // Reserve disk space beyond what's written in chunks of this many bytes,
+  // whenever less than half a chunk is left, where the platform allows
+  void preallocate(uint64_t bytes);
+
+  //-----------------------------------------------------------------------
+  // Get the number of frames written
+  uint64_t get_nframes() const
+  { return format.nchannels ? data_bytes / format.frame_size() : 0; }
+
+  //-----------------------------------------------------------------------
+  // Fix up the header and close
+  void close();
+
+  //-----------------------------------------------------------------------
+  // Destructor
+  ~Writer() { close(); }
+};
+
+//==========================================================================
+}} //namespaces
+#endif // !__VG_WAV_H
@@ -0,0 +1,127 @@
+//==========================================================================
+// ViGraph WAV files: writer.cc
+//
+// WAV / raw float writer
+//
+// Copyright (c) 2019 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-wav.h"
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#if defined(__linux__)
+#include <fcntl.h>
+#endif
+
+namespace ViGraph { namespace Wav {
+
+namespace {
+
+const auto header_size = 44;
+const auto format_tag_float = 3;
+
+// Little-endian writes
+void write_16(uint8_t *p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+void write_32(uint8_t *p, uint32_t v)
+{
+  p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+uint32_t clamp_32(uint64_t v) { return min<uint64_t>(v, 0xFFFFFFFF); }
+
+}
+
+//--------------------------------------------------------------------------
+// Open a file for writing
+void Writer::open(const string& path, unsigned nchannels,
+                  unsigned sample_rate, bool _raw)
+{
+  close();
+
+  file = fopen(path.c_str(), "wb");
+  if (!file)
+    throw runtime_error("Can't create "+path+": "+strerror(errno));
+
+  format.encoding = Format::Encoding::ieee_float;
+  format.bits = 32;
+  format.nchannels = nchannels;
+  format.sample_rate = sample_rate;
+  raw = _raw;
+  data_bytes = 0;
+  allocated = 0;
+
+  if (!raw) write_header();
+}
+
+//--------------------------------------------------------------------------
+// Write the header for what we have so far
+void Writer::write_header()
+{
+  uint8_t h[header_size];
+  memcpy(h, "RIFF", 4);
+  write_32(h+4, clamp_32(data_bytes + header_size - 8));
+  memcpy(h+8, "WAVEfmt ", 8);
+  write_32(h+16, 16);
+  write_16(h+20, format_tag_float);
+  write_16(h+22, format.nchannels);
+  write_32(h+24, format.sample_rate);
+  write_32(h+28, format.sample_rate * format.frame_size());
+  write_16(h+32, format.frame_size());
+  write_16(h+34, format.bits);
+  memcpy(h+36, "data", 4);
+  write_32(h+40, clamp_32(data_bytes));
+  if (fwrite(h, 1, header_size, file) != header_size)
+    throw runtime_error(string("Can't write WAV header: ")+strerror(errno));
+}
+
+//--------------------------------------------------------------------------
+// Write interleaved samples
+void Writer::write(const float *data, size_t nsamples)
+{
+  if (!file) return;
+  if (fwrite(data, sizeof(float), nsamples, file) != nsamples)
+    throw runtime_error(string("Can't write audio: ")+strerror(errno));
+  data_bytes += nsamples * sizeof(float);
+}
+
+//--------------------------------------------------------------------------
+// Reserve disk space ahead of what's written
+void Writer::preallocate(uint64_t bytes)
+{
+  if (!file || data_bytes + bytes/2 <= allocated) return;
+
+#if defined(__linux__)
+  // Keep the size, so a crash doesn't leave a tail of zeros
+  const auto offset = (raw ? 0 : header_size) + allocated;
+  const auto length = data_bytes + bytes - allocated;
+  if (fallocate(fileno(file), FALLOC_FL_KEEP_SIZE, offset, length))
+    return;  // Not supported here - just write as we go
+#endif
+  allocated = data_bytes + bytes;
+}
+
+//--------------------------------------------------------------------------
+// Fix up the header and close
+void Writer::close()
+{
+  if (!file) return;
+
+  if (!raw && !fseek(file, 0, SEEK_SET))
+  {
+    try
+    {
+      write_header();
+    }
+    catch (const runtime_error&)
+    {
+      // Nothing more we can do
+    }
+  }
+
+  fclose(file);
+  file = nullptr;
+}
+
+}} // namespaces
@@ -0,0 +1,183 @@
+//==========================================================================
+// ViGraph Waveform library: oscillator.cc
+//
+// Band-limited table/PolyBLEP oscillator
+//
+// Copyright (c) 2019 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-waveform.h"
+#include "vg-geometry.h"
+#include <vector>
+#include <array>
+#include <cmath>
+
+namespace ViGraph { namespace Waveform {
+
+using namespace ViGraph::Geometry;
+
+namespace {
+
+const auto table_bits = 11;
+const auto table_size = 1u << table_bits;
+const auto table_mask = table_size - 1;
+const auto table_levels = table_bits;   // Down to a single harmonic
+
+//--------------------------------------------------------------------------
+// Tables, built once on first use.  Level n of the mip-maps holds the
+// harmonics up to table_size/2 >> n
+struct Tables
+{
+  vector<float> sine;
+  array<vector<float>, table_levels> saw;
+  array<vector<float>, table_levels> triangle;
+
+  // Build a table level from harmonic amplitudes, wrapped with a guard
+  // sample at the end for interpolation
+  static vector<float> build(const vector<double>& sines,
+                             const vector<double>& amplitudes)
+  {
+    auto table = vector<float>(table_size + 1);
+    for (auto i = 0u; i < table_size; ++i)
+    {
+      auto v = 0.0;
+      for (auto k = 1u; k < amplitudes.size(); ++k)
+        if (amplitudes[k])
+          v += amplitudes[k] * sines[(k * i) & table_mask];
+      table[i] = v;
+    }
+    table[table_size] = table[0];
+    return table;
+  }
+
+  Tables()
+  {
+    auto sines = vector<double>(table_size);
+    for (auto i = 0u; i < table_size; ++i)
+      sines[i] = sin(2 * pi * i / table_size);
+
+    sine.assign(sines.begin(), sines.end());
+    sine.push_back(sine[0]);
+
+    for (auto l = 0u; l < table_levels; ++l)
+    {
+      const auto harmonics = (table_size / 2) >> l;
+
+      // Saw rises from 0 with its edge at half a cycle
+      auto amplitudes = vector<double>(harmonics + 1);
+      for (auto k = 1u; k <= harmonics; ++k)
+        amplitudes[k] = (k & 1 ? 2.0 : -2.0) / (pi * k);
+      saw[l] = build(sines, amplitudes);
+
+      // Triangle has odd harmonics only, alternating
+      for (auto k = 1u; k <= harmonics; ++k)
+        amplitudes[k] = k & 1 ? ((k & 2) ? -8.0 : 8.0) / (pi * pi * k * k)
+                              : 0.0;
+      triangle[l] = build(sines, amplitudes);
+    }
+  }
+};
+
+const Tables& get_tables()
+{
+  static const Tables tables;
+  return tables;
+}
+
+//--------------------------------------------------------------------------
+// Table lookup with linear interpolation, phase 0..1
+inline double lookup(const vector<float>& table, double phase)
+{
+  const auto p = phase * table_size;
+  const auto i = static_cast<unsigned>(p) & table_mask;
+  const auto f = p - floor(p);
+  return table[i] + (table[i + 1] - table[i]) * f;
+}
+
+//--------------------------------------------------------------------------
+// PolyBLEP residual for a unit step at phase 0, t 0..1, dt increment
+inline double poly_blep(double t, double dt)
+{
+  if (t < dt)
+  {
+    t /= dt;
+    return t + t - t * t - 1.0;
+  }
+  else if (t > 1.0 - dt)
+  {
+    t = (t - 1.0) / dt;
+    return t * t + t + t + 1.0;
+  }
+  return 0.0;
+}
+
+} // anon
+
+//--------------------------------------------------------------------------
+// Set the frequency as cycles per sample
+void Oscillator::set_increment(double inc)
+{
+  increment = inc;
+
+  // Choose the level with as many harmonics as fit below Nyquist
+  const auto limit = inc ? 0.5 / fabs(inc) : table_size;
+  level = 0;
+  while (level < table_levels - 1
+         && ((table_size / 2) >> level) > limit)
+    ++level;
+}
+
+//--------------------------------------------------------------------------
+// Set the phase
+void Oscillator::set_phase(double p)
+{
+  phase = p - floor(p);
+}
+
+//--------------------------------------------------------------------------
+// Get the waveform value at the current phase plus an offset
+double Oscillator::get_value(Type wf, double width, double offset) const
+{
+  auto theta = phase + offset;
+  if (theta < 0.0 || theta >= 1.0)
+    theta -= floor(theta);
+
+  const auto& tables = get_tables();
+  switch (wf)
+  {
+    case Type::sin:
+      if (band_limited && width == 0.5)
+        return lookup(tables.sine, theta);
+      break;
+
+    case Type::saw:
+      if (band_limited)
+        return lookup(tables.saw[level], theta);
+      break;
+
+    case Type::triangle:
+      if (band_limited && width == 0.5)
+        return lookup(tables.triangle[level], theta);
+      break;
+
+    case Type::square:
+      if (band_limited && increment)
+      {
+        // Rising edge at 0, falling at width - the same either way round
+        const auto dt = fabs(increment);
+        auto fall = theta + 1.0 - width;
+        fall -= floor(fall);
+        return (theta < width ? 1.0 : -1.0)
+               + poly_blep(theta, dt) - poly_blep(fall, dt);
+      }
+      break;
+
+    case Type::none:
+    case Type::random:
+      break;
+  }
+
+  return Waveform::get_value(wf, width, theta);
+}
+
+}} //namespaces
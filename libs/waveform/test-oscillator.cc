@@ -0,0 +1,141 @@
+//==========================================================================
+// ViGraph Waveform library: test-oscillator.cc
+//
+// Tests for band-limited oscillator
+//
+// Copyright (c) 2019 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "vg-waveform.h"
+#include <gtest/gtest.h>
+#include <cmath>
+
+namespace {
+
+using namespace ViGraph;
+using namespace ViGraph::Waveform;
+
+TEST(OscillatorTest, TestSinMatchesExactWaveform)
+{
+  Oscillator osc;
+  osc.set_increment(0.001);
+  for (auto i = 0; i < 1000; ++i)
+  {
+    EXPECT_NEAR(get_value(Type::sin, 0.5, osc.get_phase()),
+                osc.get_value(Type::sin, 0.5), 1e-5) << i;
+    osc.advance();
+  }
+}
+
+TEST(OscillatorTest, TestAdvanceWraps)
+{
+  Oscillator osc;
+  osc.set_increment(0.25);
+  EXPECT_FALSE(osc.advance());
+  EXPECT_FALSE(osc.advance());
+  EXPECT_FALSE(osc.advance());
+  EXPECT_TRUE(osc.advance());
+  EXPECT_EQ(0.0, osc.get_phase());
+}
+
+TEST(OscillatorTest, TestAdvanceWrapsBackwards)
+{
+  Oscillator osc;
+  osc.set_increment(-0.25);
+  EXPECT_TRUE(osc.advance());
+  EXPECT_EQ(0.75, osc.get_phase());
+  EXPECT_FALSE(osc.advance());
+  EXPECT_FALSE(osc.advance());
+  EXPECT_FALSE(osc.advance());
+  EXPECT_EQ(0.0, osc.get_phase());
+  EXPECT_TRUE(osc.advance());
+  EXPECT_EQ(0.75, osc.get_phase());
+}
+
+TEST(OscillatorTest, TestSinIsExactWithoutBandLimiting)
+{
+  Oscillator osc{false};
+  osc.set_increment(0.0123);
+  for (auto i = 0; i < 100; ++i)
+  {
+    EXPECT_EQ(get_value(Type::sin, 0.5, osc.get_phase()),
+              osc.get_value(Type::sin, 0.5)) << i;
+    osc.advance();
+  }
+}
+
+TEST(OscillatorTest, TestOffsetIsWrapped)
+{
+  Oscillator osc;
+  osc.set_phase(0.75);
+  EXPECT_NEAR(0.0, osc.get_value(Type::sin, 0.5, 0.25), 1e-5);
+  EXPECT_NEAR(1.0, osc.get_value(Type::sin, 0.5, -0.5), 1e-5);
+}
+
+TEST(OscillatorTest, TestLowFrequencySawFollowsExactWaveform)
+{
+  // Plenty of harmonics, so close away from the edge
+  Oscillator osc;
+  osc.set_increment(1.0 / 44100);
+  for (auto theta: {0.1, 0.2, 0.3, 0.4, 0.6, 0.7, 0.8, 0.9})
+  {
+    osc.set_phase(theta);
+    EXPECT_NEAR(get_value(Type::saw, 0.5, theta),
+                osc.get_value(Type::saw, 0.5), 0.01) << theta;
+  }
+}
+
+TEST(OscillatorTest, TestHighFrequencySawIsBandLimited)
+{
+  // Half Nyquist leaves just the fundamental and second harmonic
+  Oscillator osc;
+  osc.set_increment(0.25);
+  osc.set_phase(0.1);
+  for (auto i = 0; i < 4; ++i)
+  {
+    const auto theta = osc.get_phase();
+    const auto expected = 2 / M_PI * (sin(2 * M_PI * theta)
+                                                - sin(4 * M_PI * theta) / 2);
+    EXPECT_NEAR(expected, osc.get_value(Type::saw, 0.5), 1e-4) << i;
+    osc.advance();
+  }
+}
+
+TEST(OscillatorTest, TestSquareOnlyCorrectedAtEdges)
+{
+  Oscillator osc;
+  osc.set_increment(0.01);
+  osc.set_phase(0.25);
+  EXPECT_EQ(1.0, osc.get_value(Type::square, 0.5));
+  osc.set_phase(0.75);
+  EXPECT_EQ(-1.0, osc.get_value(Type::square, 0.5));
+
+  // Half way through the edge's sample
+  osc.set_phase(0.0);
+  EXPECT_NEAR(0.0, osc.get_value(Type::square, 0.5), 1e-10);
+  osc.set_phase(0.5);
+  EXPECT_NEAR(0.0, osc.get_value(Type::square, 0.5), 1e-10);
+}
+
+TEST(OscillatorTest, TestUnlimitedGivesExactShapes)
+{
+  Oscillator osc{false};
+  osc.set_increment(0.125);
+  for (auto wf: {Type::saw, Type::square, Type::triangle})
+  {
+    for (auto theta: {0.0, 0.125, 0.3, 0.5, 0.7, 0.875})
+    {
+      osc.set_phase(theta);
+      EXPECT_DOUBLE_EQ(get_value(wf, 0.5, theta), osc.get_value(wf, 0.5))
+        << get_name(wf) << " " << theta;
+    }
+  }
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -11,6 +11,7 @@
 
 #include <string>
 #include <set>
+#include <cmath>
 
 namespace ViGraph { namespace Waveform {
 
@@ -45,6 +46,58 @@ bool get_type(const string& str, Type& wf);
 // Get waveform value (-1..1) for a given type, pulse width and theta
 double get_value(Type wf, double width, double theta);
 
+//==========================================================================
+// Oscillator - a running phase generating any of the waveforms.  When band
+// limited, sin comes from a shared interpolated table, saw and triangle
+// from mip-mapped tables with only the harmonics below Nyquist for the
+// current frequency, and square has PolyBLEP corrections at its edges.
+// Waveforms the tables don't cover (sin or triangle with a pulse width
+// other than 0.5, random) fall back to get_value().  Without band limiting
+// the exact shapes are produced, for control and geometric uses.
+// Increments may be negative, running the phase backwards
+class Oscillator
+{
+private:
+  double phase{0.0};       // 0..1
+  double increment{0.0};   // Cycles per sample
+  unsigned level{0};       // Table mip-map level for increment
+  bool band_limited{true};
+
+public:
+  //------------------------------------------------------------------------
+  // Constructor
+  Oscillator(bool _band_limited = true): band_limited{_band_limited} {}
+
+  //------------------------------------------------------------------------
+  // Set the frequency as cycles per sample (frequency / sample rate) -
+  // only needs calling when it changes
+  void set_increment(double inc);
+
+  //------------------------------------------------------------------------
+  // Set the phase (0..1, wrapped)
+  void set_phase(double p);
+
+  //------------------------------------------------------------------------
+  // Get the phase
+  double get_phase() const { return phase; }
+
+  //------------------------------------------------------------------------
+  // Get the waveform value (-1..1) at the current phase plus an offset
+  double get_value(Type wf, double width, double offset = 0.0) const;
+
+  //------------------------------------------------------------------------
+  // Step to the next sample - returns whether the phase wrapped, in either
+  // direction
+  bool advance()
+  {
+    phase += increment;
+    if (phase >= 0.0 && phase < 1.0)
+      return false;
+    phase -= floor(phase);
+    return true;
+  }
+};
+
 //==========================================================================
 }} //namespaces
 #endif // !__VG_WAVEFORM_H
@@ -51,7 +51,7 @@ public:
   Setting<Number> max_delay{default_max_delay};
   Setting<Number> max_recovery{default_max_recovery};
 
-  Output<AudioData> output;
+  Output<AudioBlock> output;
 
   ~ALSAIn() { shutdown(); }
 };
@@ -167,23 +167,25 @@ void ALSAIn::tick(const TickData& td)
       n = snd_pcm_recover(pcm, n, 1);
     }
 
-    for (auto i = 0u; i < nsamples; ++i)
+    auto& block = get_audio_block(buffer, channels, nsamples);
+    const auto start = pos;
+    for (auto c = 0u; c < channels; ++c)
     {
-      const auto p = fmod(pos, 1);
-      const auto i1 = static_cast<unsigned>(pos);
-      const auto i2 = i1 + 1;
-      buffer.data.push_back(AudioData());
-      auto& ad = buffer.data.back();
-      ad.nchannels = channels;
-      for(auto c=0; c<channels; c++)
+      // Interpolate each channel out of the interleaved input
+      auto s = block.channel(c);
+      pos = start;
+      for (auto i = 0u; i < nsamples; ++i)
       {
+        const auto p = fmod(pos, 1);
+        const auto i1 = static_cast<unsigned>(pos);
+        const auto i2 = i1 + 1;
         const auto c1 = i1 * channels + c;
         const auto c2 = i2 * channels + c;
         const auto s1 = c1 < n ? input_buffer[c1] : 0.0;
         const auto s2 = c2 < n ? input_buffer[c2] : s1;
-        ad.channels[c] = s1 + (s2 - s1) * p;
+        s[i] = s1 + (s2 - s1) * p;
+        pos += step;
       }
-      pos += step;
     }
   }
 }
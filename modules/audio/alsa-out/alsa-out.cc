@@ -7,7 +7,11 @@
 //==========================================================================
 
 #include "../audio-module.h"
+#include "vg-dsp.h"
 #include <alsa/asoundlib.h>
+#include <pthread.h>
+#include <cstring>
+#include <thread>
 
 namespace {
 
@@ -17,20 +21,36 @@ const auto default_device{"default"};
 const auto default_sample_rate{44100};
 const auto default_channels = 2;
 const auto default_start_threshold = 2000;
+const auto default_latency = 0.05;
+const auto ring_time = 1.0;  // Capacity of ring, seconds
 
 //==========================================================================
 // ALSA out
 class ALSAOut: public SimpleElement
 {
 private:
+  AudioBlock held_input;        // Input held over a tick with no data
   snd_pcm_t *pcm = nullptr;
-  vector<float> output_buffer;
+  snd_pcm_uframes_t period_size{0};
+  unsigned open_channels{0};
+  unsigned open_sample_rate{0};
+  size_t target{0};             // Latency to hold in the ring, samples
+  vector<float> output_buffer;  // Reused each tick
+  DSP::SampleRing ring;         // Interleaved, from tick to write thread
+  atomic<bool> stop_write_thread{false};
+  unique_ptr<thread> write_thread;
+  atomic<uint64_t> xruns{0};
+  uint64_t reported_xruns{0};
 
   // Source/Element virtuals
   void setup(const SetupContext& context) override;
   void tick(const TickData& td) override;
   void shutdown();
 
+  // Internal
+  void start_write_thread();
+  void run_write_thread();
+
   // Clone
   ALSAOut *create_clone() const override
   {
@@ -44,8 +64,11 @@ public:
   Setting<Number> sample_rate{default_sample_rate};
   Setting<Number> nchannels{default_channels};
   Setting<Number> start_threshold{default_start_threshold};
+  Setting<Number> latency{default_latency};
+  Setting<bool> mmap{false};
+  Setting<Integer> priority{0};
 
-  Input<AudioData> input;
+  Input<AudioBlock> input;
 
   ~ALSAOut() { shutdown(); }
 };
@@ -65,9 +88,9 @@ void ALSAOut::setup(const SetupContext& context)
 
   try
   {
-    // Open PCM
+    // Open PCM - blocking, since only the write thread waits on it
     auto status = snd_pcm_open(&pcm, device.get().c_str(),
-                               SND_PCM_STREAM_PLAYBACK, SND_PCM_NONBLOCK);
+                               SND_PCM_STREAM_PLAYBACK, 0);
     if (status < 0)
       throw runtime_error(string("open: ")+snd_strerror(status));
 
@@ -80,7 +103,9 @@ void ALSAOut::setup(const SetupContext& context)
       throw runtime_error(string("hw_params_any: ")+snd_strerror(status));
 
     status = snd_pcm_hw_params_set_access(pcm, hw_params,
-                                          SND_PCM_ACCESS_RW_INTERLEAVED);
+                                          mmap
+                                          ? SND_PCM_ACCESS_MMAP_INTERLEAVED
+                                          : SND_PCM_ACCESS_RW_INTERLEAVED);
     if (status < 0)
       throw runtime_error(string("hw_params_access: ")+snd_strerror(status));
 
@@ -104,6 +129,11 @@ void ALSAOut::setup(const SetupContext& context)
     if (status < 0)
       throw runtime_error(string("hw_params_set: ")+snd_strerror(status));
 
+    status = snd_pcm_hw_params_get_period_size(hw_params, &period_size, 0);
+    if (status < 0)
+      throw runtime_error(string("hw_params_period: ")+snd_strerror(status));
+    log.detail << "ALSA: period size " << period_size << endl;
+
     // Set up, configure and use swparams
     snd_pcm_sw_params_t *sw_params;
     snd_pcm_sw_params_alloca(&sw_params);
@@ -128,6 +158,11 @@ void ALSAOut::setup(const SetupContext& context)
       throw runtime_error(string("prepare: ")+snd_strerror(status));
 
     input.set_sample_rate(srate);
+    open_channels = nchannels;
+    open_sample_rate = srate;
+    ring.resize(ring_time * srate * open_channels);
+    target = max<size_t>(latency * srate, period_size) * open_channels;
+    start_write_thread();
 
     log.detail << "Created ALSA audio out\n";
   }
@@ -137,6 +172,98 @@ void ALSAOut::setup(const SetupContext& context)
   }
 }
 
+//--------------------------------------------------------------------------
+// Start the write thread, at real-time priority if asked
+void ALSAOut::start_write_thread()
+{
+  stop_write_thread = false;
+  write_thread.reset(new thread([this] { run_write_thread(); }));
+
+  if (priority > 0)
+  {
+    sched_param param{};
+    param.sched_priority = priority;
+    const auto status = pthread_setschedparam(write_thread->native_handle(),
+                                              SCHED_FIFO, &param);
+    if (status)
+    {
+      Log::Error log;
+      log << "Can't set ALSA write thread to real-time priority "
+          << priority << ": " << strerror(status) << endl;
+    }
+  }
+}
+
+//--------------------------------------------------------------------------
+// Write thread - feeds the device a period at a time from the ring,
+// blocking on the device rather than the engine
+void ALSAOut::run_write_thread()
+{
+  auto period = vector<float>(period_size * open_channels);
+  const auto period_time = chrono::duration<double>(
+                             static_cast<double>(period_size)
+                             / open_sample_rate);
+  auto started = false;
+  auto primed = false;
+  while (!stop_write_thread)
+  {
+    // Wait for the target latency to build up before playing, and again
+    // after an underrun
+    const auto available = ring.available();
+    if (!primed && available >= target)
+      primed = true;
+
+    if (primed && available >= period.size())
+    {
+      ring.read(period.data(), period.size());
+      started = true;
+    }
+    else
+    {
+      if (primed)
+      {
+        ring.note_underrun();
+        primed = false;
+      }
+
+      // Nothing to play yet - don't queue up silence ahead of the audio
+      if (!started)
+      {
+        this_thread::sleep_for(period_time);
+        continue;
+      }
+
+      // Keep the device fed while the engine catches up
+      fill(period.begin(), period.end(), 0.0f);
+    }
+
+    // If the engine is running ahead of the device, drop back to target
+    // latency rather than letting it drift up to the whole ring
+    if (ring.available() > 2 * target)
+    {
+      ring.note_overrun();
+      ring.skip(ring.available() - target);
+    }
+
+    auto p = period.data();
+    auto frames = static_cast<snd_pcm_sframes_t>(period_size);
+    while (frames > 0 && !stop_write_thread)
+    {
+      auto n = mmap ? snd_pcm_mmap_writei(pcm, p, frames)
+                    : snd_pcm_writei(pcm, p, frames);
+      if (n < 0)
+      {
+        if (n == -EPIPE) xruns++;
+        n = snd_pcm_recover(pcm, n, 1);
+        if (n < 0) break;
+        continue;
+      }
+      p += n * open_channels;
+      frames -= n;
+    }
+  }
+}
+
 //--------------------------------------------------------------------------
 // Process some data
 void ALSAOut::tick(const TickData& td)
@@ -144,29 +271,32 @@ void ALSAOut::tick(const TickData& td)
   if (pcm)
   {
     const auto nsamples = td.samples_in_tick(input.get_sample_rate());
-    const auto channels = nchannels;
-    output_buffer.clear();
-    output_buffer.reserve(nsamples * channels);
-    sample_iterate(td, nsamples, {},
-                   tie(input), {},
-                   [&](const AudioData& input)
+    const auto channels = open_channels;
+    const auto& in = get_audio_block(input, nsamples, held_input);
+
+    // Interleave each channel in, zeroing any we don't get
+    output_buffer.resize(nsamples * channels);
+    fill(output_buffer.begin(), output_buffer.end(), 0);
+    const auto count = min<size_t>(nsamples, in.get_nsamples());
+    for (auto c = 0u; c < min(channels, in.get_nchannels()); ++c)
     {
-      for(auto c=0; c<input.nchannels; c++)
-        output_buffer.emplace_back(input.channels[c]);
+      const auto s = in.channel(c);
+      auto p = &output_buffer[c];
+      for (auto i = 0u; i < count; ++i)
+        p[i * channels] = s[i];
+    }
 
-      // Zero any we don't get
-      for(auto c=input.nchannels; c<channels; c++)
-        output_buffer.emplace_back(0);
-    });
+    // Hand over to the write thread - if the ring is full, this is dropped
+    // (counted by the ring)
+    ring.write(output_buffer.data(), output_buffer.size());
 
-    auto n = snd_pcm_writei(pcm, output_buffer.data(),
-                            output_buffer.size() / channels);
-    if (n < 0)
+    // Report xruns here rather than on the write thread
+    const auto x = xruns.load();
+    if (x != reported_xruns)
     {
       Log::Error log;
-      log << "ALSA write error: " << snd_strerror(n) << endl;
-
-      n = snd_pcm_recover(pcm, n, 1);
+      log << "ALSA output xrun (" << x << " total)\n";
+      reported_xruns = x;
     }
   }
 }
@@ -175,7 +305,18 @@ void ALSAOut::tick(const TickData& td)
 // Shut down
 void ALSAOut::shutdown()
 {
-  if (pcm) snd_pcm_close(pcm);
+  stop_write_thread = true;
+  if (!!write_thread) write_thread->join();
+  write_thread.reset();
+
+  if (pcm)
+  {
+    snd_pcm_close(pcm);
+    Log::Detail log;
+    log << "ALSA audio out: " << xruns << " xruns, "
+        << ring.get_underruns() << " underruns, "
+        << ring.get_overruns() << " overruns\n";
+  }
   pcm = nullptr;
 }
 
@@ -191,6 +332,9 @@ Dataflow::SimpleModule module
     { "sample-rate", &ALSAOut::sample_rate },
     { "channels", &ALSAOut::nchannels },
     { "start-threshold", &ALSAOut::start_threshold },
+    { "latency", &ALSAOut::latency },
+    { "mmap", &ALSAOut::mmap },
+    { "priority", &ALSAOut::priority },
   },
   {
     { "input", &ALSAOut::input }
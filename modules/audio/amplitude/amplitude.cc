@@ -15,6 +15,8 @@ namespace {
 class AmplitudeFilter: public SimpleElement
 {
 private:
+  AudioBlock held_input;  // Input held over a tick with no data
+
   // Element virtuals
   void tick(const TickData& td) override;
 
@@ -28,7 +30,7 @@ public:
   using SimpleElement::SimpleElement;
 
   Setting<Integer> channel{0};
-  Input<AudioData> input{0.0};
+  Input<AudioBlock> input{0.0};
   Output<Number> output;
 };
 
@@ -37,14 +39,24 @@ public:
 void AmplitudeFilter::tick(const TickData& td)
 {
   const auto nsamples = td.samples_in_tick(output.get_sample_rate());
-  sample_iterate(td, nsamples, {}, tie(input), tie(output),
-                 [&](const AudioData& input, Number& output)
+  const auto c = static_cast<unsigned>(channel.get());
+  const auto& in = get_audio_block(input, nsamples, held_input);
+
+  auto out = output.get_buffer(td);
+  resize_buffer(out.data, nsamples);
+  if (c < in.get_nchannels())
   {
-    if (channel < input.nchannels)
-      output = input.channels[channel] / 2.0 + 0.5;  // Range to 0..1
-    else
-      output = 0;
-  });
+    // Range to 0..1, with silence beyond the end of the input
+    const auto n = min<size_t>(nsamples, in.get_nsamples());
+    const auto s = in.channel(c);
+    for (auto i = 0u; i < n; ++i)
+      out.data[i] = s[i] / 2.0 + 0.5;
+    fill(out.data.begin() + n, out.data.end(), 0.5);
+  }
+  else
+  {
+    fill(out.data.begin(), out.data.end(), 0);
+  }
 }
 
 Dataflow::SimpleModule module
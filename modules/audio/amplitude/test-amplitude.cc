@@ -6,8 +6,7 @@
 // Copyright (c) 2019 Paul Clark.  All rights reserved
 //==========================================================================
 
-#include "../../module-test.h"
-#include "../audio-module.h"
+#include "../audio-module-test.h"
 
 class AmplitudeTest: public GraphTester
 {
@@ -22,9 +21,9 @@ TEST_F(AmplitudeTest, TestExtractionValidChannel)
 {
   auto& amp = add("audio/amplitude");
 
-  const auto input = vector<AudioData>{ -1, 0, 1 };
+  const auto input = vector<sample_t>{ -1, 0, 1 };
   const auto expected = vector<Number>{ 0, 0.5, 1 };
-  auto& isrc = add_source(input);
+  auto& isrc = add_source(vector<AudioBlock>{input});
   isrc.connect("output", amp, "input");
 
   auto actual = vector<Number>{};
@@ -42,9 +41,9 @@ TEST_F(AmplitudeTest, TestExtractionInvalidChannel)
 {
   auto& amp = add("audio/amplitude").set("channel", Integer{1});
 
-  const auto input = vector<AudioData>{ -1, 0, 1 };
+  const auto input = vector<sample_t>{ -1, 0, 1 };
   const auto expected = vector<Number>{ 0, 0, 0 };
-  auto& isrc = add_source(input);
+  auto& isrc = add_source(vector<AudioBlock>{input});
   isrc.connect("output", amp, "input");
 
   auto actual = vector<Number>{};
@@ -14,37 +14,19 @@
 
 namespace ViGraph { namespace Module { namespace Test {
 
-// Acceptor class to capture output
-class Catcher: public Acceptor
+// Audio test sources send one block per tick, cycling through the data
+template<>
+inline void TestSource<AudioBlock>::tick(const TickData& td)
 {
-public:
-  shared_ptr<Fragment> last_fragment;
-
-  void accept(DataPtr data) override
-  {
-    last_fragment = data.check<Fragment>();
-  }
-};
-
-// Test harness which catches fragments
-class FragmentGraphTester: public GraphTester
-{
-  Catcher catcher;
-
-public:
-  FragmentGraphTester(ModuleLoader& _loader):
-    GraphTester(_loader, Value::Type::number, 44100)
-  {}
-
-  void run(int nticks=1)
-  {
-    graph.set_send_up_function([this](DataPtr data)
-                               { catcher.accept(data); });
-    test(nticks);
-  }
-
-  Fragment *get_fragment() { return catcher.last_fragment.get(); }
-};
+  auto out = output.get_buffer(td);
+  if (data.empty())
+    return;
+
+  resize_buffer(out.data, 1);
+  out.data.front() = data[pos++];
+  if (pos >= data.size())
+    pos = 0;
+}
 
 }}} // namespaces
 
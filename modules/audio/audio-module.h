@@ -11,6 +11,7 @@
 
 #include "../module.h"
 #include <array>
+#include <algorithm>
 
 namespace ViGraph { namespace Module { namespace Audio {
 
@@ -21,34 +22,146 @@ using sample_t = float;           // Unsigned linear PCM -1.0..1.0
 const unsigned int sample_rate = 44100;
 const size_t max_channels = 8;
 
+// One sample across all channels, for modules which need to hold audio
+// sample by sample
+using AudioFrame = array<sample_t, max_channels>;
+
 //--------------------------------------------------------------------------
-// Audio data
-struct AudioData
+// Audio block - a whole tick of multichannel audio, stored planar with
+// each channel's samples contiguous, so kernels can run down a channel
+// without striding over the others.  Storage is kept when resized or
+// cleared, so steady-state ticks don't allocate
+class AudioBlock
 {
-  int nchannels{0};                         // Number of samples valid in...
-  array<sample_t, max_channels> channels;
+private:
+  unsigned nchannels{0};
+  unsigned nsamples{0};
+  vector<sample_t> samples;     // nchannels runs of nsamples
+
+public:
+  AudioBlock() {}
+  AudioBlock(unsigned _nchannels, unsigned _nsamples)
+  {
+    resize(_nchannels, _nsamples);
+  }
+  // Single sample, single channel - for constant inputs
+  AudioBlock(sample_t s): nchannels{1}, nsamples{1}, samples{s} {}
+  // Special for tests, single channel
+  AudioBlock(const vector<sample_t>& mono):
+    nchannels{1}, nsamples(mono.size()), samples{mono} {}
 
-  AudioData() {}
-  AudioData(const decltype(channels)& _c):
-    nchannels(_c.size()), channels(_c) {}
-  // Special for tests, single item
-  AudioData(sample_t s): nchannels(1) { channels[0] = s; }
+  unsigned get_nchannels() const { return nchannels; }
+  unsigned get_nsamples() const { return nsamples; }
+  bool empty() const { return !nchannels || !nsamples; }
+
+  // Access a channel's samples
+  sample_t *channel(unsigned c) { return samples.data() + c * nsamples; }
+  const sample_t *channel(unsigned c) const
+  { return samples.data() + c * nsamples; }
+
+  // Get a sample, reading silence outside the block
+  sample_t get(unsigned c, unsigned i) const
+  {
+    return (c < nchannels && i < nsamples) ? samples[c * nsamples + i] : 0;
+  }
 
-  // Combine operator
-  AudioData& operator+=(const AudioData& o)
+  // Resize, keeping existing samples and zeroing any new ones
+  void resize(unsigned _nchannels, unsigned _nsamples)
   {
-    auto same_channels = min(nchannels, o.nchannels);
-    for(auto c=0; c<same_channels; c++)  // Both have
-      channels[c] += o.channels[c];
-    for(auto c=same_channels; c<o.nchannels; c++)  // Only they have
-      channels[c] = o.channels[c];
-    // Ones only we have can be left alone
-
-    nchannels = max(nchannels, o.nchannels);
+    if (_nchannels == nchannels && _nsamples == nsamples)
+      return;
+
+    const auto keep = min(nchannels, _nchannels);
+    if (_nsamples > nsamples)
+    {
+      // Spread out, last channel first so nothing is overwritten
+      Dataflow::resize_buffer(samples, max(nchannels * nsamples,
+                                           _nchannels * _nsamples));
+      for (auto c = keep; c-- > 0;)
+      {
+        const auto from = samples.begin() + c * nsamples;
+        const auto to = samples.begin() + c * _nsamples;
+        copy_backward(from, from + nsamples, to + nsamples);
+        fill(to + nsamples, to + _nsamples, 0);
+      }
+    }
+    else if (_nsamples < nsamples)
+    {
+      // Close up, first channel first
+      for (auto c = 0u; c < keep; ++c)
+      {
+        const auto from = samples.begin() + c * nsamples;
+        copy(from, from + _nsamples, samples.begin() + c * _nsamples);
+      }
+    }
+
+    Dataflow::resize_buffer(samples, _nchannels * _nsamples);
+    fill(samples.begin() + keep * _nsamples, samples.end(), 0);
+    nchannels = _nchannels;
+    nsamples = _nsamples;
+  }
+
+  // Clear to nothing, keeping the storage
+  void clear()
+  {
+    nchannels = nsamples = 0;
+  }
+
+  // Combine operator - mixes channel by channel, extending to cover both
+  AudioBlock& operator+=(const AudioBlock& o)
+  {
+    resize(max(nchannels, o.nchannels), max(nsamples, o.nsamples));
+    for (auto c = 0u; c < o.nchannels; ++c)
+    {
+      auto to = channel(c);
+      const auto from = o.channel(c);
+      for (auto i = 0u; i < o.nsamples; ++i)
+        to[i] += from[i];
+    }
     return *this;
   }
 };
 
+//--------------------------------------------------------------------------
+// Get the block from an audio input for a tick of nsamples.  As with
+// sample_iterate, if nothing was sent the last sample received is held for
+// the whole tick, and if unconnected the input's own value is; these are
+// expanded into 'held', which keeps its storage between ticks
+inline const AudioBlock& get_audio_block(Dataflow::Input<AudioBlock>& input,
+                                         unsigned nsamples, AudioBlock& held)
+{
+  const auto& buffer = input.get_buffer();
+  const auto sent = !buffer.empty() && !buffer.front().empty();
+  if (sent && buffer.front().get_nsamples() >= nsamples)
+    return buffer.front();
+
+  const auto& from = sent ? buffer.front()
+                     : (input.connected() ? input.get_last_value()
+                                          : input.get());
+  const auto n = min(from.get_nsamples(), nsamples);
+  held.clear();
+  held.resize(from.get_nchannels(), nsamples);
+  for (auto c = 0u; c < from.get_nchannels(); ++c)
+  {
+    const auto f = from.channel(c);
+    auto h = held.channel(c);
+    copy(f, f + n, h);
+    fill(h + n, h + nsamples, n ? f[n - 1] : 0);
+  }
+  return held;
+}
+
+// Get the block for an audio output buffer, sized and silent
+inline AudioBlock& get_audio_block(Dataflow::Output<AudioBlock>::Buffer& out,
+                                   unsigned nchannels, unsigned nsamples)
+{
+  Dataflow::resize_buffer(out.data, 1);
+  auto& block = out.data.front();
+  block.clear();
+  block.resize(nchannels, nsamples);
+  return block;
+}
+
 }}}
 
 using namespace ViGraph::Module::Audio;
@@ -56,34 +169,114 @@ using namespace ViGraph::Module::Audio;
 namespace ViGraph { namespace Dataflow {
 
 template<> inline
-string get_module_type<AudioData>() { return "audio"; }
+string get_module_type<AudioBlock>() { return "audio"; }
 
-template<> inline void set_from_json(AudioData& audio,
+// JSON holds a single frame, one sample per channel - set gives a one
+// sample block, get gives the last sample of each channel
+template<> inline void set_from_json(AudioBlock& audio,
                                      const JSON::Value& json)
 {
+  audio.clear();
   if (json.type == JSON::Value::OBJECT)
   {
-    audio.nchannels = json["n"].as_int();
+    const auto n = json["n"].as_int();
+    const auto nchannels = n > 0 ? min<unsigned>(n, max_channels) : 0u;
+    audio.resize(nchannels, 1);
     const auto& jchans = json["c"];
     if (jchans.type == JSON::Value::ARRAY)
     {
-      for(auto i=0; i<audio.nchannels; i++)
-        audio.channels[i] = jchans[i].as_float();
+      for (auto c = 0u; c < nchannels && c < jchans.a.size(); ++c)
+        audio.channel(c)[0] = jchans[c].as_float();
     }
   }
 }
 
-template<> inline JSON::Value get_as_json(const AudioData& audio)
+template<> inline JSON::Value get_as_json(const AudioBlock& audio)
 {
   JSON::Value value{JSON::Value::OBJECT};
-  value["n"] = audio.nchannels;
+  const auto nchannels = audio.get_nsamples() ? audio.get_nchannels() : 0;
+  value["n"] = static_cast<int>(nchannels);
   auto& jchans = value.put("c", JSON::Value::ARRAY);
-  for(auto i=0; i<audio.nchannels; i++)
-    jchans.add(audio.channels[i]);
-
+  for (auto c = 0u; c < nchannels; ++c)
+    jchans.add(audio.channel(c)[audio.get_nsamples() - 1]);
   return value;
 }
 
+// Blocks keep their storage between ticks
+template<> inline void clear_buffer(vector<AudioBlock>& buffer)
+{
+  if (buffer.size() > 1)
+    buffer.resize(1);
+  if (!buffer.empty())
+    buffer.front().clear();
+}
+
+// Keep just the last sample of each channel to hold over a tick where
+// nothing is sent, rather than copying the whole block
+template<> inline void keep_last_value(const vector<AudioBlock>& buffer,
+                                       AudioBlock& last_value)
+{
+  if (buffer.empty() || buffer.front().empty())
+    return;
+
+  const auto& block = buffer.front();
+  const auto last = block.get_nsamples() - 1;
+  last_value.clear();
+  last_value.resize(block.get_nchannels(), 1);
+  for (auto c = 0u; c < block.get_nchannels(); ++c)
+    last_value.channel(c)[0] = block.channel(c)[last];
+}
+
+// Resampling runs each channel through its own resampler
+template<>
+struct ResampleState<AudioBlock>
+{
+  static const bool interpolates = true;
+  array<SampleResampler, max_channels> resamplers;
+  vector<double> from, to;   // One channel at a time
+};
+
+// A block carries the whole tick, so is resampled within itself if the
+// input wants a different number of samples
+template<> inline bool resample_tick(const vector<AudioBlock>& from,
+                                     vector<AudioBlock>& to,
+                                     size_t nsamples, Resampling mode,
+                                     ResampleState<AudioBlock>& state)
+{
+  if (from.empty() || from.front().empty() || !nsamples
+      || from.front().get_nsamples() == nsamples)
+    return false;
+
+  const auto& block = from.front();
+  const auto fsize = block.get_nsamples();
+  const auto nchannels = min(block.get_nchannels(),
+                             static_cast<unsigned>(max_channels));
+  resize_buffer(to, 1);
+  auto& result = to.front();
+  result.clear();
+  result.resize(nchannels, nsamples);
+
+  resize_buffer(state.from, fsize);
+  resize_buffer(state.to, nsamples);
+  for (auto c = 0u; c < nchannels; ++c)
+  {
+    const auto f = block.channel(c);
+    auto t = result.channel(c);
+    if (mode == Resampling::nearest)
+    {
+      for (auto i = 0u; i < nsamples; ++i)
+        t[i] = f[(i * fsize) / nsamples];
+      continue;
+    }
+
+    copy(f, f + fsize, state.from.begin());
+    state.resamplers[c].resample(state.from.data(), fsize,
+                                 state.to.data(), nsamples, mode);
+    copy(state.to.begin(), state.to.end(), t);
+  }
+  return true;
+}
+
 //==========================================================================
 }} //namespaces
 
@@ -21,9 +21,14 @@ using namespace ViGraph::Geometry;
 class BitCrush: public SimpleElement
 {
 private:
-  AudioData last_sample;
+  AudioBlock held_input;  // Input held over a tick with no data
+  AudioFrame last_sample{};
   unsigned samples_ago = numeric_limits<unsigned>::max() - 1;
 
+  // Per-sample hold and quantise decisions, shared by all channels
+  vector<uint8_t> takes;
+  vector<sample_t> scales;
+
   // Element virtuals
   void tick(const TickData& td) override;
 
@@ -37,10 +42,10 @@ public:
   using SimpleElement::SimpleElement;
 
   // Configuration
-  Input<AudioData> input;
+  Input<AudioBlock> input;
   Input<Number> rate{default_rate};
   Input<Number> bits{default_bits};
-  Output<AudioData> output;
+  Output<AudioBlock> output;
 };
 
 //--------------------------------------------------------------------------
@@ -49,27 +54,55 @@ void BitCrush::tick(const TickData& td)
 {
   const auto sample_rate = output.get_sample_rate();
   const auto nsamples = td.samples_in_tick(sample_rate);
-  sample_iterate(td, nsamples, {}, tie(input, rate, bits), tie(output),
-                 [&](const AudioData& i, Number r, Number b, AudioData& o)
+  const auto& in = get_audio_block(input, nsamples, held_input);
+  const auto nchannels = min<size_t>(in.get_nchannels(), max_channels);
+  const auto n = min<size_t>(nsamples, in.get_nsamples());
+  const auto r = rate.get_block(nsamples);
+  const auto b = bits.get_block(nsamples);
+
+  // Sample and hold to reduce rate, and quantise to bits, only
+  // recalculating the scale when bits change
+  resize_buffer(takes, nsamples);
+  resize_buffer(scales, nsamples);
+  auto last_bits = 0.0;
+  auto max = 0.0;
+  for (auto i = 0u; i < nsamples; ++i)
   {
-    if (!r || ++samples_ago >= sample_rate / r)
-    {
-      last_sample = o = i;
+    takes[i] = !r[i] || ++samples_ago >= sample_rate / r[i];
+    if (takes[i])
       samples_ago = 0;
+
+    const auto nbits = round(b[i]);
+    if (nbits && nbits != last_bits)
+    {
+      max = pow(2, nbits) - 1;
+      last_bits = nbits;
     }
-    else
+    scales[i] = nbits ? max : 0;
+  }
+
+  auto out = output.get_buffer(td);
+  auto& o = get_audio_block(out, nchannels, nsamples);
+  for (auto c = 0u; c < nchannels; ++c)
+  {
+    const auto x = in.channel(c);
+    auto y = o.channel(c);
+    auto held = last_sample[c];
+    for (auto i = 0u; i < nsamples; ++i)
     {
-      o = last_sample;
+      if (takes[i])
+        held = i < n ? x[i] : 0;
+      y[i] = held;
     }
-    b = round(b);
-    if (b)
+    last_sample[c] = held;
+
+    for (auto i = 0u; i < nsamples; ++i)
     {
-      const auto max = pow(2, b) - 1;
-      for(auto c=0; c<o.nchannels; c++)
-        o.channels[c] = (2.0 * (round(((o.channels[c] + 1.0) * 0.5) * max)
-                                / max)) - 1.0;
+      const auto m = scales[i];
+      if (m)
+        y[i] = (2.0 * (round(((y[i] + 1.0) * 0.5) * m) / m)) - 1.0;
     }
-  });
+  }
 }
 
 Dataflow::SimpleModule module
@@ -6,8 +6,7 @@
 // Copyright (c) 2019 Paul Clark.  All rights reserved
 //==========================================================================
 
-#include "../../module-test.h"
-#include "../audio-module.h"
+#include "../audio-module-test.h"
 #include "vg-geometry.h"
 #include "vg-waveform.h"
 
@@ -27,17 +26,14 @@ const auto samples = 1;
 TEST_F(BitCrushTest, TestNoInput)
 {
   auto& btc = add("audio/bit-crush");
-  auto actual = vector<AudioData>{};
+  auto actual = vector<AudioBlock>{};
   auto& snk = add_sink(actual, samples);
   btc.connect("output", snk, "input");
 
   run();
 
-  EXPECT_EQ(samples, actual.size());
-  for(auto i = 0u; i < samples; ++i)
-  {
-    EXPECT_DOUBLE_EQ(0.0, actual[i].nchannels);
-  }
+  ASSERT_EQ(1, actual.size());
+  EXPECT_EQ(0, actual[0].get_nchannels());
 }
 
 TEST_F(BitCrushTest, TestBits)
@@ -45,48 +41,48 @@ TEST_F(BitCrushTest, TestBits)
   auto& btc = add("audio/bit-crush")
               .set("bits", 2.0);
 
-  const auto input = vector<AudioData>{ -1, -0.8, -0.6, -0.4, -0.2, 0,
-                                        0.2, 0.4, 0.6, 0.8, 1 };
+  const auto input = vector<sample_t>{ -1, -0.8, -0.6, -0.4, -0.2, 0,
+                                       0.2, 0.4, 0.6, 0.8, 1 };
   const auto expected = vector<sample_t>{-1, -1, -1.0/3.0, -1.0/3.0, -1.0/3.0,
                                          1.0/3.0, 1.0/3.0, 1.0/3.0, 1.0/3.0,
                                          1, 1};
-  auto& src = add_source(input);
-  auto actual = vector<AudioData>{};
+  auto& src = add_source(vector<AudioBlock>{input});
+  auto actual = vector<AudioBlock>{};
   auto& snk = add_sink(actual, input.size());
   src.connect("output", btc, "input");
   btc.connect("output", snk, "input");
 
   run();
 
-  EXPECT_EQ(expected.size(), actual.size());
-  for(auto i = 0u; i < actual.size(); ++i)
-  {
-    EXPECT_EQ(1, actual[i].nchannels);
-    EXPECT_DOUBLE_EQ(expected[i], actual[i].channels[0]);
-  }
+  ASSERT_EQ(1, actual.size());
+  const auto& block = actual[0];
+  ASSERT_EQ(1, block.get_nchannels());
+  ASSERT_EQ(expected.size(), block.get_nsamples());
+  for(auto i = 0u; i < expected.size(); ++i)
+    EXPECT_DOUBLE_EQ(expected[i], block.channel(0)[i]) << i;
 }
 
 TEST_F(BitCrushTest, TestSampleRate)
 {
   auto& btc = add("audio/bit-crush")
               .set("rate", 2.0);
-  const auto input = vector<AudioData>{-1, -0.8, -0.6, -0.4, -0.2, 0, 0.2, 0.4};
+  const auto input = vector<sample_t>{-1, -0.8, -0.6, -0.4, -0.2, 0, 0.2, 0.4};
   const auto expected = vector<sample_t>{-1, -1, -1, -1,
                                          -0.2, -0.2, -0.2, -0.2};
-  auto& src = add_source(input);
-  auto actual = vector<AudioData>{};
+  auto& src = add_source(vector<AudioBlock>{input});
+  auto actual = vector<AudioBlock>{};
   auto& snk = add_sink(actual, input.size());
   src.connect("output", btc, "input");
   btc.connect("output", snk, "input");
 
   run();
 
-  EXPECT_EQ(expected.size(), actual.size());
-  for(auto i = 0u; i < actual.size(); ++i)
-  {
-    EXPECT_EQ(1, actual[i].nchannels);
-    EXPECT_DOUBLE_EQ(expected[i], actual[i].channels[0]);
-  }
+  ASSERT_EQ(1, actual.size());
+  const auto& block = actual[0];
+  ASSERT_EQ(1, block.get_nchannels());
+  ASSERT_EQ(expected.size(), block.get_nsamples());
+  for(auto i = 0u; i < expected.size(); ++i)
+    EXPECT_DOUBLE_EQ(expected[i], block.channel(0)[i]) << i;
 }
 
 int main(int argc, char **argv)
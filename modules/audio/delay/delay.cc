@@ -7,15 +7,21 @@
 //==========================================================================
 
 #include "../audio-module.h"
+#include "vg-dsp.h"
 
 namespace {
 
+const auto glide_time = 0.01;  // Smoothing time for delay changes, seconds
+
 //==========================================================================
 // Delay
 class Delay: public SimpleElement
 {
 private:
-  deque<AudioData> buffer;
+  AudioBlock held_input;  // Input held over a tick with no data
+  array<DSP::DelayLine, max_channels> lines;
+  DSP::Glide glide;
+  vector<double> delays;  // Per sample, in samples, reused each tick
 
   // Element virtuals
   void tick(const TickData& td) override;
@@ -30,9 +36,9 @@ public:
   using SimpleElement::SimpleElement;
 
   // Configuration
-  Input<AudioData> input{0.0};
+  Input<AudioBlock> input{0.0};
   Input<Number> time{0.0};
-  Output<AudioData> output;
+  Output<AudioBlock> output;
 };
 
 //--------------------------------------------------------------------------
@@ -43,30 +49,35 @@ void Delay::tick(const TickData& td)
 
   const auto nsamples = td.samples_in_tick(sample_rate);
 
-  sample_iterate(td, nsamples, {}, tie(input, time), tie(output),
-                 [&](const AudioData& i, Number t, AudioData& o)
+  const auto& in = get_audio_block(input, nsamples, held_input);
+  const auto nchannels = min<size_t>(in.get_nchannels(), max_channels);
+  const auto t = time.get_block(nsamples);
+
+  // Smooth the delay time so modulating it glides rather than clicks
+  glide.set_time(glide_time * sample_rate);
+  resize_buffer(delays, nsamples);
+  auto max_delay = 0.0;
+  for (auto i = 0u; i < nsamples; ++i)
   {
-    const auto bsamples = static_cast<size_t>(t * sample_rate);
-    if (bsamples > buffer.size())
-    {
-      buffer.insert(buffer.begin(), bsamples - buffer.size(),
-                    buffer.empty() ? 0 : buffer.front());
-    }
-    else if (bsamples < buffer.size())
-    {
-      buffer.resize(bsamples);
-    }
-    if (bsamples)
-    {
-      buffer.emplace_back(i);
-      o = buffer.front();
-      buffer.pop_front();
-    }
-    else
+    delays[i] = glide.next(max(t[i], 0.0) * sample_rate);
+    max_delay = max(max_delay, delays[i]);
+  }
+
+  auto out = output.get_buffer(td);
+  auto& o = get_audio_block(out, nchannels, nsamples);
+  const auto navail = min<size_t>(nsamples, in.get_nsamples());
+  for (auto c = 0u; c < nchannels; ++c)
+  {
+    auto& line = lines[c];
+    line.ensure(static_cast<size_t>(max_delay) + 1);
+    const auto ic = in.channel(c);
+    auto oc = o.channel(c);
+    for (auto i = 0u; i < nsamples; ++i)
     {
-      o = i;
+      line.write(i < navail ? ic[i] : 0.0);
+      oc[i] = line.read(delays[i]);
     }
-  });
+  }
 }
 
 Dataflow::SimpleModule module
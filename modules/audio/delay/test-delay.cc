@@ -0,0 +1,90 @@
+//==========================================================================
+// ViGraph dataflow module: audio/delay/test-delay.cc
+//
+// Tests for audio delay
+//
+// Copyright (c) 2019 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "../audio-module-test.h"
+
+class DelayTest: public GraphTester
+{
+public:
+  DelayTest()
+  {
+    loader.load("./vg-module-audio-delay.so");
+  }
+};
+
+TEST_F(DelayTest, TestZeroDelayPassesThrough)
+{
+  auto& delay = add("audio/delay");
+
+  const auto input = vector<sample_t>{ 0.1, 0.2, 0.3, 0.4, 0.5 };
+  auto& isrc = add_source(vector<AudioBlock>{input});
+  auto actual = vector<AudioBlock>{};
+  auto& sink = add_sink(actual, input.size());
+
+  isrc.connect("output", delay, "input");
+  delay.connect("output", sink, "input");
+
+  run();
+
+  ASSERT_EQ(1, actual.size());
+  const auto& block = actual[0];
+  ASSERT_EQ(1, block.get_nchannels());
+  ASSERT_EQ(input.size(), block.get_nsamples());
+  for(auto i = 0u; i < input.size(); ++i)
+    EXPECT_FLOAT_EQ(input[i], block.channel(0)[i]) << i;
+}
+
+TEST_F(DelayTest, TestImpulseIsDelayedAcrossTicks)
+{
+  auto& delay = add("audio/delay").set("time", 1.5);
+
+  auto input = vector<sample_t>(100);
+  input[10] = 1.0;
+  auto& isrc = add_source(vector<AudioBlock>{input, vector<sample_t>(100)});
+  auto actual = vector<AudioBlock>{};
+  auto& sink = add_sink(actual, input.size());
+
+  isrc.connect("output", delay, "input");
+  delay.connect("output", sink, "input");
+
+  run();
+  loader.engine.tick(Time::Duration{2.0});
+
+  ASSERT_EQ(2, actual.size());
+  for (auto i = 0u; i < 100; ++i)
+    EXPECT_EQ(0.0, actual[0].channel(0)[i]) << i;
+  for (auto i = 0u; i < 100; ++i)
+    EXPECT_FLOAT_EQ(i == 60 ? 1.0 : 0.0, actual[1].channel(0)[i]) << i;
+}
+
+TEST_F(DelayTest, TestFractionalDelayInterpolates)
+{
+  auto& delay = add("audio/delay").set("time", 0.025);
+
+  auto input = vector<sample_t>(100);
+  input[10] = 1.0;
+  auto& isrc = add_source(vector<AudioBlock>{input});
+  auto actual = vector<AudioBlock>{};
+  auto& sink = add_sink(actual, input.size());
+
+  isrc.connect("output", delay, "input");
+  delay.connect("output", sink, "input");
+
+  run();
+
+  ASSERT_EQ(1, actual.size());
+  const auto& block = actual[0];
+  EXPECT_FLOAT_EQ(0.5, block.channel(0)[12]);
+  EXPECT_FLOAT_EQ(0.5, block.channel(0)[13]);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
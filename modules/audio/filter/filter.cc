@@ -64,6 +64,8 @@ namespace {
 class Filter: public SimpleElement
 {
 private:
+  AudioBlock held_input;  // Input held over a tick with no data
+
   // Element virtuals
   void tick(const TickData& td) override;
 
@@ -73,18 +75,24 @@ private:
     return new Filter{module};
   }
 
-  vector<AudioData> buffer;
+  // Filter stages for each channel
+  array<vector<sample_t>, max_channels> stages;
+
+  // Per-sample coefficients, shared by all channels
+  vector<sample_t> cutoffs;
+  vector<sample_t> feedbacks;
+  vector<unsigned> steps;
 
 public:
   using SimpleElement::SimpleElement;
 
   // Configuration
   Input<Mode> mode{Mode::low_pass};
-  Input<AudioData> input{0.0};
+  Input<AudioBlock> input{0.0};
   Input<Number> cutoff{1.0};
   Input<Number> resonance{0.0};
   Input<Number> steepness{1.0};
-  Output<AudioData> output;
+  Output<AudioBlock> output;
 };
 
 //--------------------------------------------------------------------------
@@ -92,61 +100,72 @@ public:
 void Filter::tick(const TickData& td)
 {
   const auto nsamples = td.samples_in_tick(output.get_sample_rate());
-  sample_iterate(td, nsamples, {}, tie(input, mode, cutoff, resonance, steepness),
-                 tie(output),
-                 [&](const AudioData& input, Mode mode, Number cutoff,
-                     Number resonance, Number steepness, AudioData& o)
-  {
-    const auto stp = static_cast<unsigned>(max(1.0, steepness) + 1);
-    if (stp != buffer.size())
-      buffer.resize(stp);
-
-    cutoff = min(max(cutoff, 0.0), 1.0);
-    resonance = min(max(resonance, 0.0), 1.0);
-    const auto feedback = resonance +
-                          resonance / (1.0 - min(max(cutoff, 0.0), 0.9999));
 
-    for (auto b = 0u; b < buffer.size(); ++b)
+  const auto& in = get_audio_block(input, nsamples, held_input);
+  const auto nchannels = min<size_t>(in.get_nchannels(), max_channels);
+  const auto n = min<size_t>(nsamples, in.get_nsamples());
+
+  // Coefficients only recalculated when cutoff or resonance change, which
+  // for constant inputs is once per tick
+  auto last_cutoff = numeric_limits<Number>::quiet_NaN();
+  auto last_resonance = last_cutoff;
+  auto feedback = 0.0;
+
+  resize_buffer(cutoffs, nsamples);
+  resize_buffer(feedbacks, nsamples);
+  resize_buffer(steps, nsamples);
+  const auto cutoff_in = cutoff.get_block(nsamples);
+  const auto resonance_in = resonance.get_block(nsamples);
+  const auto steepness_in = steepness.get_block(nsamples);
+  for (auto i = 0u; i < nsamples; ++i)
+  {
+    const auto c = cutoff_in[i];
+    const auto r = resonance_in[i];
+    if (c != last_cutoff || r != last_resonance)
     {
-      for(auto c=0; c<input.nchannels; c++)
-      {
-        auto& bc = buffer[b].channels[c];
-
-        if (!b)
-          bc += cutoff * (input.channels[c] - bc +
-                          feedback * (bc - buffer[b + 1].channels[c]));
-        else
-          bc += cutoff * (buffer[b - 1].channels[c] - bc);
-      }
+      last_cutoff = c;
+      last_resonance = r;
+      const auto rc = min(max(r, 0.0), 1.0);
+      feedback = rc + rc / (1.0 - min(max(c, 0.0), 0.9999));
     }
+    feedbacks[i] = feedback;
+    cutoffs[i] = min(max(c, 0.0), 1.0);
+    steps[i] = static_cast<unsigned>(max(1.0, steepness_in[i]) + 1);
+  }
+  const auto modes = mode.get_block(nsamples);
 
-    switch (mode)
+  auto out = output.get_buffer(td);
+  auto& o = get_audio_block(out, nchannels, nsamples);
+  for (auto c = 0u; c < nchannels; ++c)
+  {
+    auto& st = stages[c];
+    const auto x = in.channel(c);
+    auto y = o.channel(c);
+    for (auto i = 0u; i < nsamples; ++i)
     {
-      case Mode::low_pass:
-        o.nchannels = input.nchannels;
-        o.channels = buffer.back().channels;
-        break;
+      if (steps[i] != st.size())
+        st.resize(steps[i]);
 
-      case Mode::high_pass:
-      {
-        o = input;
-        const auto& bb = buffer.back();
-        for(auto c=0; c<input.nchannels; c++)
-          o.channels[c] -= bb.channels[c];
-        break;
-      }
+      const auto k = cutoffs[i];
+      const auto xi = i < n ? x[i] : 0;
+      st[0] += k * (xi - st[0] + feedbacks[i] * (st[0] - st[1]));
+      for (auto b = 1u; b < st.size(); ++b)
+        st[b] += k * (st[b - 1] - st[b]);
 
-      case Mode::band_pass:
+      switch (modes[i])
       {
-        o.nchannels = input.nchannels;
-        const auto& bf = buffer.front();
-        const auto& bb = buffer.back();
-        for(auto c=0; c<input.nchannels; c++)
-          o.channels[c] = bf.channels[c] - bb.channels[c];
-        break;
+        case Mode::low_pass:
+          y[i] = st.back();
+          break;
+        case Mode::high_pass:
+          y[i] = xi - st.back();
+          break;
+        case Mode::band_pass:
+          y[i] = st.front() - st.back();
+          break;
       }
     }
-  });
+  }
 }
 
 Dataflow::SimpleModule module
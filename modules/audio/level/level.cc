@@ -15,6 +15,8 @@ namespace {
 class LevelFilter: public SimpleElement
 {
 private:
+  AudioBlock held_input;  // Input held over a tick with no data
+
   // Element virtuals
   void tick(const TickData& td) override;
 
@@ -28,9 +30,9 @@ public:
   using SimpleElement::SimpleElement;
 
   // Configuration
-  Input<AudioData> input{0.0};
+  Input<AudioBlock> input{0.0};
   Input<Number> gain{1.0};
-  Output<AudioData> output;
+  Output<AudioBlock> output;
 };
 
 //--------------------------------------------------------------------------
@@ -38,14 +40,19 @@ public:
 void LevelFilter::tick(const TickData& td)
 {
   const auto nsamples = td.samples_in_tick(output.get_sample_rate());
-  sample_iterate(td, nsamples, {}, tie(input, gain), tie(output),
-                 [&](const AudioData& input, Number gain,
-                     AudioData& o)
+  const auto& in = get_audio_block(input, nsamples, held_input);
+  const auto g = gain.get_block(nsamples);
+  const auto n = min<size_t>(nsamples, in.get_nsamples());
+
+  auto out = output.get_buffer(td);
+  auto& o = get_audio_block(out, in.get_nchannels(), nsamples);
+  for (auto c = 0u; c < in.get_nchannels(); ++c)
   {
-    o.nchannels = input.nchannels;
-    for(auto c=0; c<input.nchannels; c++)
-      o.channels[c] = input.channels[c] * gain;
-  });
+    const auto i = in.channel(c);
+    auto oc = o.channel(c);
+    for (auto j = 0u; j < n; ++j)
+      oc[j] = i[j] * g[j];
+  }
 }
 
 Dataflow::SimpleModule module
@@ -6,8 +6,7 @@
 // Copyright (c) 2019 Paul Clark.  All rights reserved
 //==========================================================================
 
-#include "../../module-test.h"
-#include "../audio-module.h"
+#include "../audio-module-test.h"
 
 class LevelTest: public GraphTester
 {
@@ -22,15 +21,15 @@ TEST_F(LevelTest, TestSetBothInputAndGain)
 {
   auto& level = add("audio/level");
 
-  const auto input = vector<AudioData>{ -1, -0.8, -0.6, -0.4, -0.2, 0,
-                                        0.2, 0.4, 0.6, 0.8, 1 };
+  const auto input = vector<sample_t>{ -1, -0.8, -0.6, -0.4, -0.2, 0,
+                                       0.2, 0.4, 0.6, 0.8, 1 };
   const auto gain = vector<Number>{ 1, 1, 1, 0.5, 0.5, 0.5,
                                     0, 0, 0, 0, 0 };
   const auto expected = vector<sample_t>{ -1, -0.8, -0.6, -0.2, -0.1, 0,
                                           0, 0, 0, 0, 0 };
-  auto& isrc = add_source(input);
+  auto& isrc = add_source(vector<AudioBlock>{input});
   auto& gsrc = add_source(gain);
-  auto actual = vector<AudioData>{};
+  auto actual = vector<AudioBlock>{};
   auto& sink = add_sink(actual, input.size());
 
   isrc.connect("output", level, "input");
@@ -39,14 +38,113 @@ TEST_F(LevelTest, TestSetBothInputAndGain)
 
   run();
 
-  EXPECT_EQ(expected.size(), actual.size());
-  for(auto i = 0u; i < actual.size(); ++i)
+  ASSERT_EQ(1, actual.size());
+  const auto& block = actual[0];
+  ASSERT_EQ(1, block.get_nchannels());
+  ASSERT_EQ(expected.size(), block.get_nsamples());
+  for(auto i = 0u; i < expected.size(); ++i)
+    EXPECT_DOUBLE_EQ(expected[i], block.channel(0)[i]) << i;
+}
+
+TEST_F(LevelTest, TestSteadyStateDoesNotReallocateBlocks)
+{
+  auto& level = add("audio/level").set("gain", 0.5);
+
+  const auto input = vector<sample_t>(100, 1.0);
+  auto& isrc = add_source(vector<AudioBlock>{input});
+  auto actual = vector<AudioBlock>{};
+  auto& sink = add_sink(actual, input.size());
+
+  isrc.connect("output", level, "input");
+  level.connect("output", sink, "input");
+
+  run();
+  const auto allocations = get_buffer_allocations();
+  loader.engine.tick(Time::Duration{2.0});
+  loader.engine.tick(Time::Duration{3.0});
+  EXPECT_EQ(allocations, get_buffer_allocations());
+
+  ASSERT_EQ(3, actual.size());
+  for (const auto& block: actual)
   {
-    EXPECT_EQ(1, actual[i].nchannels);
-    EXPECT_DOUBLE_EQ(expected[i], actual[i].channels[0]) << i;
+    ASSERT_EQ(1, block.get_nchannels());
+    ASSERT_EQ(input.size(), block.get_nsamples());
+    EXPECT_EQ(0.5, block.channel(0)[99]);
   }
 }
 
+TEST_F(LevelTest, TestUnconnectedInputGivesSilentChannel)
+{
+  auto& level = add("audio/level");
+  auto actual = vector<AudioBlock>{};
+  auto& sink = add_sink(actual, 10);
+  level.connect("output", sink, "input");
+
+  run();
+
+  ASSERT_EQ(1, actual.size());
+  const auto& block = actual[0];
+  ASSERT_EQ(1, block.get_nchannels());
+  ASSERT_EQ(10, block.get_nsamples());
+  for(auto i = 0u; i < 10; ++i)
+    EXPECT_EQ(0.0, block.channel(0)[i]) << i;
+}
+
+TEST_F(LevelTest, TestLastSampleHeldWhenNothingSent)
+{
+  auto& level = add("audio/level").set("gain", 0.5);
+  auto& isrc = add_source(vector<AudioBlock>{vector<sample_t>{0.2, 0.4, 0.6},
+                                             AudioBlock{}});
+  auto actual = vector<AudioBlock>{};
+  auto& sink = add_sink(actual, 3);
+  isrc.connect("output", level, "input");
+  level.connect("output", sink, "input");
+
+  run(2);
+
+  ASSERT_EQ(2, actual.size());
+  const auto& block = actual[1];
+  ASSERT_EQ(1, block.get_nchannels());
+  ASSERT_EQ(3, block.get_nsamples());
+  for(auto i = 0u; i < 3; ++i)
+    EXPECT_FLOAT_EQ(0.3, block.channel(0)[i]) << i;
+}
+
+TEST_F(LevelTest, TestInputValueFromJSONHeldAsConstant)
+{
+  auto json = JSON::Value{JSON::Value::OBJECT};
+  json.set("n", 2);
+  auto& jchans = json.put("c", JSON::Value::ARRAY);
+  jchans.add(0.5);
+  jchans.add(-0.25);
+  auto value = AudioBlock{};
+  set_from_json(value, json);
+
+  auto& level = add("audio/level").set("input", value);
+  auto actual = vector<AudioBlock>{};
+  auto& sink = add_sink(actual, 4);
+  level.connect("output", sink, "input");
+
+  run();
+
+  ASSERT_EQ(1, actual.size());
+  const auto& block = actual[0];
+  ASSERT_EQ(2, block.get_nchannels());
+  ASSERT_EQ(4, block.get_nsamples());
+  for(auto i = 0u; i < 4; ++i)
+  {
+    EXPECT_EQ(0.5, block.channel(0)[i]) << i;
+    EXPECT_EQ(-0.25, block.channel(1)[i]) << i;
+  }
+
+  // And back to the same JSON, from the last sample
+  const auto out = get_as_json(block);
+  EXPECT_EQ(2, out["n"].as_int());
+  ASSERT_EQ(2, out["c"].a.size());
+  EXPECT_EQ(0.5, out["c"][0].as_float());
+  EXPECT_EQ(-0.25, out["c"][1].as_float());
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
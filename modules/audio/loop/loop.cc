@@ -7,25 +7,62 @@
 //==========================================================================
 
 #include "../audio-module.h"
+#if !defined(PLATFORM_WINDOWS) && !defined(PLATFORM_WEB)
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/mman.h>
+#define LOOP_CAN_SPILL
+#endif
 
 namespace {
 
+const auto default_max_length = 30.0;  // Seconds
+const auto default_channels = 2;
+const auto nslots = 3;  // Recording, recorded, playing - always one free
+
 //==========================================================================
 // Loop
+// Recordings live in preallocated slots which are handed between recording,
+// recorded and playing by index, so nothing is copied at loop transitions
 class Loop: public SimpleElement
 {
 private:
+  AudioBlock held_input;  // Input held over a tick with no data
+
+  struct Slot
+  {
+    float *data = nullptr;   // Interleaved, frame_capacity frames
+    size_t length = 0;       // Frames
+    unsigned nchannels = 0;  // Channels actually recorded
+  };
+
+  array<Slot, nslots> slots;
+  size_t frame_capacity = 0;
+  unsigned channel_capacity = 0;
+  bool allocated_spill = false;  // Spill setting slots were allocated for
+  unique_ptr<float[]> memory;  // Backing if not spilled - uninitialised
+  void *map = nullptr;       // Backing if spilled
+  size_t map_size = 0;
+
+  unsigned recording_slot = 0;
+  unsigned recorded_slot = 1;
+  unsigned play_slot = 1;
   bool recording = false;
   bool playing = false;
   bool recorded_ready = false;
-  vector<AudioData> recording_buffer;
-  vector<AudioData> recorded_buffer;
-  vector<AudioData> play_buffer;
   uint64_t play_pos = 0;
 
   // Element virtuals
+  void setup(const SetupContext& context) override;
   void tick(const TickData& td) override;
 
+  // Internal
+  void allocate(size_t frames, unsigned channels, bool spill);
+  void release();
+  void start_recording();
+  void stop_recording();
+  void start_playing();
+
   // Clone
   Loop *create_clone() const override
   {
@@ -36,14 +73,153 @@ public:
   using SimpleElement::SimpleElement;
 
   // Configuration
-  Input<AudioData> input{0.0};
+  Setting<Number> max_length{default_max_length};
+  Setting<Integer> channels{default_channels};
+  Setting<bool> spill{false};
+  Input<AudioBlock> input{0.0};
   Input<Trigger> play_start{0};
   Input<Trigger> play_stop{0};
   Input<Trigger> record_start{0};
   Input<Trigger> record_stop{0};
-  Output<AudioData> output;
+  Output<AudioBlock> output;
+
+  ~Loop() { release(); }
 };
 
+//--------------------------------------------------------------------------
+// Setup
+void Loop::setup(const SetupContext& context)
+{
+  SimpleElement::setup(context);
+
+  const auto frames = static_cast<size_t>(max(max_length.get(), 0.0)
+                                          * output.get_sample_rate());
+  const auto nchannels = static_cast<unsigned>(
+                            min<Integer>(max<Integer>(channels, 1),
+                                         max_channels));
+  if (frames != frame_capacity || nchannels != channel_capacity
+      || spill != allocated_spill)
+    allocate(frames, nchannels, spill);
+}
+
+//--------------------------------------------------------------------------
+// Allocate slots, in memory or spilled to a temporary file, losing any
+// existing recordings
+void Loop::allocate(size_t frames, unsigned nchannels, bool to_file)
+{
+  release();
+
+  const auto per_slot = frames * nchannels;
+  const auto total = per_slot * nslots;
+  auto base = static_cast<float *>(nullptr);
+
+#if defined(LOOP_CAN_SPILL)
+  if (to_file && total)
+  {
+    // Unlinked temporary file, so the OS can page recordings out to disk
+    // rather than swap, and it vanishes when we do
+    char path[] = "/tmp/vg-loop-XXXXXX";
+    const auto fd = mkstemp(path);
+    if (fd >= 0)
+    {
+      unlink(path);
+      map_size = total * sizeof(float);
+      if (!ftruncate(fd, map_size))
+      {
+        map = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   fd, 0);
+        if (map == MAP_FAILED) map = nullptr;
+      }
+      close(fd);
+    }
+
+    if (map)
+      base = static_cast<float *>(map);
+    else
+    {
+      Log::Error log;
+      log << "Can't spill loop '" << get_id()
+          << "' to a temporary file - keeping it in memory\n";
+      map_size = 0;
+    }
+  }
+#else
+  if (to_file)
+  {
+    Log::Error log;
+    log << "Loop '" << get_id() << "' can't spill on this platform\n";
+  }
+#endif
+
+  // Left uninitialised, so pages are only committed as they are recorded
+  // into - nothing is read before it has been recorded
+  if (!base && total)
+  {
+    memory.reset(new float[total]);
+    base = memory.get();
+  }
+
+  for (auto i = 0u; i < nslots; ++i)
+    slots[i] = Slot{base + i * per_slot, 0, 0};
+  frame_capacity = frames;
+  channel_capacity = nchannels;
+  recording_slot = 0;
+  recorded_slot = play_slot = 1;
+  recording = playing = recorded_ready = false;
+  play_pos = 0;
+  allocated_spill = to_file;
+}
+
+//--------------------------------------------------------------------------
+// Release the slots
+void Loop::release()
+{
+#if defined(LOOP_CAN_SPILL)
+  if (map) munmap(map, map_size);
+#endif
+  map = nullptr;
+  map_size = 0;
+  memory.reset();
+  slots = {};
+  frame_capacity = 0;
+  channel_capacity = 0;
+}
+
+//--------------------------------------------------------------------------
+// Start recording into the free slot
+void Loop::start_recording()
+{
+  recording = true;
+  slots[recording_slot].length = 0;
+  slots[recording_slot].nchannels = 0;
+}
+
+//--------------------------------------------------------------------------
+// Stop recording - what we recorded becomes ready to play, and we take
+// whichever slot is neither recorded nor playing for next time
+void Loop::stop_recording()
+{
+  if (recording)
+  {
+    recorded_slot = recording_slot;
+    for (auto i = 0u; i < nslots; ++i)
+      if (i != recorded_slot && i != play_slot)
+        recording_slot = i;
+  }
+  recording = false;
+  recorded_ready = true;
+}
+
+//--------------------------------------------------------------------------
+// Start playing the latest recording
+void Loop::start_playing()
+{
+  playing = true;
+  play_slot = recorded_slot;
+  recorded_ready = false;
+  play_pos = 0;
+}
+
 //--------------------------------------------------------------------------
 // Tick data
 void Loop::tick(const TickData& td)
@@ -52,91 +228,77 @@ void Loop::tick(const TickData& td)
 
   const auto nsamples = td.samples_in_tick(sample_rate);
 
-  sample_iterate(td, nsamples, {}, tie(input, play_start, play_stop,
-                                   record_start, record_stop), tie(output),
-                 [&](const AudioData& i, Trigger pb, Trigger pe,
-                     Trigger rb, Trigger re,
-                     AudioData& o)
+  const auto& in = get_audio_block(input, nsamples, held_input);
+  const auto in_channels = min<size_t>(in.get_nchannels(), max_channels);
+
+  // Output as many channels as are playing or passing through
+  auto out = output.get_buffer(td);
+  auto& o = get_audio_block(out, max_channels, nsamples);
+  auto out_channels = 0u;
+  auto i = 0u;
+
+  sample_iterate(td, nsamples, {}, tie(play_start, play_stop,
+                                   record_start, record_stop), {},
+                 [&](Trigger pb, Trigger pe, Trigger rb, Trigger re)
   {
     if (recording)
     {
-      if (re)
-      {
-        recording = false;
-        recorded_buffer = recording_buffer;
-        recorded_ready = true;
-      }
-      if (rb)
-      {
-        recording = true;
-        recording_buffer.clear();
-      }
+      if (re) stop_recording();
+      if (rb) start_recording();
     }
     else
     {
-      if (rb)
-      {
-        recording = true;
-        recording_buffer.clear();
-      }
-      if (re)
-      {
-        recording = false;
-        recorded_buffer = recording_buffer;
-        recorded_ready = true;
-      }
+      if (rb) start_recording();
+      if (re) stop_recording();
     }
 
     if (playing)
     {
-      if (pe)
-      {
-        playing = false;
-      }
-      if (pb)
-      {
-        playing = true;
-        play_buffer = recorded_buffer;
-        recorded_ready = false;
-        play_pos = 0;
-      }
+      if (pe) playing = false;
+      if (pb) start_playing();
     }
     else
     {
-      if (pb)
-      {
-        playing = true;
-        play_buffer = recorded_buffer;
-        recorded_ready = false;
-        play_pos = 0;
-      }
-      if (pe)
-      {
-        playing = false;
-      }
+      if (pb) start_playing();
+      if (pe) playing = false;
     }
 
     if (recording)
-      recording_buffer.push_back(i);
+    {
+      // Stop growing once full
+      auto& slot = slots[recording_slot];
+      if (slot.length < frame_capacity)
+      {
+        auto frame = slot.data + slot.length++ * channel_capacity;
+        const auto nc = min<unsigned>(in_channels, channel_capacity);
+        for (auto c = 0u; c < nc; ++c)
+          frame[c] = in.get(c, i);
+        fill(frame + nc, frame + channel_capacity, 0.0f);
+        slot.nchannels = max(slot.nchannels, nc);
+      }
+    }
 
-    if (playing)
+    const auto& slot = slots[play_slot];
+    if (playing && play_pos < slot.length)
     {
-      o = play_buffer[play_pos++];
-      if (play_pos > play_buffer.size())
+      const auto frame = slot.data + play_pos++ * channel_capacity;
+      for (auto c = 0u; c < slot.nchannels; ++c)
+        o.channel(c)[i] = frame[c];
+      out_channels = max(out_channels, slot.nchannels);
+      if (play_pos >= slot.length)
       {
         if (recorded_ready)
         {
-          play_buffer = recorded_buffer;
+          play_slot = recorded_slot;
           recorded_ready = false;
         }
         play_pos = 0;
       }
     }
-    else
-    {
-      o = AudioData();
-    }
+    ++i;
   });
+
+  o.resize(out_channels, nsamples);
 }
 
 Dataflow::SimpleModule module
@@ -144,7 +306,11 @@ Dataflow::SimpleModule module
   "loop",
   "Loop",
   "audio",
-  {},
+  {
+    { "max-length",   &Loop::max_length },
+    { "channels",     &Loop::channels },
+    { "spill",        &Loop::spill },
+  },
   {
     { "input",        &Loop::input },
     { "play-start",   &Loop::play_start },
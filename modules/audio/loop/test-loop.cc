@@ -0,0 +1,93 @@
+//==========================================================================
+// ViGraph dataflow module: audio/loop/test-loop.cc
+//
+// Tests for audio loop recorder
+//
+// Copyright (c) 2019 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "../audio-module-test.h"
+
+class LoopTest: public GraphTester
+{
+public:
+  LoopTest()
+  {
+    loader.load("./vg-module-audio-loop.so");
+  }
+
+  // Record the first 5 samples of 1..20 and play from the 6th
+  vector<AudioBlock> record_and_play(GraphElement& loop)
+  {
+    auto input = vector<sample_t>(20);
+    for (auto i = 0u; i < input.size(); ++i)
+      input[i] = i + 1;
+    auto record_start = vector<Trigger>(20);
+    auto record_stop = vector<Trigger>(20);
+    auto play_start = vector<Trigger>(20);
+    record_start[0] = 1;
+    record_stop[5] = 1;
+    play_start[5] = 1;
+
+    auto& isrc = add_source(vector<AudioBlock>{input});
+    auto& rbsrc = add_source(record_start);
+    auto& resrc = add_source(record_stop);
+    auto& pbsrc = add_source(play_start);
+    auto actual = vector<AudioBlock>{};
+    auto& sink = add_sink(actual, input.size());
+
+    isrc.connect("output", loop, "input");
+    rbsrc.connect("output", loop, "record-start");
+    resrc.connect("output", loop, "record-stop");
+    pbsrc.connect("output", loop, "play-start");
+    loop.connect("output", sink, "input");
+
+    run();
+    return actual;
+  }
+};
+
+TEST_F(LoopTest, TestRecordAndPlayLoops)
+{
+  auto& loop = add("audio/loop");
+  const auto actual = record_and_play(loop);
+
+  ASSERT_EQ(1, actual.size());
+  const auto& block = actual[0];
+  ASSERT_EQ(1, block.get_nchannels());
+  ASSERT_EQ(20, block.get_nsamples());
+  for (auto i = 0u; i < 5; ++i)
+    EXPECT_EQ(0.0, block.channel(0)[i]) << i;
+  for (auto i = 5u; i < 20; ++i)
+    EXPECT_EQ((i - 5) % 5 + 1, block.channel(0)[i]) << i;
+}
+
+TEST_F(LoopTest, TestMaxLengthLimitsLoop)
+{
+  auto& loop = add("audio/loop").set("max-length", 0.15);
+  const auto actual = record_and_play(loop);
+
+  ASSERT_EQ(1, actual.size());
+  const auto& block = actual[0];
+  ASSERT_EQ(20, block.get_nsamples());
+  for (auto i = 5u; i < 20; ++i)
+    EXPECT_EQ((i - 5) % 3 + 1, block.channel(0)[i]) << i;
+}
+
+TEST_F(LoopTest, TestSpillToFile)
+{
+  auto& loop = add("audio/loop").set("spill", true);
+  const auto actual = record_and_play(loop);
+
+  ASSERT_EQ(1, actual.size());
+  const auto& block = actual[0];
+  ASSERT_EQ(20, block.get_nsamples());
+  for (auto i = 5u; i < 20; ++i)
+    EXPECT_EQ((i - 5) % 5 + 1, block.channel(0)[i]) << i;
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -17,7 +17,12 @@ namespace {
 class OscillatorSource: public SimpleElement
 {
 private:
-  Number theta = 0.0;
+  Waveform::Oscillator oscillator;
+
+  // Frequency only recalculated when the control voltage or sample rate
+  // changes
+  Number last_cv = numeric_limits<Number>::quiet_NaN();
+  double last_sample_rate = 0.0;
   enum State
   {
     disabled,
@@ -49,7 +54,7 @@ public:
   Input<Trigger> stop{0};     // Trigger to stop
 
   // Output
-  Output<AudioData> output;
+  Output<AudioBlock> output;
 };
 
 //--------------------------------------------------------------------------
@@ -58,13 +63,23 @@ void OscillatorSource::tick(const TickData& td)
 {
   const auto sample_rate = output.get_sample_rate();
   const auto nsamples = td.samples_in_tick(sample_rate);
+
+  if (sample_rate != last_sample_rate)
+  {
+    last_sample_rate = sample_rate;
+    last_cv = numeric_limits<Number>::quiet_NaN();
+  }
+
+  auto out = output.get_buffer(td);
+  auto& block = get_audio_block(out, 1, nsamples);
+  auto o = block.channel(0);
+
   sample_iterate(td, nsamples, {},
                  tie(waveform, note, octave, detune, pulse_width, start, stop),
-                 tie(output),
+                 {},
                  [&](Waveform::Type waveform, Number note, Number octave,
                      Number detune, Number pulse_width,
-                     Trigger _start, Trigger _stop,
-                     AudioData& output)
+                     Trigger _start, Trigger _stop)
   {
     if (_stop)
     {
@@ -76,33 +91,29 @@ void OscillatorSource::tick(const TickData& td)
       if (state == State::disabled)
       {
         state = State::enabled;
-        theta = 0.0;
+        oscillator.set_phase(0.0);
       }
     }
 
-    output.nchannels = 1;
-
     switch (state)
     {
       case State::enabled:
       case State::completing:
       {
-        output.channels[0] =
-          Waveform::get_value(waveform, pulse_width, theta-floor(theta));
-        auto cv = note + octave + detune/12;
-        auto freq = Music::cv_to_frequency(cv);
-        theta += freq / sample_rate;
-        if (theta >= 1)
+        const auto cv = note + octave + detune/12;
+        if (cv != last_cv)
         {
-          theta -= floor(theta); // Wrap to 0..1
-          if (state == State::completing)
-            state = State::disabled;
+          oscillator.set_increment(Music::cv_to_frequency(cv) / sample_rate);
+          last_cv = cv;
         }
+        *o++ = oscillator.get_value(waveform, pulse_width);
+        if (oscillator.advance() && state == State::completing)
+          state = State::disabled;
         break;
       }
 
       case State::disabled:
-        output.channels[0] = 0;
+        *o++ = 0;
         break;
     }
   });
@@ -6,8 +6,7 @@
 // Copyright (c) 2017 Paul Clark.  All rights reserved
 //==========================================================================
 
-#include "../../module-test.h"
-#include "../audio-module.h"
+#include "../audio-module-test.h"
 #include "vg-waveform.h"
 #include <cmath>
 
@@ -26,48 +25,56 @@ const auto waveform_size = 44100;
 TEST_F(OscillatorTest, TestNoWaveform)
 {
   auto& osc = add("audio/oscillator");
-  auto waveform = vector<AudioData>{};
-  auto& snk = add_sink(waveform, waveform_size);
+  auto blocks = vector<AudioBlock>{};
+  auto& snk = add_sink(blocks, waveform_size);
   osc.connect("output", snk, "input");
 
   run();
 
   // Should be 44100 samples at 0
-  EXPECT_EQ(waveform_size, waveform.size());
-  for(auto i=0u; i<waveform.size(); i++)
-  {
-    EXPECT_EQ(1, waveform[i].nchannels);
-    EXPECT_EQ(0.0, waveform[i].channels[0]);
-  }
+  ASSERT_EQ(1, blocks.size());
+  const auto& block = blocks[0];
+  ASSERT_EQ(1, block.get_nchannels());
+  EXPECT_EQ(waveform_size, block.get_nsamples());
+  const auto waveform = block.channel(0);
+  for(auto i=0u; i<block.get_nsamples(); i++)
+    EXPECT_EQ(0.0, waveform[i]);
 }
 
 TEST_F(OscillatorTest, TestDefaultSquareWaveFrequency)
 {
   auto& osc = add("audio/oscillator")
              .set("wave", Waveform::Type::square);
-  auto waveform = vector<AudioData>{};
-  auto& snk = add_sink(waveform, waveform_size);
+  auto blocks = vector<AudioBlock>{};
+  auto& snk = add_sink(blocks, waveform_size);
   osc.connect("output", snk, "input");
 
   run();
 
   // Should be 44100 samples with 262 rising edges
-  EXPECT_EQ(waveform_size, waveform.size());
+  ASSERT_EQ(1, blocks.size());
+  const auto& block = blocks[0];
+  ASSERT_EQ(1, block.get_nchannels());
+  EXPECT_EQ(waveform_size, block.get_nsamples());
+  const auto waveform = block.channel(0);
   auto last = 0.0;
   auto rising = 0;
+  auto corrected = 0;
   auto high = 0;
-  for(auto i=0u; i<waveform.size(); i++)
+  for(auto i=0u; i<block.get_nsamples(); i++)
   {
-    EXPECT_EQ(1, waveform[i].nchannels);
-    auto v = waveform[i].channels[0];
+    auto v = waveform[i];
     if (last < 0 && v >= 0) rising++;
     if (v >= 0) high++;
     last = v;
 
-    EXPECT_TRUE(v==-1.0 || v==1.0);
+    // Only the samples either side of an edge are band-limited
+    EXPECT_GE(1.0, fabs(v));
+    if (v != -1.0 && v != 1.0) corrected++;
   }
 
   EXPECT_NEAR(262, rising, 1);
+  EXPECT_GE(4 * (rising + 1), corrected);
   EXPECT_NEAR(22050, high, 50);  // Roughly half the time
 }
 
@@ -75,20 +82,23 @@ TEST_F(OscillatorTest, TestDefaultSinWaveFrequency)
 {
   auto& osc = add("audio/oscillator")
              .set("wave", Waveform::Type::sin);
-  auto waveform = vector<AudioData>{};
-  auto& snk = add_sink(waveform, waveform_size);
+  auto blocks = vector<AudioBlock>{};
+  auto& snk = add_sink(blocks, waveform_size);
   osc.connect("output", snk, "input");
 
   run();
 
   // Should be 44100 samples with 262 rising edges
-  EXPECT_EQ(waveform_size, waveform.size());
+  ASSERT_EQ(1, blocks.size());
+  const auto& block = blocks[0];
+  ASSERT_EQ(1, block.get_nchannels());
+  EXPECT_EQ(waveform_size, block.get_nsamples());
+  const auto waveform = block.channel(0);
   auto last = 0.0;
   auto rising = 0;
-  for(auto i=0u; i<waveform.size(); i++)
+  for(auto i=0u; i<block.get_nsamples(); i++)
   {
-    EXPECT_EQ(1, waveform[i].nchannels);
-    auto v = waveform[i].channels[0];
+    auto v = waveform[i];
     if (last < 0 && v >= 0) rising++;
     last = v;
 
@@ -104,27 +114,34 @@ TEST_F(OscillatorTest, TestA440SquareWaveFrequency)
   auto& osc = add("audio/oscillator")
              .set("wave", Waveform::Type::square)
              .set("note", 0.75);
-  auto waveform = vector<AudioData>{};
-  auto& snk = add_sink(waveform, waveform_size);
+  auto blocks = vector<AudioBlock>{};
+  auto& snk = add_sink(blocks, waveform_size);
   osc.connect("output", snk, "input");
 
   run();
 
   // Should be 44100 samples with 439 rising edges
-  EXPECT_EQ(waveform_size, waveform.size());
+  ASSERT_EQ(1, blocks.size());
+  const auto& block = blocks[0];
+  ASSERT_EQ(1, block.get_nchannels());
+  EXPECT_EQ(waveform_size, block.get_nsamples());
+  const auto waveform = block.channel(0);
   auto last = 0.0;
   auto rising = 0;
-  for(auto i=0u; i<waveform.size(); i++)
+  auto corrected = 0;
+  for(auto i=0u; i<block.get_nsamples(); i++)
   {
-    EXPECT_EQ(1, waveform[i].nchannels);
-    auto v = waveform[i].channels[0];
+    auto v = waveform[i];
     if (last < 0 && v >= 0) rising++;
     last = v;
 
-    EXPECT_TRUE(v==-1.0 || v==1.0);
+    // Only the samples either side of an edge are band-limited
+    EXPECT_GE(1.0, fabs(v));
+    if (v != -1.0 && v != 1.0) corrected++;
   }
 
   EXPECT_NEAR(440, rising, 1);
+  EXPECT_GE(4 * (rising + 1), corrected);
 }
 
 TEST_F(OscillatorTest, TestUpAnOctaveSquareWaveFrequency)
@@ -132,27 +149,34 @@ TEST_F(OscillatorTest, TestUpAnOctaveSquareWaveFrequency)
   auto& osc = add("audio/oscillator")
              .set("wave", Waveform::Type::square)
              .set("octave", 1.0);
-  auto waveform = vector<AudioData>{};
-  auto& snk = add_sink(waveform, waveform_size);
+  auto blocks = vector<AudioBlock>{};
+  auto& snk = add_sink(blocks, waveform_size);
   osc.connect("output", snk, "input");
 
   run();
 
   // Should be 44100 samples with 523 rising edges
-  EXPECT_EQ(waveform_size, waveform.size());
+  ASSERT_EQ(1, blocks.size());
+  const auto& block = blocks[0];
+  ASSERT_EQ(1, block.get_nchannels());
+  EXPECT_EQ(waveform_size, block.get_nsamples());
+  const auto waveform = block.channel(0);
   auto last = 0.0;
   auto rising = 0;
-  for(auto i=0u; i<waveform.size(); i++)
+  auto corrected = 0;
+  for(auto i=0u; i<block.get_nsamples(); i++)
   {
-    EXPECT_EQ(1, waveform[i].nchannels);
-    auto v = waveform[i].channels[0];
+    auto v = waveform[i];
     if (last < 0 && v >= 0) rising++;
     last = v;
 
-    EXPECT_TRUE(v==-1.0 || v==1.0);
+    // Only the samples either side of an edge are band-limited
+    EXPECT_GE(1.0, fabs(v));
+    if (v != -1.0 && v != 1.0) corrected++;
   }
 
   EXPECT_NEAR(523, rising, 1);
+  EXPECT_GE(4 * (rising + 1), corrected);
 }
 
 TEST_F(OscillatorTest, TestDetunedSquareWaveFrequency)
@@ -160,27 +184,34 @@ TEST_F(OscillatorTest, TestDetunedSquareWaveFrequency)
   auto& osc = add("audio/oscillator")
              .set("wave", Waveform::Type::square)
              .set("detune", 12.0);
-  auto waveform = vector<AudioData>{};
-  auto& snk = add_sink(waveform, waveform_size);
+  auto blocks = vector<AudioBlock>{};
+  auto& snk = add_sink(blocks, waveform_size);
   osc.connect("output", snk, "input");
 
   run();
 
   // Should be 44100 samples with 523 rising edges
-  EXPECT_EQ(waveform_size, waveform.size());
+  ASSERT_EQ(1, blocks.size());
+  const auto& block = blocks[0];
+  ASSERT_EQ(1, block.get_nchannels());
+  EXPECT_EQ(waveform_size, block.get_nsamples());
+  const auto waveform = block.channel(0);
   auto last = 0.0;
   auto rising = 0;
-  for(auto i=0u; i<waveform.size(); i++)
+  auto corrected = 0;
+  for(auto i=0u; i<block.get_nsamples(); i++)
   {
-    EXPECT_EQ(1, waveform[i].nchannels);
-    auto v = waveform[i].channels[0];
+    auto v = waveform[i];
     if (last < 0 && v >= 0) rising++;
     last = v;
 
-    EXPECT_TRUE(v==-1.0 || v==1.0);
+    // Only the samples either side of an edge are band-limited
+    EXPECT_GE(1.0, fabs(v));
+    if (v != -1.0 && v != 1.0) corrected++;
   }
 
   EXPECT_NEAR(523, rising, 1);
+  EXPECT_GE(4 * (rising + 1), corrected);
 }
 
 TEST_F(OscillatorTest, Test25PercentPulseWidthSquareWave)
@@ -188,29 +219,36 @@ TEST_F(OscillatorTest, Test25PercentPulseWidthSquareWave)
   auto& osc = add("audio/oscillator")
              .set("wave", Waveform::Type::square)
              .set("pulse-width", 0.25);
-  auto waveform = vector<AudioData>{};
-  auto& snk = add_sink(waveform, waveform_size);
+  auto blocks = vector<AudioBlock>{};
+  auto& snk = add_sink(blocks, waveform_size);
   osc.connect("output", snk, "input");
 
   run();
 
   // Should be 44100 samples with 262 rising edges
-  EXPECT_EQ(waveform_size, waveform.size());
+  ASSERT_EQ(1, blocks.size());
+  const auto& block = blocks[0];
+  ASSERT_EQ(1, block.get_nchannels());
+  EXPECT_EQ(waveform_size, block.get_nsamples());
+  const auto waveform = block.channel(0);
   auto last = 0.0;
   auto rising = 0;
+  auto corrected = 0;
   auto high = 0;
-  for(auto i=0u; i<waveform.size(); i++)
+  for(auto i=0u; i<block.get_nsamples(); i++)
   {
-    EXPECT_EQ(1, waveform[i].nchannels);
-    auto v = waveform[i].channels[0];
+    auto v = waveform[i];
     if (last < 0 && v >= 0) rising++;
     if (v >= 0) high++;
     last = v;
 
-    EXPECT_TRUE(v==-1.0 || v==1.0);
+    // Only the samples either side of an edge are band-limited
+    EXPECT_GE(1.0, fabs(v));
+    if (v != -1.0 && v != 1.0) corrected++;
   }
 
   EXPECT_NEAR(262, rising, 1);
+  EXPECT_GE(4 * (rising + 1), corrected);
   EXPECT_NEAR(11025, high, 50);  // Roughly quarter the time
 }
 
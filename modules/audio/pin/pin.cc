@@ -10,7 +10,7 @@
 
 namespace {
 
-class AudioPin: public Pin<AudioData>
+class AudioPin: public Pin<AudioBlock>
 {
 private:
   // Clone
@@ -7,6 +7,7 @@
 //==========================================================================
 
 #include "../audio-module.h"
+#include "vg-dsp.h"
 #if defined(PLATFORM_WINDOWS)
 #include "SoundTouchDLL.h"
 #else
@@ -19,21 +20,138 @@ namespace {
 using namespace soundtouch;
 #endif
 
+//--------------------------------------------------------------------------
+// Pitch shift backend - SoundTouch is the default, since the native one
+// has no WSOLA-style alignment of its windows and so is rougher
+enum class Backend
+{
+  soundtouch,
+  native
+};
+
+//--------------------------------------------------------------------------
+// Native backend quality - trades latency against smoothness
+enum class Quality
+{
+  low_latency,
+  normal,
+  high
+};
+
+}
+
+namespace ViGraph { namespace Dataflow {
+
+template<> inline
+string get_module_type<Backend>() { return "pitch-shift-backend"; }
+
+template<> inline void set_from_json(Backend& backend,
+                                     const JSON::Value& json)
+{
+  const auto& b = json.as_str();
+
+  if (b == "native")
+    backend = Backend::native;
+  else
+    backend = Backend::soundtouch;
+}
+
+template<> inline JSON::Value get_as_json(const Backend& backend)
+{
+  switch (backend)
+  {
+    case Backend::soundtouch:
+      return "soundtouch";
+    case Backend::native:
+      return "native";
+  }
+  return {};
+}
+
+template<> inline
+string get_module_type<Quality>() { return "pitch-shift-quality"; }
+
+template<> inline void set_from_json(Quality& quality,
+                                     const JSON::Value& json)
+{
+  const auto& q = json.as_str();
+
+  if (q == "low-latency")
+    quality = Quality::low_latency;
+  else if (q == "high")
+    quality = Quality::high;
+  else
+    quality = Quality::normal;
+}
+
+template<> inline JSON::Value get_as_json(const Quality& quality)
+{
+  switch (quality)
+  {
+    case Quality::low_latency:
+      return "low-latency";
+    case Quality::normal:
+      return "normal";
+    case Quality::high:
+      return "high";
+  }
+  return {};
+}
+
+}} // namespaces
+
+namespace {
+
+//--------------------------------------------------------------------------
+// Native window length for each quality, seconds
+double get_window_time(Quality quality)
+{
+  switch (quality)
+  {
+    case Quality::low_latency: return 0.02;
+    case Quality::normal:      return 0.05;
+    case Quality::high:        return 0.1;
+  }
+  return 0.05;
+}
+
 //==========================================================================
 // Pitch Shift
 class PitchShift: public SimpleElement
 {
 private:
+  AudioBlock held_input;  // Input held over a tick with no data
+
+  // Native backend
+  DSP::PitchShifter shifter;
+  double shifter_sample_rate = 0.0;
+  unsigned shifter_channels = 0;
+  Quality shifter_quality = Quality::normal;
+  vector<double> ratios;        // Per sample, reused each tick
+  Number last_pitch = 0.0;
+  double last_ratio = 1.0;
+
+  // SoundTouch backend
 #if defined(PLATFORM_WINDOWS)
   unique_ptr<remove_pointer<HANDLE>::type,
              decltype(&soundtouch_destroyInstance)> sound_touch;
 #else
   SoundTouch sound_touch;
 #endif
+  double sound_touch_sample_rate = 0.0;
+  unsigned sound_touch_channels = 0;
+  Number sound_touch_pitch = 0.0;
+  vector<float> interleaved;    // Reused each tick
 
   // Element virtuals
   void tick(const TickData& td) override;
 
+  // Internal
+  void tick_native(const AudioBlock& in, AudioBlock& o,
+                   double sample_rate);
+  void tick_soundtouch(const AudioBlock& in, AudioBlock& o,
+                       double sample_rate);
+
   // Clone
   PitchShift *create_clone() const override
   {
@@ -44,9 +162,11 @@ public:
   PitchShift(const SimpleModule& module);
 
   // Configuration
-  Input<AudioData> input{0.0};
+  Setting<Backend> backend{Backend::soundtouch};
+  Setting<Quality> quality{Quality::normal};
+  Input<AudioBlock> input{0.0};
   Input<Number> pitch{0.0};
-  Output<AudioData> output;
+  Output<AudioBlock> output;
 };
 
 //--------------------------------------------------------------------------
@@ -64,75 +184,129 @@ PitchShift::PitchShift(const SimpleModule& module):
 void PitchShift::tick(const TickData& td)
 {
   const auto sample_rate = output.get_sample_rate();
-#if defined(PLATFORM_WINDOWS)
-  soundtouch_setSampleRate(sound_touch.get(), sample_rate);
-#else
-  sound_touch.setSampleRate(sample_rate);
-#endif
-
   const auto nsamples = td.samples_in_tick(sample_rate);
 
-  auto f = vector<float>{};
-  auto nchannels = 0u;
-  sample_iterate(td, nsamples, {}, tie(input), {},
-                 [&](const AudioData& input)
+  const auto& in = get_audio_block(input, nsamples, held_input);
+  const auto nchannels = min<size_t>(in.get_nchannels(), max_channels);
+  auto out = output.get_buffer(td);
+  auto& o = get_audio_block(out, nchannels, nsamples);
+  if (!nchannels) return;
+
+  switch (backend.get())
   {
-    if (!nchannels)
+    case Backend::soundtouch:
+      tick_soundtouch(in, o, sample_rate);
+      break;
+
+    case Backend::native:
+      tick_native(in, o, sample_rate);
+      break;
+  }
+}
+
+//--------------------------------------------------------------------------
+// Native backend - straight from the input channels to the output
+void PitchShift::tick_native(const AudioBlock& in, AudioBlock& o,
+                             double sample_rate)
+{
+  const auto nchannels = o.get_nchannels();
+  if (sample_rate != shifter_sample_rate || nchannels > shifter_channels
+      || quality != shifter_quality)
+  {
+    shifter.setup(get_window_time(quality) * sample_rate, nchannels);
+    shifter_sample_rate = sample_rate;
+    shifter_channels = max(shifter_channels, nchannels);
+    shifter_quality = quality;
+  }
+
+  // Anything the input is short of stays silent
+  const auto n = min<size_t>(o.get_nsamples(), in.get_nsamples());
+  const auto p = pitch.get_block(n);
+  resize_buffer(ratios, n);
+  for (auto i = 0u; i < n; ++i)
+  {
+    if (p[i] != last_pitch)
     {
-      nchannels = input.nchannels;
-      f.reserve(nsamples * nchannels);
+      last_pitch = p[i];
+      last_ratio = pow(2.0, last_pitch / 12.0);
+    }
+    ratios[i] = last_ratio;
+  }
+
+  array<const float *, max_channels> from;
+  array<float *, max_channels> to;
+  for (auto c = 0u; c < nchannels; ++c)
+  {
+    from[c] = in.channel(c);
+    to[c] = o.channel(c);
+  }
+  shifter.process(from.data(), to.data(), nchannels, n, ratios.data());
+}
+
+//--------------------------------------------------------------------------
+// SoundTouch backend - works on interleaved samples
+void PitchShift::tick_soundtouch(const AudioBlock& in, AudioBlock& o,
+                                 double sample_rate)
+{
+  const auto nchannels = o.get_nchannels();
+  const auto nsamples = o.get_nsamples();
+  if (sample_rate != sound_touch_sample_rate)
+  {
 #if defined(PLATFORM_WINDOWS)
-      soundtouch_setChannels(sound_touch.get(), nchannels);
+    soundtouch_setSampleRate(sound_touch.get(), sample_rate);
 #else
-      sound_touch.setChannels(nchannels);
+    sound_touch.setSampleRate(sample_rate);
 #endif
-    }
-    for (auto c = 0u; c < nchannels; ++c)
-      f.emplace_back(input.channels[c]);
-  });
+    sound_touch_sample_rate = sample_rate;
+  }
 
+  if (nchannels != sound_touch_channels)
+  {
 #if defined(PLATFORM_WINDOWS)
-  soundtouch_setPitchSemiTones(sound_touch.get(), pitch);
-  if (!f.empty())
-    soundtouch_putSamples(sound_touch.get(), &f[0], f.size() / nchannels);
-  const auto available_samples = soundtouch_numSamples(sound_touch.get())
-                                 / nchannels;
+    soundtouch_setChannels(sound_touch.get(), nchannels);
 #else
-  sound_touch.setPitchSemiTones(pitch);
-  if (!f.empty())
-    sound_touch.putSamples(&f[0], f.size() / nchannels);
-  const auto available_samples = sound_touch.numSamples() / nchannels;
+    sound_touch.setChannels(nchannels);
 #endif
-  const auto max_samples = nchannels
-                           ? min(available_samples,
-                                 static_cast<unsigned>(nsamples))
-                           : 0;
+    sound_touch_channels = nchannels;
+  }
 
-  f.clear();
-  if (max_samples)
+  const Number semitones = pitch;
+  if (semitones != sound_touch_pitch)
   {
-    f.resize(max_samples * nchannels);
 #if defined(PLATFORM_WINDOWS)
-    const auto samples = soundtouch_receiveSamples(sound_touch.get(),
-                                                   &f[0], max_samples);
+    soundtouch_setPitchSemiTones(sound_touch.get(), semitones);
 #else
-    const auto samples = sound_touch.receiveSamples(&f[0], max_samples);
+    sound_touch.setPitchSemiTones(semitones);
 #endif
-    f.resize(samples * nchannels);
+    sound_touch_pitch = semitones;
   }
 
-  auto fpos = 0u;
-  sample_iterate(td, nsamples, {}, {}, tie(output),
-                 [&](AudioData& o)
+  interleaved.assign(nsamples * nchannels, 0.0f);
+  const auto n = min<size_t>(nsamples, in.get_nsamples());
+  for (auto c = 0u; c < nchannels; ++c)
   {
-    o = AudioData();
-    o.nchannels = nchannels;
-    if (fpos < f.size())
-    {
-      for (auto c = 0u; c < nchannels; ++c)
-        o.channels[c] = f[fpos++];
-    }
-  });
+    const auto s = in.channel(c);
+    for (auto i = 0u; i < n; ++i)
+      interleaved[i * nchannels + c] = s[i];
+  }
+
+#if defined(PLATFORM_WINDOWS)
+  soundtouch_putSamples(sound_touch.get(), interleaved.data(), nsamples);
+  const auto samples = soundtouch_receiveSamples(sound_touch.get(),
+                                                 interleaved.data(),
+                                                 nsamples);
+#else
+  sound_touch.putSamples(interleaved.data(), nsamples);
+  const auto samples = sound_touch.receiveSamples(interleaved.data(),
+                                                  nsamples);
+#endif
+
+  for (auto c = 0u; c < nchannels; ++c)
+  {
+    auto d = o.channel(c);
+    for (auto i = 0u; i < samples; ++i)
+      d[i] = interleaved[i * nchannels + c];
+  }
 }
 
 Dataflow::SimpleModule module
@@ -140,13 +314,16 @@ Dataflow::SimpleModule module
   "pitch-shift",
   "Pitch Shift",
   "audio",
-  {},
   {
-    { "input",  &PitchShift::input },
-    { "pitch",  &PitchShift::pitch }
+    { "backend", &PitchShift::backend },
+    { "quality", &PitchShift::quality }
+  },
+  {
+    { "input",   &PitchShift::input },
+    { "pitch",   &PitchShift::pitch }
   },
   {
-    { "output", &PitchShift::output }
+    { "output",  &PitchShift::output }
   }
 };
 
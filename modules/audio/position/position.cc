@@ -19,6 +19,8 @@ using namespace ViGraph::Geometry;
 class Position: public SimpleElement
 {
 private:
+  AudioBlock held_input;  // Input held over a tick with no data
+
   // Element virtuals
   void tick(const TickData& td) override;
 
@@ -32,9 +34,9 @@ public:
   using SimpleElement::SimpleElement;
 
   // Configuration
-  Input<AudioData> input;
+  Input<AudioBlock> input;
   Input<Number> x{0.0};
-  Output<AudioData> output;
+  Output<AudioBlock> output;
 };
 
 //--------------------------------------------------------------------------
@@ -43,15 +45,22 @@ void Position::tick(const TickData& td)
 {
   const auto sample_rate = output.get_sample_rate();
   const auto nsamples = td.samples_in_tick(sample_rate);
-  sample_iterate(td, nsamples, {}, tie(input, x), tie(output),
-                 [](const AudioData& i, Number x,
-                    AudioData& o)
+  const auto& in = get_audio_block(input, nsamples, held_input);
+  const auto n = in.get_nchannels() ? min<size_t>(nsamples, in.get_nsamples())
+                                    : 0;
+  const auto xs = x.get_block(nsamples);
+
+  auto out = output.get_buffer(td);
+  auto& o = get_audio_block(out, 2, nsamples);
+  const auto s = in.channel(0);
+  auto l = o.channel(0);
+  auto r = o.channel(1);
+  for (auto i = 0u; i < n; ++i)
   {
-    x = min(max(x, -0.5), 0.5) + 0.5;
-    o.nchannels = 2;
-    o.channels[0] = i.channels[0] * cos(x * pi / 2);
-    o.channels[1] = i.channels[0] * sin(x * pi / 2);
-  });
+    const auto p = min(max(xs[i], -0.5), 0.5) + 0.5;
+    l[i] = s[i] * cos(p * pi / 2);
+    r[i] = s[i] * sin(p * pi / 2);
+  }
 }
 
 Dataflow::SimpleModule module
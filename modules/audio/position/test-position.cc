@@ -6,8 +6,7 @@
 // Copyright (c) 2019 Paul Clark.  All rights reserved
 //==========================================================================
 
-#include "../../module-test.h"
-#include "../audio-module.h"
+#include "../audio-module-test.h"
 #include "vg-geometry.h"
 #include "vg-waveform.h"
 
@@ -27,19 +26,21 @@ const auto samples = 1;
 TEST_F(PositionTest, TestNoInput)
 {
   auto& pos = add("audio/position");
-  auto actual = vector<AudioData>{};
+  auto actual = vector<AudioBlock>{};
   auto& sink = add_sink(actual, samples);
 
   pos.connect("output", sink, "input");
 
   run();
 
-  EXPECT_EQ(samples, actual.size());
+  ASSERT_EQ(1, actual.size());
+  const auto& block = actual[0];
+  ASSERT_EQ(2, block.get_nchannels());
+  ASSERT_EQ(samples, block.get_nsamples());
   for(auto i = 0u; i < samples; ++i)
   {
-    EXPECT_EQ(2, actual[i].nchannels);
-    EXPECT_NEAR(0.0, actual[i].channels[0], 1e-20);
-    EXPECT_NEAR(0.0, actual[i].channels[1], 1e-20);
+    EXPECT_NEAR(0.0, block.channel(0)[i], 1e-20);
+    EXPECT_NEAR(0.0, block.channel(1)[i], 1e-20);
   }
 }
 
@@ -48,11 +49,11 @@ TEST_F(PositionTest, TestCentered)
   auto& pos = add("audio/position")
               .set("x", 0.0);
 
-  const auto input = vector<AudioData>{ 1 };
+  const auto input = vector<AudioBlock>{ vector<sample_t>{ 1 } };
   auto& isrc = add_source(input);
   isrc.connect("output", pos, "input");
 
-  auto actual = vector<AudioData>{};
+  auto actual = vector<AudioBlock>{};
   auto& sink = add_sink(actual, samples);
   pos.connect("output", sink, "input");
 
@@ -60,12 +61,14 @@ TEST_F(PositionTest, TestCentered)
 
   const auto centered = (float)sin(pi / 4);
 
-  EXPECT_EQ(samples, actual.size());
+  ASSERT_EQ(1, actual.size());
+  const auto& block = actual[0];
+  ASSERT_EQ(2, block.get_nchannels());
+  ASSERT_EQ(samples, block.get_nsamples());
   for(auto i = 0u; i < samples; ++i)
   {
-    EXPECT_EQ(2, actual[i].nchannels);
-    EXPECT_DOUBLE_EQ(centered, actual[i].channels[0]);
-    EXPECT_DOUBLE_EQ(centered, actual[i].channels[1]);
+    EXPECT_DOUBLE_EQ(centered, block.channel(0)[i]);
+    EXPECT_DOUBLE_EQ(centered, block.channel(1)[i]);
   }
 }
 
@@ -74,11 +77,11 @@ TEST_F(PositionTest, TestFullRight)
   auto& pos = add("audio/position")
               .set("x", 0.5);
 
-  const auto input = vector<AudioData>{ 1 };
+  const auto input = vector<AudioBlock>{ vector<sample_t>{ 1 } };
   auto& isrc = add_source(input);
   isrc.connect("output", pos, "input");
 
-  auto actual = vector<AudioData>{};
+  auto actual = vector<AudioBlock>{};
   auto& sink = add_sink(actual, samples);
   pos.connect("output", sink, "input");
 
@@ -87,12 +90,14 @@ TEST_F(PositionTest, TestFullRight)
   const auto l = 0.0;
   const auto r = 1.0;
 
-  EXPECT_EQ(samples, actual.size());
+  ASSERT_EQ(1, actual.size());
+  const auto& block = actual[0];
+  ASSERT_EQ(2, block.get_nchannels());
+  ASSERT_EQ(samples, block.get_nsamples());
   for(auto i = 0u; i < samples; ++i)
   {
-    EXPECT_EQ(2, actual[i].nchannels);
-    EXPECT_NEAR(l, actual[i].channels[0], 1e-10);
-    EXPECT_NEAR(r, actual[i].channels[1], 1e-10);
+    EXPECT_NEAR(l, block.channel(0)[i], 1e-10);
+    EXPECT_NEAR(r, block.channel(1)[i], 1e-10);
   }
 }
 
@@ -101,11 +106,11 @@ TEST_F(PositionTest, TestFullLeft)
   auto& pos = add("audio/position")
               .set("x", -0.5);
 
-  const auto input = vector<AudioData>{ 1 };
+  const auto input = vector<AudioBlock>{ vector<sample_t>{ 1 } };
   auto& isrc = add_source(input);
   isrc.connect("output", pos, "input");
 
-  auto actual = vector<AudioData>{};
+  auto actual = vector<AudioBlock>{};
   auto& sink = add_sink(actual, samples);
   pos.connect("output", sink, "input");
 
@@ -114,12 +119,14 @@ TEST_F(PositionTest, TestFullLeft)
   const auto l = 1.0;
   const auto r = 0.0;
 
-  EXPECT_EQ(samples, actual.size());
+  ASSERT_EQ(1, actual.size());
+  const auto& block = actual[0];
+  ASSERT_EQ(2, block.get_nchannels());
+  ASSERT_EQ(samples, block.get_nsamples());
   for(auto i = 0u; i < samples; ++i)
   {
-    EXPECT_EQ(2, actual[i].nchannels);
-    EXPECT_NEAR(l, actual[i].channels[0], 1e-10);
-    EXPECT_NEAR(r, actual[i].channels[1], 1e-10);
+    EXPECT_NEAR(l, block.channel(0)[i], 1e-10);
+    EXPECT_NEAR(r, block.channel(1)[i], 1e-10);
   }
 }
 
@@ -128,11 +135,11 @@ TEST_F(PositionTest, TestOutOfBoundsRight)
   auto& pos = add("audio/position")
               .set("x", 1.5);
 
-  const auto input = vector<AudioData>{ 1 };
+  const auto input = vector<AudioBlock>{ vector<sample_t>{ 1 } };
   auto& isrc = add_source(input);
   isrc.connect("output", pos, "input");
 
-  auto actual = vector<AudioData>{};
+  auto actual = vector<AudioBlock>{};
   auto& sink = add_sink(actual, samples);
   pos.connect("output", sink, "input");
 
@@ -141,12 +148,14 @@ TEST_F(PositionTest, TestOutOfBoundsRight)
   const auto l = 0.0;
   const auto r = 1.0;
 
-  EXPECT_EQ(samples, actual.size());
+  ASSERT_EQ(1, actual.size());
+  const auto& block = actual[0];
+  ASSERT_EQ(2, block.get_nchannels());
+  ASSERT_EQ(samples, block.get_nsamples());
   for(auto i = 0u; i < samples; ++i)
   {
-    EXPECT_EQ(2, actual[i].nchannels);
-    EXPECT_NEAR(l, actual[i].channels[0], 1e-10);
-    EXPECT_NEAR(r, actual[i].channels[1], 1e-10);
+    EXPECT_NEAR(l, block.channel(0)[i], 1e-10);
+    EXPECT_NEAR(r, block.channel(1)[i], 1e-10);
   }
 }
 
@@ -155,11 +164,11 @@ TEST_F(PositionTest, TestOutOfBoundsLeft)
   auto& pos = add("audio/position")
               .set("x", -1.5);
 
-  const auto input = vector<AudioData>{ 1 };
+  const auto input = vector<AudioBlock>{ vector<sample_t>{ 1 } };
   auto& isrc = add_source(input);
   isrc.connect("output", pos, "input");
 
-  auto actual = vector<AudioData>{};
+  auto actual = vector<AudioBlock>{};
   auto& sink = add_sink(actual, samples);
   pos.connect("output", sink, "input");
 
@@ -168,12 +177,14 @@ TEST_F(PositionTest, TestOutOfBoundsLeft)
   const auto l = 1.0;
   const auto r = 0.0;
 
-  EXPECT_EQ(samples, actual.size());
+  ASSERT_EQ(1, actual.size());
+  const auto& block = actual[0];
+  ASSERT_EQ(2, block.get_nchannels());
+  ASSERT_EQ(samples, block.get_nsamples());
   for(auto i = 0u; i < samples; ++i)
   {
-    EXPECT_EQ(2, actual[i].nchannels);
-    EXPECT_NEAR(l, actual[i].channels[0], 1e-10);
-    EXPECT_NEAR(r, actual[i].channels[1], 1e-10);
+    EXPECT_NEAR(l, block.channel(0)[i], 1e-10);
+    EXPECT_NEAR(r, block.channel(1)[i], 1e-10);
   }
 }
 
@@ -7,18 +7,73 @@
 //==========================================================================
 
 #include "../audio-module.h"
+#include "vg-dsp.h"
 
 namespace {
 
+//--------------------------------------------------------------------------
+// Reverb mode
+enum class Mode
+{
+  comb,   // Single feedback comb
+  fdn     // Diffused feedback delay network
+};
+
+}
+
+namespace ViGraph { namespace Dataflow {
+
+template<> inline
+string get_module_type<Mode>() { return "reverb-mode"; }
+
+template<> inline void set_from_json(Mode& mode,
+                                     const JSON::Value& json)
+{
+  const auto& m = json.as_str();
+
+  if (m == "fdn")
+    mode = Mode::fdn;
+  else
+    mode = Mode::comb;
+}
+
+template<> inline JSON::Value get_as_json(const Mode& mode)
+{
+  switch (mode)
+  {
+    case Mode::comb:
+      return "comb";
+    case Mode::fdn:
+      return "fdn";
+  }
+  return {};
+}
+
+}} // namespaces
+
+namespace {
+
+const auto glide_time = 0.01;  // Smoothing time for delay changes, seconds
+const auto fdn_channel_spread = 0.013;  // Decorrelation between channels
+
 //==========================================================================
 // Reverb
 class Reverb: public SimpleElement
 {
 private:
-  deque<AudioData> buffer;
+  AudioBlock held_input;  // Input held over a tick with no data
+  array<DSP::DelayLine, max_channels> lines;
+  array<DSP::FDNReverb, max_channels> fdns;
+  double fdn_sample_rate{0.0};
+  DSP::Glide glide;
+  vector<double> delays;  // Per sample, in samples, reused each tick
+  double max_delay{0.0};  // Of delays this tick
 
   // Element virtuals
   void tick(const TickData& td) override;
+  void tick_comb(const AudioBlock& in, AudioBlock& o, const Number *f);
+  void tick_fdn(const AudioBlock& in, AudioBlock& o, const Number *f,
+                double sample_rate);
 
   // Clone
   Reverb *create_clone() const override
@@ -30,10 +85,11 @@ public:
   using SimpleElement::SimpleElement;
 
   // Configuration
-  Input<AudioData> input;
+  Setting<Mode> mode{Mode::comb};
+  Input<AudioBlock> input;
   Input<Number> time{0.0};
   Input<Number> feedback{0.0};
-  Output<AudioData> output;
+  Output<AudioBlock> output;
 };
 
 //--------------------------------------------------------------------------
@@ -44,30 +100,86 @@ void Reverb::tick(const TickData& td)
 
   const auto nsamples = td.samples_in_tick(sample_rate);
 
-  sample_iterate(td, nsamples, {}, tie(input, time, feedback), tie(output),
-                 [&](const AudioData& i, Number t, Number f,
-                     AudioData& o)
+  const auto& in = get_audio_block(input, nsamples, held_input);
+  const auto nchannels = min<size_t>(in.get_nchannels(), max_channels);
+  const auto t = time.get_block(nsamples);
+  const auto f = feedback.get_block(nsamples);
+
+  // Smooth the delay time so modulating it glides rather than clicks
+  glide.set_time(glide_time * sample_rate);
+  resize_buffer(delays, nsamples);
+  max_delay = 0.0;
+  for (auto i = 0u; i < nsamples; ++i)
   {
-    const auto bsamples = static_cast<size_t>(t * sample_rate);
-    if (bsamples > buffer.size())
-    {
-      buffer.insert(buffer.begin(), bsamples - buffer.size(),
-                    buffer.empty() ? 0 : buffer.front());
-    }
-    else if (bsamples < buffer.size())
+    delays[i] = glide.next(max(t[i], 0.0) * sample_rate);
+    max_delay = max(max_delay, delays[i]);
+  }
+
+  auto out = output.get_buffer(td);
+  auto& o = get_audio_block(out, nchannels, nsamples);
+  switch (mode.get())
+  {
+    case Mode::comb:
+      tick_comb(in, o, f);
+      break;
+
+    case Mode::fdn:
+      tick_fdn(in, o, f, sample_rate);
+      break;
+  }
+}
+
+//--------------------------------------------------------------------------
+// Single comb per channel
+void Reverb::tick_comb(const AudioBlock& in, AudioBlock& o, const Number *f)
+{
+  const auto nsamples = o.get_nsamples();
+  const auto navail = min<size_t>(nsamples, in.get_nsamples());
+  for (auto c = 0u; c < o.get_nchannels(); ++c)
+  {
+    auto& line = lines[c];
+    line.ensure(static_cast<size_t>(max_delay) + 1);
+    const auto ic = in.channel(c);
+    auto oc = o.channel(c);
+    for (auto i = 0u; i < nsamples; ++i)
     {
-      buffer.resize(bsamples);
+      // Feed back what we output 'delay' samples ago - the line holds
+      // our own output, so delay 0 there is last sample's output
+      auto v = i < navail ? ic[i] : 0.0;
+      if (delays[i] >= 1.0)
+        v += line.read(delays[i] - 1.0) * f[i];
+      line.write(v);
+      oc[i] = v;
     }
+  }
+}
 
-    o = i;
-    if (bsamples)
+//--------------------------------------------------------------------------
+// Feedback delay network per channel, mixed with the dry signal
+void Reverb::tick_fdn(const AudioBlock& in, AudioBlock& o, const Number *f,
+                      double sample_rate)
+{
+  if (sample_rate != fdn_sample_rate)
+  {
+    for (auto c = 0u; c < max_channels; ++c)
+      fdns[c].set_sample_rate(sample_rate, c * fdn_channel_spread);
+    fdn_sample_rate = sample_rate;
+  }
+
+  const auto nsamples = o.get_nsamples();
+  const auto navail = min<size_t>(nsamples, in.get_nsamples());
+  for (auto c = 0u; c < o.get_nchannels(); ++c)
+  {
+    auto& fdn = fdns[c];
+    fdn.ensure(max_delay);
+    const auto ic = in.channel(c);
+    auto oc = o.channel(c);
+    for (auto i = 0u; i < nsamples; ++i)
     {
-      for(auto c=0; c<o.nchannels; c++)
-        o.channels[c] += buffer.front().channels[c] * f;
-      buffer.pop_front();
-      buffer.emplace_back(o);
+      const auto v = i < navail ? ic[i] : 0.0f;
+      oc[i] = v + fdn.process(v, delays[i], f[i]);
     }
-  });
+  }
 }
 
 Dataflow::SimpleModule module
@@ -75,7 +187,9 @@ Dataflow::SimpleModule module
   "reverb",
   "Reverb",
   "audio",
-  {},
+  {
+    { "mode",     &Reverb::mode }
+  },
   {
     { "input",    &Reverb::input },
     { "time",     &Reverb::time },
@@ -0,0 +1,85 @@
+//==========================================================================
+// ViGraph dataflow module: audio/reverb/test-reverb.cc
+//
+// Tests for audio reverb
+//
+// Copyright (c) 2019 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "../audio-module-test.h"
+
+class ReverbTest: public GraphTester
+{
+public:
+  ReverbTest()
+  {
+    loader.load("./vg-module-audio-reverb.so");
+  }
+};
+
+TEST_F(ReverbTest, TestCombEchoesWithFeedback)
+{
+  auto& reverb = add("audio/reverb")
+                 .set("time", 0.1)
+                 .set("feedback", 0.5);
+
+  auto input = vector<sample_t>(100);
+  input[0] = 1.0;
+  auto& isrc = add_source(vector<AudioBlock>{input});
+  auto actual = vector<AudioBlock>{};
+  auto& sink = add_sink(actual, input.size());
+
+  isrc.connect("output", reverb, "input");
+  reverb.connect("output", sink, "input");
+
+  run();
+
+  ASSERT_EQ(1, actual.size());
+  const auto& block = actual[0];
+  ASSERT_EQ(1, block.get_nchannels());
+  for (auto i = 0u; i < 100; ++i)
+  {
+    const auto expected = i % 10 ? 0.0 : pow(0.5, i / 10);
+    EXPECT_FLOAT_EQ(expected, block.channel(0)[i]) << i;
+  }
+}
+
+TEST_F(ReverbTest, TestFDNGivesDryPlusTail)
+{
+  auto& reverb = add("audio/reverb")
+                 .set("time", 0.05)
+                 .set("feedback", 0.8);
+  reverb.get_module().get_setting("mode")->set_json(reverb,
+                                                    JSON::Value{"fdn"});
+
+  auto input = vector<sample_t>(1000);
+  input[0] = 1.0;
+  auto& isrc = add_source(vector<AudioBlock>{input});
+  auto actual = vector<AudioBlock>{};
+  auto& sink = add_sink(actual, input.size());
+
+  isrc.connect("output", reverb, "input");
+  reverb.connect("output", sink, "input");
+
+  run();
+
+  ASSERT_EQ(1, actual.size());
+  const auto& block = actual[0];
+  ASSERT_EQ(1, block.get_nchannels());
+  ASSERT_EQ(1000, block.get_nsamples());
+  const auto samples = block.channel(0);
+  EXPECT_FLOAT_EQ(1.0, samples[0]);  // Dry only until the lines come round
+  auto dense = 0u;  // Unlike a comb, the tail should be dense
+  for (auto i = 100u; i < 1000; ++i)
+  {
+    EXPECT_GT(1.0, fabs(samples[i])) << i;
+    if (samples[i] != 0.0) dense++;
+  }
+  EXPECT_LT(800, dense);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -7,6 +7,7 @@
 //==========================================================================
 
 #include "../audio-module.h"
+#include "vg-dsp.h"
 #include <SDL.h>
 
 namespace {
@@ -16,6 +17,8 @@ using namespace ViGraph::Dataflow;
 const auto default_device{"default"};
 const auto default_sample_rate{44100};
 const auto default_channels = 1;
+const auto default_latency = 0.1;
+const auto ring_time = 1.0;  // Capacity of ring, seconds
 
 //==========================================================================
 // SDL out
@@ -24,7 +27,8 @@ class SDLIn: public SimpleElement
 private:
   SDL_AudioDeviceID dev = 0;
   bool sdl_inited = false;
-  vector<float> input_buffer;
+  DSP::SampleRing ring;          // Interleaved, from callback to tick
+  vector<sample_t> interleaved;  // Reused each tick
   double input_sample_rate = default_sample_rate;
   double pos = 0.0;
 
@@ -45,8 +49,9 @@ public:
   Setting<string> device{default_device};
   Setting<Number> sample_rate{default_sample_rate};
   Setting<Number> nchannels{default_channels};
+  Setting<Number> latency{default_latency};
 
-  Output<AudioData> output;
+  Output<AudioBlock> output;
 
   // Callback for SDL
   void callback(Uint8 *stream, int len);
@@ -100,8 +105,9 @@ void callback(void *userdata, Uint8 *stream, int len)
 // Callback for SDL
 void SDLIn::callback(Uint8 *stream, int len)
 {
-  auto p = reinterpret_cast<sample_t *>(stream);
-  input_buffer.insert(input_buffer.end(), p, p + (len / sizeof(sample_t)));
+  // If the engine isn't keeping up, drop this lot (counted)
+  ring.write(reinterpret_cast<const sample_t *>(stream),
+             len / sizeof(sample_t));
 }
 
 //--------------------------------------------------------------------------
@@ -133,6 +139,10 @@ void SDLIn::setup(const SetupContext& context)
     want.userdata = this;
     want.callback = ::callback;
 
+    // Ring has to be ready before the callback can start
+    ring.resize(ring_time * sample_rate * nchannels);
+    pos = 0.0;
+
     // Open audio device
     const auto& dname = device.get();
     dev = SDL_OpenAudioDevice(dname == default_device
@@ -167,33 +177,50 @@ void SDLIn::tick(const TickData& td)
     auto buffer = output.get_buffer(td);
     const auto nsamples = td.samples_in_tick(sample_rate);
     const auto step = input_sample_rate / sample_rate;
-    const auto channels = nchannels.get();
+    const auto channels = static_cast<unsigned>(nchannels);
+
+    // Take a look at the frames we need (plus one to interpolate to)
+    const auto wanted = static_cast<size_t>(pos + nsamples * step) + 1;
+    interleaved.resize(wanted * channels);
+    const auto available = ring.peek(interleaved.data(),
+                                     interleaved.size()) / channels;
 
-    SDL_LockAudioDevice(dev);
-    const auto available = input_buffer.size() / channels;
-    for (auto i = 0u; i < nsamples; ++i)
+    auto& block = get_audio_block(buffer, channels, nsamples);
+    const auto start = pos;
+    for (auto c = 0u; c < channels; ++c)
     {
-      const auto p = fmod(pos, 1);
-      const auto i1 = static_cast<unsigned>(pos);
-      const auto i2 = i1 + 1;
-
-      buffer.data.push_back(AudioData());
-      auto& ad = buffer.data.back();
-      ad.nchannels = channels;
-      for(auto c=0; c<channels; c++)
+      // Interpolate each channel out of the interleaved input
+      auto s = block.channel(c);
+      pos = start;
+      for (auto i = 0u; i < nsamples; ++i)
       {
-        const auto c1 = i1 * channels + c;
-        const auto c2 = i2 * channels + c;
-        const auto s1 = c1 < available ? input_buffer[c1] : 0.0;
-        const auto s2 = c2 < available ? input_buffer[c2] : s1;
-        ad.channels[c] = s1 + (s2 - s1) * p;
+        const auto p = fmod(pos, 1);
+        const auto i1 = static_cast<unsigned>(pos);
+        const auto i2 = i1 + 1;
+        const auto s1 = i1 < available ? interleaved[i1 * channels + c] : 0.0;
+        const auto s2 = i2 < available ? interleaved[i2 * channels + c] : s1;
+        s[i] = s1 + (s2 - s1) * p;
+        pos += step;
       }
-      pos += step;
     }
-    input_buffer.erase(input_buffer.begin(),
-                       input_buffer.begin() +
-                       min(available, channels * (pos - step)));
-    SDL_UnlockAudioDevice(dev);
+
+    // Read the whole frames we used, noting if they weren't there
+    auto used = static_cast<size_t>(pos);
+    if (used > available)
+    {
+      ring.note_underrun();
+      used = available;
+    }
+    ring.skip(used * channels);
+
+    // If the device is running ahead of us, drop back to target latency
+    const auto target = static_cast<size_t>(latency * input_sample_rate)
+                        * channels;
+    if (ring.available() > 2 * target)
+    {
+      ring.note_overrun();
+      ring.skip(ring.available() - target);
+    }
   }
 }
 
@@ -201,7 +228,13 @@ void SDLIn::tick(const TickData& td)
 // Shut down
 void SDLIn::shutdown()
 {
-  if (dev) SDL_CloseAudioDevice(dev);
+  if (dev)
+  {
+    SDL_CloseAudioDevice(dev);
+    Log::Detail log;
+    log << "SDL audio in: " << ring.get_underruns() << " underruns, "
+        << ring.get_overruns() << " overruns\n";
+  }
   dev = 0;
 }
 
@@ -226,6 +259,7 @@ SimpleModule module
     { "device", &SDLIn::device },
     { "sample-rate", &SDLIn::sample_rate },
     { "channels", &SDLIn::nchannels },
+    { "latency", &SDLIn::latency },
   },
   {},
   {
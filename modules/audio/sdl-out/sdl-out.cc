@@ -7,6 +7,7 @@
 //==========================================================================
 
 #include "../audio-module.h"
+#include "vg-dsp.h"
 #include <SDL.h>
 
 namespace {
@@ -16,16 +17,21 @@ using namespace ViGraph::Dataflow;
 const auto default_device{"default"};
 const auto default_channels = 2;
 const auto default_buffer_size = 64;
+const auto default_latency = 0.05;
+const auto ring_time = 1.0;  // Capacity of ring, seconds
 
 //==========================================================================
 // SDL sink
 class SDLSink: public SimpleElement
 {
 private:
+  AudioBlock held_input;         // Input held over a tick with no data
   SDL_AudioDeviceID dev = 0;
   bool sdl_inited = false;
-  vector<sample_t> output_buffer;
-  bool starved = false;
+  DSP::SampleRing ring;          // Interleaved, from tick to callback
+  size_t target{0};              // Samples to build up before playing
+  bool primed = false;           // Only touched by callback
+  vector<sample_t> interleaved;  // Reused each tick
 
   // Source/Element virtuals
   void setup(const SetupContext& context) override;
@@ -44,8 +50,9 @@ public:
   Setting<string> device{default_device};
   Setting<Number> nchannels{default_channels};
   Setting<Number> buffer_size{default_buffer_size};
+  Setting<Number> latency{default_latency};
 
-  Input<AudioData> input;
+  Input<AudioBlock> input;
 
   // Callback for SDL
   void callback(Uint8 *stream, int len);
@@ -102,29 +109,26 @@ void SDLSink::callback(Uint8 *stream, int len)
   if (!dev)
     return;
 
-  if (output_buffer.size() * sizeof(sample_t) >=
-      (starved ? 1.5 : 1.0) * static_cast<unsigned>(len))
-  {
-    starved = false;
-    copy(&output_buffer[0], &output_buffer[0] + len / sizeof(sample_t),
-         reinterpret_cast<sample_t *>(stream));
-    output_buffer.erase(output_buffer.begin(),
-                        output_buffer.begin() + len / sizeof(sample_t));
-  }
-  else if (starved)
+  // Wait for the target latency to build up before playing, and again
+  // after an underrun, rather than stuttering on every sample we get
+  const auto n = len / sizeof(sample_t);
+  auto out = reinterpret_cast<sample_t *>(stream);
+  if (!primed && ring.available() >= target)
+    primed = true;
+
+  if (!primed || !ring.read(out, n))
   {
-    // We're on the edge so allow some slack to build up
-    fill(&stream[0], &stream[len], 0.0);
+    primed = false;
+    fill(out, out + n, 0.0);
+    return;
   }
-  else
+
+  // If the engine is running ahead of the device, drop back to target
+  // latency rather than letting it drift up to the whole ring
+  if (ring.available() > 2 * target)
   {
-    auto have = output_buffer.size() * sizeof(sample_t);
-    auto hstart = len - have;
-    fill(&stream[0], &stream[0] + hstart, 0);
-    copy(output_buffer.begin(), output_buffer.end(),
-         reinterpret_cast<sample_t *>(stream + hstart));
-    output_buffer.clear();
-    starved = true;
+    ring.note_overrun();
+    ring.skip(ring.available() - target);
   }
 }
 
@@ -155,13 +159,22 @@ void SDLSink::setup(const SetupContext& context)
     want.userdata = this;
     want.callback = ::callback;
 
-    // Open audio device
+    // Open audio device - it starts paused, so no callbacks yet
     dev = SDL_OpenAudioDevice(device == default_device
                               ? nullptr : device.get().c_str(),
                               0, &want, &have, 0);
     if (!dev)
       throw runtime_error(string("open: ") + SDL_GetError());
 
+    // Ring has to be ready before the callback can start.  The target has
+    // to leave room to drop back to it, or it would never prime
+    const auto channels = static_cast<size_t>(nchannels);
+    ring.resize(ring_time * have.freq * channels);
+    const auto max_target = ring.get_capacity() / 2 / channels;
+    target = min<size_t>(max<size_t>(latency * have.freq, buffer_size),
+                         max_target) * channels;
+    primed = false;
+
     // Start playback
     SDL_PauseAudioDevice(dev, 0);
 
@@ -181,23 +194,23 @@ void SDLSink::tick(const TickData& td)
 {
   if (dev)
   {
-    SDL_LockAudioDevice(dev);
     const auto nsamples = td.samples_in_tick(input.get_sample_rate());
-    auto bpos = output_buffer.size();
-    const auto channels = nchannels;
-    output_buffer.resize(bpos + nsamples * channels);
-    sample_iterate(td, nsamples, {},
-                   tie(input), {},
-                   [&](const AudioData& input)
+    const auto channels = static_cast<unsigned>(nchannels);
+    const auto& in = get_audio_block(input, nsamples, held_input);
+
+    // Interleave each channel in, with any we don't get left at zero
+    interleaved.assign(nsamples * channels, 0.0);
+    const auto n = min<size_t>(nsamples, in.get_nsamples());
+    for (auto c = 0u; c < min(channels, in.get_nchannels()); ++c)
     {
-      for(auto c=0; c<input.nchannels; c++)
-        output_buffer[bpos++] = input.channels[c];
-
-      // Zero any we don't get
-      for(auto c=input.nchannels; c<channels; c++)
-        output_buffer[bpos++] = 0;
-    });
-    SDL_UnlockAudioDevice(dev);
+      const auto s = in.channel(c);
+      auto p = &interleaved[c];
+      for (auto i = 0u; i < n; ++i)
+        p[i * channels] = s[i];
+    }
+
+    // If the callback can't keep up, drop this tick (counted)
+    ring.write(interleaved.data(), interleaved.size());
   }
 }
 
@@ -205,7 +218,13 @@ void SDLSink::tick(const TickData& td)
 // Shut down
 void SDLSink::shutdown()
 {
-  if (dev) SDL_CloseAudioDevice(dev);
+  if (dev)
+  {
+    SDL_CloseAudioDevice(dev);
+    Log::Detail log;
+    log << "SDL audio out: " << ring.get_underruns() << " underruns, "
+        << ring.get_overruns() << " overruns\n";
+  }
   dev = 0;
 }
 
@@ -230,6 +249,7 @@ Dataflow::SimpleModule module
     { "device", &SDLSink::device },
     { "channels", &SDLSink::nchannels },
     { "buffer-size", &SDLSink::buffer_size },
+    { "latency", &SDLSink::latency },
   },
   {
     { "input", &SDLSink::input }
@@ -9,19 +9,57 @@
 #include "../audio-module.h"
 #include "../../switch.h"
 
+// Audio carries a whole tick in one block, so mix into the output block at
+// each sample rather than emitting a value per sample
 template<>
-inline AudioData switch_fade(const AudioData& value, Number factor)
+class SwitchMixer<AudioBlock>
 {
-  AudioData result;
-  result.nchannels = value.nchannels;
-  for(auto c=0; c<result.nchannels; c++)
-    result.channels[c] = value.channels[c] * factor;
-  return result;
-}
+private:
+  AudioBlock& out;
+  unsigned nsamples;
+
+  static AudioBlock& get_output_block(vector<AudioBlock>& data,
+                                      unsigned nsamples)
+  {
+    resize_buffer(data, 1);
+    auto& block = data.front();
+    block.clear();
+    block.resize(0, nsamples);   // Channels added as inputs need them
+    return block;
+  }
+
+public:
+  SwitchMixer(vector<AudioBlock>& _out, unsigned _nsamples):
+    out{get_output_block(_out, _nsamples)}, nsamples{_nsamples}
+  {}
+
+  void add(const vector<AudioBlock>& in, const AudioBlock&, unsigned i,
+           double factor)
+  {
+    if (in.empty()) return;
+    const auto& block = in.front();
+    if (i >= block.get_nsamples()) return;
+
+    const auto nchannels = min<unsigned>(block.get_nchannels(),
+                                         max_channels);
+    if (nchannels > out.get_nchannels())
+      out.resize(nchannels, nsamples);
+    for (auto c = 0u; c < nchannels; ++c)
+      out.channel(c)[i] += block.channel(c)[i] * factor;
+  }
+
+  void add_full(const vector<AudioBlock>& in, const AudioBlock& last_val,
+                unsigned i)
+  {
+    add(in, last_val, i, 1.0);
+  }
+
+  void next() {}
+};
 
 namespace {
 
-class AudioSwitch: public FadeableSwitch<AudioData>
+class AudioSwitch: public FadeableSwitch<AudioBlock>
 {
 public:
   const static Dataflow::DynamicModule switch_module;
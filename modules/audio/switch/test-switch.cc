@@ -0,0 +1,76 @@
+//==========================================================================
+// ViGraph dataflow module: audio/switch/test-switch.cc
+//
+// Tests for audio switch
+//
+// Copyright (c) 2020 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "../audio-module-test.h"
+
+class SwitchTest: public GraphTester
+{
+public:
+  SwitchTest()
+  {
+    loader.load("./vg-module-audio-switch.so");
+  }
+};
+
+TEST_F(SwitchTest, TestSelectedInputPassesThrough)
+{
+  auto& sw = add("audio/switch");
+  setup(sw);
+
+  auto& nsrc = add_source(vector<Number>{2, 2, 2});
+  nsrc.connect("output", sw, "number");
+  auto& isrc1 = add_source(vector<AudioBlock>{vector<sample_t>{1, 1, 1}});
+  isrc1.connect("output", sw, "input1");
+  auto& isrc2 = add_source(
+    vector<AudioBlock>{vector<sample_t>{0.5, 0.25, 0}});
+  isrc2.connect("output", sw, "input2");
+
+  auto actual = vector<AudioBlock>{};
+  auto& sink = add_sink(actual, 3);
+  sw.connect("output", sink, "input");
+
+  run();
+
+  ASSERT_EQ(1, actual.size());
+  const auto& out = actual.front();
+  ASSERT_EQ(1, out.get_nchannels());
+  ASSERT_EQ(3, out.get_nsamples());
+  EXPECT_FLOAT_EQ(0.5, out.get(0, 0));
+  EXPECT_FLOAT_EQ(0.25, out.get(0, 1));
+  EXPECT_FLOAT_EQ(0, out.get(0, 2));
+}
+
+TEST_F(SwitchTest, TestFadeInWithinBlock)
+{
+  auto& sw = add("audio/switch").set("fade-in-time", Number{1});
+  setup(sw);
+
+  auto& nsrc = add_source(vector<Number>{1, 1, 1});
+  nsrc.connect("output", sw, "number");
+  auto& isrc = add_source(vector<AudioBlock>{vector<sample_t>{1, 1, 1}});
+  isrc.connect("output", sw, "input1");
+
+  auto actual = vector<AudioBlock>{};
+  auto& sink = add_sink(actual, 3);
+  sw.connect("output", sink, "input");
+
+  run();
+
+  ASSERT_EQ(1, actual.size());
+  const auto& out = actual.front();
+  ASSERT_EQ(3, out.get_nsamples());
+  EXPECT_NEAR(1.0/3, out.get(0, 0), 1e-6);
+  EXPECT_NEAR(2.0/3, out.get(0, 1), 1e-6);
+  EXPECT_NEAR(1.0, out.get(0, 2), 1e-6);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
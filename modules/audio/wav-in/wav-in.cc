@@ -7,21 +7,28 @@
 //==========================================================================
 
 #include "../audio-module.h"
-#include <SDL.h>
+#include "vg-wav.h"
 
 namespace {
 
 using namespace ViGraph::Dataflow;
 
+const auto cache_frames = 4096;       // Decoded at once, per channel
+const auto default_readahead = 2.0;   // Seconds
+
 //==========================================================================
 // WavIn
 class WavIn: public SimpleElement
 {
 private:
-  vector<vector<Number>> waveforms;
+  Wav::Reader reader;
   string wav_file;
   Number wav_sample_rate = 0;
-  unsigned wav_nsamples = 0;
+  size_t wav_nsamples = 0;
+  unsigned wav_nchannels = 0;
+  vector<float> cache;       // Planar, cache_frames per channel
+  size_t cache_start = 0;
+  size_t cache_count = 0;
   Number pos = 0;
   enum class State
   {
@@ -35,6 +42,9 @@ private:
   void setup(const SetupContext& context) override;
   void tick(const TickData& td) override;
 
+  // Internal
+  void fetch(size_t index, AudioFrame& frame);
+
   // Clone
   WavIn *create_clone() const override
   {
@@ -42,43 +52,19 @@ private:
   }
 
 public:
-  WavIn(const SimpleModule& module);
+  using SimpleElement::SimpleElement;
 
   Setting<string> file{};
   Setting<bool> loop{false};
+  Setting<Number> readahead{default_readahead};
 
   Input<Trigger> start{0};
   Input<Trigger> stop{0};
 
-  Output<AudioData> output;
+  Output<AudioBlock> output;
   Output<Trigger> finished;
 };
 
-//--------------------------------------------------------------------------
-// Constructor
-WavIn::WavIn(const SimpleModule& module):
-  SimpleElement(module)
-{
-  Log::Streams log;
-  SDL_version linked;
-  SDL_GetVersion(&linked);
-  SDL_version compiled;
-  SDL_VERSION(&compiled);
-  if (compiled.major != linked.major ||
-      compiled.minor != linked.minor ||
-      compiled.patch != linked.patch)
-  {
-    log.summary << "SDL compiled version: "
-                << static_cast<int>(compiled.major) << "."
-                << static_cast<int>(compiled.minor) << "."
-                << static_cast<int>(compiled.patch)
-                << ", linked version: "
-                << static_cast<int>(linked.major) << "."
-                << static_cast<int>(linked.minor) << "."
-                << static_cast<int>(linked.patch) << endl;
-  }
-}
-
 //--------------------------------------------------------------------------
 // Setup
 void WavIn::setup(const SetupContext& context)
@@ -90,8 +76,11 @@ void WavIn::setup(const SetupContext& context)
   if (wav_file == file.get())
     return;
 
-  waveforms.clear();
+  reader.close();
+  wav_file.clear();
   wav_nsamples = 0;
+  wav_nchannels = 0;
+  cache_count = 0;
   const auto f = context.get_file_path(file);
 
   if (!f || !f.exists())
@@ -101,74 +90,58 @@ void WavIn::setup(const SetupContext& context)
     return;
   }
 
-  SDL_AudioSpec spec;
-  Uint8 *buffer = nullptr;
-  Uint32 length = 0;
-  if (!SDL_LoadWAV(f.c_str(), &spec, &buffer, &length))
+  try
   {
-    Log::Error log;
-    log << "File cannot be loaded: '" << f << "': " << SDL_GetError()
-        << " in WavIn '" << get_id() << "'\n";
-    return;
+    reader.open(f.c_str());
   }
-
-  if (!length)
+  catch (const runtime_error& e)
   {
     Log::Error log;
-    log << "Empty wav file: '" << f << "' in WavIn '" << get_id() << "'\n";
+    log << "File cannot be loaded: " << e.what()
+        << " in WavIn '" << get_id() << "'\n";
     return;
   }
 
-  vector<float> s(length / sizeof(float));
-  memcpy(&s[0], buffer, length);
-  SDL_FreeWAV(buffer);
-
-  SDL_AudioCVT cvt;
-  if (SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq,
-                              AUDIO_F32, spec.channels, spec.freq) < 0)
+  if (!reader.get_nframes())
   {
     Log::Error log;
-    log << "Cannot prepare file for format conversion: '" << f << "': "
-        << SDL_GetError() << " in WavIn '" << get_id() << "'\n";
-    s.clear();
+    log << "Empty wav file: '" << f << "' in WavIn '" << get_id() << "'\n";
+    reader.close();
     return;
   }
 
-  if (cvt.needed)
-  {
-    const auto len_needed = length * cvt.len_mult;
-    cvt.len = length;
-    if (len_needed > length)
-    {
-      // We're going to need a bigger boat
-      s.resize(len_needed / sizeof(float));
-    }
-    cvt.buf = reinterpret_cast<Uint8 *>(&s[0]);
-    if (SDL_ConvertAudio(&cvt))
-    {
-      Log::Error log;
-      log << "Could not convert file to usable format: '" << f << "': "
-          << SDL_GetError() << " in WavIn '" << get_id() << "'\n";
-      s.clear();
-      return;
-    }
-    s.resize(cvt.len_ratio * cvt.len / sizeof(float));
-  }
-
-  waveforms.resize(spec.channels);
+  const auto& format = reader.get_format();
   wav_file = file;
-  wav_sample_rate = spec.freq;
-  for (auto c = 0u; c < spec.channels; ++c)
+  wav_sample_rate = format.sample_rate;
+  wav_nsamples = reader.get_nframes();
+  wav_nchannels = min<unsigned>(format.nchannels, max_channels);
+  cache.resize(wav_nchannels * cache_frames);
+  reader.prefetch(0, readahead * wav_sample_rate);
+
+  log.detail << "Opened wav file '" << f << "' with " << format.nchannels
+             << " channels, " << wav_nsamples << " samples\n";
+}
+
+//--------------------------------------------------------------------------
+// Get a frame, decoding a new block into the cache if we don't have it
+void WavIn::fetch(size_t index, AudioFrame& frame)
+{
+  if (index < cache_start || index >= cache_start + cache_count)
   {
-    auto& wc = waveforms[c];
-    wc.reserve(s.size() / spec.channels);
-    for (auto i = 0u; i < s.size(); i += spec.channels)
-      wc.push_back(s[i + c]);
-    wav_nsamples = wc.size();
+    // Start one back so interpolating across the block edge doesn't miss
+    cache_start = index ? index - 1 : 0;
+    cache_count = min<size_t>(cache_frames, wav_nsamples - cache_start);
+    for (auto c = 0u; c < wav_nchannels; ++c)
+      reader.read_channel(c, cache_start, cache_count,
+                          &cache[c * cache_frames]);
+
+    // Ask for the next lot to be read in the background
+    reader.prefetch(cache_start + cache_count, readahead * wav_sample_rate);
   }
 
-  log.detail << "Loaded wav file '" << f << "' with " << waveforms.size()
-             << " channels\n";
+  const auto offset = index - cache_start;
+  for (auto c = 0u; c < wav_nchannels; ++c)
+    frame[c] = cache[c * cache_frames + offset];
 }
 
 //--------------------------------------------------------------------------
@@ -178,10 +151,14 @@ void WavIn::tick(const TickData& td)
   auto sample_rate = output.get_sample_rate();
   const auto nsamples = td.samples_in_tick(sample_rate);
   const auto step = wav_sample_rate / sample_rate;
-  const auto nchannels = min(waveforms.size(), max_channels);
+  const auto nchannels = wav_nchannels;
 
-  sample_iterate(td, nsamples, {}, tie(start, stop), tie(output, finished),
-                 [&](Trigger _start, Trigger _stop, AudioData& ad, Trigger &f)
+  auto out = output.get_buffer(td);
+  auto& block = get_audio_block(out, nchannels, nsamples);
+  auto i = 0u;
+
+  sample_iterate(td, nsamples, {}, tie(start, stop), tie(finished),
+                 [&](Trigger _start, Trigger _stop, Trigger &f)
   {
     f = 0;
     if (_stop)
@@ -195,23 +172,21 @@ void WavIn::tick(const TickData& td)
       pos = 0.0;
     }
 
-    ad.nchannels = nchannels;
-
     switch (state)
     {
       case State::enabled:
       case State::completing:
         {
+          if (!wav_nsamples) break;
           const auto p = fmod(pos, 1);
-          const auto i1 = static_cast<unsigned>(pos);
+          const auto i1 = static_cast<size_t>(pos);
           const auto i2 = (i1 + 1 >= wav_nsamples) ? 0 : i1 + 1;
 
-          for(auto c=0; c<ad.nchannels; c++)
-          {
-            const auto& waveform = waveforms[c];
-            const auto s = waveform[i1] + ((waveform[i2] - waveform[i1]) * p);
-            ad.channels[c] = s;
-          }
+          AudioFrame s1, s2;
+          fetch(i1, s1);
+          fetch(i2, s2);
+          for(auto c=0u; c<nchannels; c++)
+            block.channel(c)[i] = s1[c] + ((s2[c] - s1[c]) * p);
           pos += step;
           if (pos >= wav_nsamples)
           {
@@ -225,10 +200,10 @@ void WavIn::tick(const TickData& td)
 
       case State::disabled:
       case State::complete:
-        for(auto c=0; c<ad.nchannels; c++)
-            ad.channels[c] = 0;
+        // Block starts silent
         break;
     }
+    ++i;
   });
 }
 
@@ -242,6 +217,7 @@ SimpleModule module
   {
     { "file",     &WavIn::file },
     { "loop",     &WavIn::loop },
+    { "readahead", &WavIn::readahead },
   },
   {
     { "start",    &WavIn::start },
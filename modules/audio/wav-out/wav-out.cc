@@ -0,0 +1,244 @@
+//==========================================================================
+// ViGraph dataflow module: audio/wav-out/wav-out.cc
+//
+// Record audio to a wav (or raw float) file
+//
+// Copyright (c) 2019 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "../audio-module.h"
+#include "vg-dsp.h"
+#include "vg-wav.h"
+#include <thread>
+
+namespace {
+
+using namespace ViGraph::Dataflow;
+
+const auto default_channels = 2;
+const auto ring_time = 4.0;      // Capacity of ring, seconds
+const auto batch_time = 0.25;    // Written at once, seconds
+const auto preallocate_time = 60.0;  // Disk reserved ahead, seconds
+const auto poll_interval = chrono::milliseconds{20};
+
+//==========================================================================
+// WavOut
+class WavOut: public SimpleElement
+{
+private:
+  AudioBlock held_input;      // Input held over a tick with no data
+  Wav::Writer writer;
+  string open_file;
+  bool open_raw{false};
+  unsigned open_channels{0};
+  Number open_sample_rate{0};
+  size_t batch_size{0};
+  vector<float> interleaved;  // Reused each tick
+  DSP::SampleRing ring;       // Interleaved, from tick to write thread
+  atomic<bool> stop_write_thread{false};
+  atomic<bool> write_failed{false};
+  unique_ptr<thread> write_thread;
+  uint64_t reported_drops{0};
+
+  // Source/Element virtuals
+  void setup(const SetupContext& context) override;
+  void tick(const TickData& td) override;
+  void shutdown();
+
+  // Internal
+  void run_write_thread();
+
+  // Clone
+  WavOut *create_clone() const override
+  {
+    return new WavOut{module};
+  }
+
+public:
+  using SimpleElement::SimpleElement;
+
+  Setting<string> file{};
+  Setting<bool> raw{false};
+  Setting<Number> nchannels{default_channels};
+
+  Input<AudioBlock> input;
+
+  ~WavOut() { shutdown(); }
+};
+
+//--------------------------------------------------------------------------
+// Setup
+void WavOut::setup(const SetupContext& context)
+{
+  SimpleElement::setup(context);
+
+  Log::Streams log;
+
+  // Setup is rerun on any setting change, so carry on recording unless
+  // something that affects the file has changed
+  const auto sample_rate = input.get_sample_rate();
+  if (write_thread && open_file == file.get() && open_raw == raw
+      && open_channels == nchannels && open_sample_rate == sample_rate)
+    return;
+
+  shutdown();
+  open_file.clear();
+
+  // File may not exist yet, so check its directory
+  const auto path = File::Path{file.get()};
+  const auto dir = context.get_file_path(path.dirname());
+  if (file.get().empty() || !dir)
+  {
+    Log::Error log;
+    log << "Bad output file: '" << file << "' in WavOut '" << get_id()
+        << "'\n";
+    return;
+  }
+
+  if (nchannels < 1 || nchannels > max_channels)
+  {
+    Log::Error log;
+    log << "Bad number of channels " << nchannels << " in WavOut '"
+        << get_id() << "'\n";
+    return;
+  }
+
+  const auto fpath = File::Path{dir, path.leaf()};
+  open_channels = nchannels;
+  try
+  {
+    writer.open(fpath.str(), open_channels, sample_rate, raw);
+  }
+  catch (const runtime_error& e)
+  {
+    Log::Error log;
+    log << "Can't record: " << e.what() << " in WavOut '" << get_id()
+        << "'\n";
+    return;
+  }
+
+  ring.resize(ring_time * sample_rate * open_channels);
+  // Whole frames, so a batch can always be filled
+  batch_size = max(1L, lround(batch_time * sample_rate)) * open_channels;
+  reported_drops = 0;
+
+  stop_write_thread = false;
+  write_failed = false;
+  write_thread.reset(new thread([this] { run_write_thread(); }));
+  open_file = file;
+  open_raw = raw;
+  open_sample_rate = sample_rate;
+
+  log.detail << "Recording " << open_channels << " channels to '" << fpath
+             << "'\n";
+}
+
+//--------------------------------------------------------------------------
+// Write thread - takes batches from the ring and writes them to disk
+void WavOut::run_write_thread()
+{
+  auto batch = vector<float>(batch_size);
+  const auto reserve = static_cast<uint64_t>(preallocate_time / batch_time)
+                       * batch_size * sizeof(float);
+  writer.preallocate(reserve);
+  for (;;)
+  {
+    const auto stopping = stop_write_thread.load();
+    auto n = min(ring.available(), batch_size);
+    n -= n % open_channels;  // Whole frames
+    if (n == batch_size || (stopping && n))
+    {
+      ring.read(batch.data(), n);
+      try
+      {
+        writer.write(batch.data(), n);
+        writer.preallocate(reserve);  // Only grows every so often
+      }
+      catch (const runtime_error& e)
+      {
+        Log::Error log;
+        log << "Recording stopped: " << e.what() << " in WavOut '"
+            << get_id() << "'\n";
+        write_failed = true;  // Tick stops sending us any more
+        break;
+      }
+    }
+    else if (stopping)
+      break;
+    else
+      this_thread::sleep_for(poll_interval);
+  }
+}
+
+//--------------------------------------------------------------------------
+// Process some data
+void WavOut::tick(const TickData& td)
+{
+  if (!write_thread || write_failed) return;
+
+  const auto nsamples = td.samples_in_tick(input.get_sample_rate());
+  const auto channels = open_channels;
+  const auto& in = get_audio_block(input, nsamples, held_input);
+
+  // Interleave each channel in, zeroing any we don't get
+  interleaved.resize(nsamples * channels);
+  fill(interleaved.begin(), interleaved.end(), 0);
+  const auto count = min<size_t>(nsamples, in.get_nsamples());
+  for (auto c = 0u; c < min(channels, in.get_nchannels()); ++c)
+  {
+    const auto s = in.channel(c);
+    auto p = &interleaved[c];
+    for (auto i = 0u; i < count; ++i)
+      p[i * channels] = s[i];
+  }
+
+  // Hand over to the write thread - if the disk can't keep up, this is
+  // dropped and reported
+  ring.write(interleaved.data(), interleaved.size());
+  const auto drops = ring.get_overruns();
+  if (drops != reported_drops)
+  {
+    Log::Error log;
+    log << "WavOut '" << get_id() << "' dropped audio - disk too slow ("
+        << drops << " blocks total)\n";
+    reported_drops = drops;
+  }
+}
+
+//--------------------------------------------------------------------------
+// Shut down - flushes what we have and closes the file
+void WavOut::shutdown()
+{
+  stop_write_thread = true;
+  if (!!write_thread)
+  {
+    write_thread->join();
+    Log::Detail log;
+    log << "WavOut '" << get_id() << "' recorded " << writer.get_nframes()
+        << " samples, dropped " << ring.get_overruns() << " blocks\n";
+  }
+  write_thread.reset();
+  writer.close();
+}
+
+//--------------------------------------------------------------------------
+// Module definition
+SimpleModule module
+{
+  "wav-out",
+  "Wav file output",
+  "audio",
+  {
+    { "file",     &WavOut::file },
+    { "raw",      &WavOut::raw },
+    { "channels", &WavOut::nchannels },
+  },
+  {
+    { "input",    &WavOut::input },
+  },
+  {}
+};
+
+} // anon
+
+VIGRAPH_ENGINE_ELEMENT_MODULE_INIT(WavOut, module)
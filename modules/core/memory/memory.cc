@@ -20,8 +20,8 @@ class Memory: public SimpleElement
   // Element virtuals
   void tick(const TickData& td) override;
 
-  // Custom ready() so we can live in a loop
-  bool ready() const override { return true; }
+  // Don't wait for inputs so we can live in a loop
+  bool waits_for_inputs() const override { return false; }
 
   // Read the input before it is reset, for next time
   void reset() override
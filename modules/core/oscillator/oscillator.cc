@@ -19,7 +19,12 @@ using namespace ViGraph::Geometry;
 class OscillatorSource: public SimpleElement
 {
 private:
-  Number theta = 0.0;
+  // Control outputs want exact shapes, not band-limited ones
+  Waveform::Oscillator oscillator{false};
+
+  // Increment only recalculated when the period or sample rate changes
+  Number last_period = numeric_limits<Number>::quiet_NaN();
+  double last_sample_rate = 0.0;
   enum State
   {
     disabled,
@@ -59,6 +64,12 @@ void OscillatorSource::tick(const TickData& td)
 {
   const auto sample_rate = output.get_sample_rate();
   const auto nsamples = td.samples_in_tick(sample_rate);
+  if (sample_rate != last_sample_rate)
+  {
+    last_sample_rate = sample_rate;
+    last_period = numeric_limits<Number>::quiet_NaN();
+  }
+
   sample_iterate(td, nsamples, {},
                  tie(waveform, period, pulse_width, phase, start, stop),
                  tie(output),
@@ -76,7 +87,7 @@ void OscillatorSource::tick(const TickData& td)
       if (state == State::disabled)
       {
         state = State::enabled;
-        theta = 0.0;
+        oscillator.set_phase(0.0);
       }
     }
 
@@ -85,15 +96,14 @@ void OscillatorSource::tick(const TickData& td)
       case State::enabled:
       case State::completing:
       {
-        auto tp = theta+phase;
-        output = (Waveform::get_value(wf, pw, tp-floor(tp))+1)/2;
-        if (period > 0) theta += 1 / period / sample_rate;
-        if (theta >= 1)
+        if (period != last_period)
         {
-          theta -= floor(theta); // Wrap to 0..1
-          if (state == State::completing)
-            state = State::disabled;
+          oscillator.set_increment(period > 0 ? 1 / period / sample_rate : 0);
+          last_period = period;
         }
+        output = (oscillator.get_value(wf, pw, phase)+1)/2;
+        if (oscillator.advance() && state == State::completing)
+          state = State::disabled;
         break;
       }
 
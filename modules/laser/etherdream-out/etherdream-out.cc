@@ -23,6 +23,7 @@ private:
 
   // State
   unique_ptr<EtherDream::TCPInterface> etherdream;
+  bool running{false};
 
   // Element virtuals
   void setup(const SetupContext& context) override;
@@ -66,7 +67,8 @@ void EtherDreamOut::setup(const SetupContext& context)
   log.summary << "Creating EtherDream transmitter to " << destination << endl;
 
   etherdream.reset(new EtherDream::TCPInterface(destination));
-  etherdream->start();
+  running = etherdream->start();
+  if (running) etherdream->start_thread();
 
   input.set_sample_rate(frame_rate);
 }
@@ -80,23 +82,20 @@ void EtherDreamOut::tick(const TickData& td)
   sample_iterate(td, nsamples, {}, tie(input), {},
                  [&](const Frame& input)
   {
-    if (!input.points.empty())
+    // Hand off to the interface's I/O thread - never waits for the device
+    if (running && !input.points.empty()
+        && !etherdream->queue_frame(input.points, 1.0/frame_rate))
     {
-      if (etherdream->get_ready())
+      // Stop if the connection has gone - already reported by the interface
+      if (etherdream->has_failed())
       {
-        auto available = etherdream->get_buffer_points_available();
-        if (input.points.size() <= available)
-        {
-          etherdream->send(input.points, 1.0/frame_rate);
-        }
-        else
-        {
-          Log::Error log;
-          log << "Etherdream overflow - only " << available
-              << " points available, " << input.points.size()
-              << " to send - frame skipped\n";
-        }
+        running = false;
+        return;
       }
+
+      Log::Error log;
+      log << "Etherdream falling behind - "
+          << etherdream->get_frames_dropped() << " frames dropped\n";
     }
   });
 }
@@ -107,6 +106,7 @@ void EtherDreamOut::shutdown()
 {
   Log::Detail log;
   log << "Shutting down EtherDream transmitter\n";
+  if (etherdream) etherdream->stop_thread();
   etherdream.reset();
 }
 
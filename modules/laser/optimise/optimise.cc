@@ -0,0 +1,142 @@
+//==========================================================================
+// ViGraph dataflow module: laser/optimise/optimise.cc
+//
+// Combined laser optimiser - segment reordering, blank run stripping,
+// infill, vertex repeats and blanking anchors in a single pass
+//
+// Copyright (c) 2020 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "../../vector/vector-module.h"
+#include "vg-laser.h"
+
+namespace {
+
+const auto default_strip_threshold = 5.0;
+const auto default_vertex_repeats = 3;
+const auto default_vertex_max_angle = 30.0;
+const int default_anchors_leading = 5;
+const int default_anchors_trailing = 5;
+
+//==========================================================================
+// Optimise
+class Optimise: public SimpleElement
+{
+private:
+  Laser::Optimiser optimiser;
+  Laser::StripBlankRunsStage strip;
+  Laser::InfillStage infill;
+  Laser::VertexRepeatsStage vertices;
+  Laser::BlankingAnchorsStage anchors;
+  Laser::Pipeline pipeline;
+  vector<Point> reordered;
+  size_t last_size{0};
+
+  // Element virtuals
+  void tick(const TickData& td) override;
+
+  // Clone
+  Optimise *create_clone() const override
+  {
+    return new Optimise{module};
+  }
+
+public:
+  using SimpleElement::SimpleElement;
+
+  // Settings
+  Setting<bool> reorder{false};
+  Setting<bool> reverse{true};
+  Setting<Number> improve_time{0.0};  // seconds per frame
+  Setting<Number> strip_threshold{default_strip_threshold};  // <0 = off
+  Setting<Number> infill_lit{0.0};
+  Setting<Number> infill_blanked{0.0};
+  Setting<Integer> vertex_repeats{default_vertex_repeats};
+  Setting<Number> vertex_max_angle{default_vertex_max_angle};
+  Setting<Integer> anchors_leading{default_anchors_leading};
+  Setting<Integer> anchors_trailing{default_anchors_trailing};
+
+  // Input
+  Input<Frame> input;
+
+  // Output
+  Output<Frame> output;
+};
+
+//--------------------------------------------------------------------------
+// Tick data
+void Optimise::tick(const TickData& td)
+{
+  // Set up the stages which will have any effect
+  pipeline.clear();
+  if (strip_threshold >= 0)
+  {
+    strip.set(strip_threshold);
+    pipeline.add(strip);
+  }
+  if (infill_lit || infill_blanked)
+  {
+    infill.set(infill_lit, infill_blanked);
+    pipeline.add(infill);
+  }
+  if (vertex_repeats > 0)
+  {
+    vertices.set(vertex_max_angle*pi/180, vertex_repeats);
+    pipeline.add(vertices);
+  }
+  if (anchors_leading > 0 || anchors_trailing > 0)
+  {
+    anchors.set(anchors_leading, anchors_trailing);
+    pipeline.add(anchors);
+  }
+
+  const auto nsamples = td.samples_in_tick(output.get_sample_rate());
+  sample_iterate(td, nsamples, {}, tie(input), tie(output),
+                 [&](const Frame& input, Frame& output)
+  {
+    const auto *points = &input.points;
+    if (reorder)
+    {
+      reordered = optimiser.reorder_segments(input.points, reverse,
+                                             improve_time);
+      points = &reordered;
+    }
+
+    // Output frames are new each tick, so size from the last one to
+    // avoid growing it
+    output.points.reserve(last_size);
+    pipeline.run(*points, output.points);
+    last_size = output.points.size();
+  });
+}
+
+//--------------------------------------------------------------------------
+// Module definition
+Dataflow::SimpleModule module
+{
+  "optimise",
+  "Laser optimise",
+  "laser",
+  {
+    { "reorder",          &Optimise::reorder          },
+    { "reverse",          &Optimise::reverse          },
+    { "improve-time",     &Optimise::improve_time     },
+    { "strip-threshold",  &Optimise::strip_threshold  },
+    { "infill-lit",       &Optimise::infill_lit       },
+    { "infill-blanked",   &Optimise::infill_blanked   },
+    { "vertex-repeats",   &Optimise::vertex_repeats   },
+    { "vertex-max-angle", &Optimise::vertex_max_angle },
+    { "anchors-leading",  &Optimise::anchors_leading  },
+    { "anchors-trailing", &Optimise::anchors_trailing }
+  },
+  {
+    { "input", &Optimise::input }
+  },
+  {
+    { "output", &Optimise::output }
+  }
+};
+
+} // anon
+
+VIGRAPH_ENGINE_ELEMENT_MODULE_INIT(Optimise, module)
@@ -0,0 +1,126 @@
+//==========================================================================
+// ViGraph dataflow module: laser/optimise/test-optimise.cc
+//
+// Tests for <optimise> filter
+//
+// Copyright (c) 2020 Paul Clark.  All rights reserved
+//==========================================================================
+
+#include "../../vector/vector-module.h"
+#include "../../module-test.h"
+#include "vg-laser.h"
+
+class OptimiseTest: public GraphTester
+{
+public:
+  OptimiseTest()
+  {
+    loader.load("./vg-module-laser-optimise.so");
+  }
+};
+
+const auto sample_rate = 1;
+
+vector<Point> test_points()
+{
+  vector<Point> points;
+  points.push_back(Point(0, 0));
+  points.push_back(Point(0.1, 0, Colour::white));
+  points.push_back(Point(0.1, 0.2, Colour::red));
+  for(int i=0; i<10; i++)
+    points.push_back(Point(0.1, 0.2));
+  points.push_back(Point(-0.3, 0.4));
+  points.push_back(Point(-0.3, -0.1, Colour::green));
+  points.push_back(Point(0.2, -0.1, Colour::blue));
+  return points;
+}
+
+TEST_F(OptimiseTest, TestDefaultsMatchSeparateStages)
+{
+  auto& opt = add("laser/optimise");
+
+  auto fr_data = vector<Frame>(1);
+  fr_data[0].points = test_points();
+
+  auto& frs = add_source(fr_data);
+  frs.connect("output", opt, "input");
+
+  auto outfrs = vector<Frame>{};
+  auto& snk = add_sink(outfrs, sample_rate);
+  opt.connect("output", snk, "input");
+
+  run();
+
+  Laser::Optimiser optimiser;
+  auto expected = optimiser.strip_blank_runs(test_points(), 5);
+  expected = optimiser.add_vertex_repeats(expected, pi/6, 3);
+  expected = optimiser.add_blanking_anchors(expected, 5, 5);
+
+  ASSERT_EQ(sample_rate, outfrs.size());
+  EXPECT_EQ(expected, outfrs[0].points);
+}
+
+TEST_F(OptimiseTest, TestAllStages)
+{
+  auto& opt = add("laser/optimise")
+              .set("reorder", true)
+              .set("strip-threshold", 2.0)
+              .set("infill-lit", 0.05)
+              .set("infill-blanked", 0.1)
+              .set("vertex-repeats", Integer{2})
+              .set("vertex-max-angle", 45.0)
+              .set("anchors-leading", Integer{1})
+              .set("anchors-trailing", Integer{3});
+
+  auto fr_data = vector<Frame>(1);
+  fr_data[0].points = test_points();
+
+  auto& frs = add_source(fr_data);
+  frs.connect("output", opt, "input");
+
+  auto outfrs = vector<Frame>{};
+  auto& snk = add_sink(outfrs, sample_rate);
+  opt.connect("output", snk, "input");
+
+  run();
+
+  Laser::Optimiser optimiser;
+  auto expected = optimiser.reorder_segments(test_points());
+  expected = optimiser.strip_blank_runs(expected, 2);
+  expected = optimiser.infill_lines(expected, 0.05, 0.1);
+  expected = optimiser.add_vertex_repeats(expected, pi/4, 2);
+  expected = optimiser.add_blanking_anchors(expected, 1, 3);
+
+  ASSERT_EQ(sample_rate, outfrs.size());
+  EXPECT_EQ(expected, outfrs[0].points);
+}
+
+TEST_F(OptimiseTest, TestStagesDisabled)
+{
+  auto& opt = add("laser/optimise")
+              .set("strip-threshold", -1.0)
+              .set("vertex-repeats", Integer{0})
+              .set("anchors-leading", Integer{0})
+              .set("anchors-trailing", Integer{0});
+
+  auto fr_data = vector<Frame>(1);
+  fr_data[0].points = test_points();
+
+  auto& frs = add_source(fr_data);
+  frs.connect("output", opt, "input");
+
+  auto outfrs = vector<Frame>{};
+  auto& snk = add_sink(outfrs, sample_rate);
+  opt.connect("output", snk, "input");
+
+  run();
+
+  ASSERT_EQ(sample_rate, outfrs.size());
+  EXPECT_EQ(test_points(), outfrs[0].points);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -30,6 +30,10 @@ private:
 public:
   using SimpleElement::SimpleElement;
 
+  // Settings
+  Setting<bool> reverse{true};
+  Setting<Number> improve_time{0.0};  // seconds per frame, 0 = none
+
   // Input
   Input<Frame> input;
 
@@ -42,10 +46,13 @@ public:
 void ReorderSegments::tick(const TickData& td)
 {
   const auto nsamples = td.samples_in_tick(output.get_sample_rate());
-  sample_iterate(td, nsamples, {}, tie(input), tie(output),
-                 [&](const Frame& input, Frame& output)
+  sample_iterate(td, nsamples, tie(reverse, improve_time), tie(input),
+                 tie(output),
+                 [&](bool reverse, Number improve_time, const Frame& input,
+                     Frame& output)
   {
-    output.points = optimiser.reorder_segments(input.points);
+    output.points = optimiser.reorder_segments(input.points, reverse,
+                                               improve_time);
   });
 }
 
@@ -56,7 +63,10 @@ Dataflow::SimpleModule module
   "reorder-segments",
   "Reorder segments",
   "laser",
-  {},
+  {
+    { "reverse",      &ReorderSegments::reverse      },
+    { "improve-time", &ReorderSegments::improve_time }
+  },
   {
     { "input", &ReorderSegments::input }
   },
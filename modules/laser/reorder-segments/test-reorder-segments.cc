@@ -86,6 +86,63 @@ TEST_F(ReorderSegmentsTest, TestSegmentsInSillyOrderReordered)
   EXPECT_EQ(4, outfr.points[5].x);
 }
 
+TEST_F(ReorderSegmentsTest, TestSegmentsReversedIfCloser)
+{
+  auto& sb = add("laser/reorder-segments");
+
+  auto fr_data = vector<Frame>(1);
+  auto& fr = fr_data[0];
+  fr.points.push_back(Point(0,0));
+  fr.points.push_back(Point(1,0, Colour::white));
+  fr.points.push_back(Point(3,0));
+  fr.points.push_back(Point(2,0, Colour::white));
+
+  auto& frs = add_source(fr_data);
+  frs.connect("output", sb, "input");
+
+  auto outfrs = vector<Frame>{};
+  auto& snk = add_sink(outfrs, sample_rate);
+  sb.connect("output", snk, "input");
+
+  run();
+
+  ASSERT_EQ(sample_rate, outfrs.size());
+  const auto& outfr = outfrs[0];
+  ASSERT_EQ(4, outfr.points.size());
+  EXPECT_EQ(2, outfr.points[2].x);
+  EXPECT_TRUE(outfr.points[2].is_blanked());
+  EXPECT_EQ(3, outfr.points[3].x);
+  EXPECT_TRUE(outfr.points[3].is_lit());
+}
+
+TEST_F(ReorderSegmentsTest, TestSegmentsNotReversedIfDisabled)
+{
+  auto& sb = add("laser/reorder-segments")
+             .set("reverse", false);
+
+  auto fr_data = vector<Frame>(1);
+  auto& fr = fr_data[0];
+  fr.points.push_back(Point(0,0));
+  fr.points.push_back(Point(1,0, Colour::white));
+  fr.points.push_back(Point(3,0));
+  fr.points.push_back(Point(2,0, Colour::white));
+
+  auto& frs = add_source(fr_data);
+  frs.connect("output", sb, "input");
+
+  auto outfrs = vector<Frame>{};
+  auto& snk = add_sink(outfrs, sample_rate);
+  sb.connect("output", snk, "input");
+
+  run();
+
+  ASSERT_EQ(sample_rate, outfrs.size());
+  const auto& outfr = outfrs[0];
+  ASSERT_EQ(4, outfr.points.size());
+  EXPECT_EQ(3, outfr.points[2].x);
+  EXPECT_EQ(2, outfr.points[3].x);
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -28,11 +28,13 @@ private:
   void tick(const TickData& td) override
   {
     const auto nsamples = td.samples_in_tick(output.get_sample_rate());
-    sample_iterate(td, nsamples, {}, tie(x, y), tie(output),
-                   [&](double x, double y, double & o)
-                   {
-                     o = op(x, y);
-                   });
+    block_iterate(td, nsamples, {}, tie(x, y), tie(output),
+                  [&](unsigned n, const double *x, const double *y,
+                      double *o)
+                  {
+                    for (auto i = 0u; i < n; ++i)
+                      o[i] = op(x[i], y[i]);
+                  });
   }
 
 public:
@@ -158,6 +158,40 @@ public:
 
 template<typename T> inline T switch_fade(const T& value, double factor);
 
+//==========================================================================
+// Switch mixer - accumulates the (faded) inputs into the output sample by
+// sample.  The default emits one T per sample using switch_fade; types
+// which carry a whole tick in one value specialise it
+template<typename T>
+class SwitchMixer
+{
+private:
+  vector<T>& out;
+  T v{};
+
+public:
+  SwitchMixer(vector<T>& _out, unsigned): out{_out} {}
+
+  // Add sample i of an input, faded by factor
+  void add(const vector<T>& in, const T& last_val, unsigned i, double factor)
+  {
+    v += switch_fade(i < in.size() ? in[i] : last_val, factor);
+  }
+
+  // Add sample i of an input at full level
+  void add_full(const vector<T>& in, const T& last_val, unsigned i)
+  {
+    v += i < in.size() ? in[i] : last_val;
+  }
+
+  // Finish this sample and move to the next
+  void next()
+  {
+    out.emplace_back(v);
+    v = T{};
+  }
+};
+
 //==========================================================================
 // Fadeable Switch class template
 template<typename T>
@@ -210,6 +244,7 @@ private:
     const auto nsamples = td.samples_in_tick(sample_rate);
 
     auto out = output.get_buffer(td);
+    SwitchMixer<T> mixer(out.data, nsamples);
 
     struct InputData
     {
@@ -313,12 +348,11 @@ private:
         }
       }
 
-      auto v = T{};
       for (auto idit = id.begin(); idit != id.end();)
       {
         auto n = idit->first;
-        auto& b = *idit->second.data;
-        const auto& bval = i < b.size() ? b[i] : idit->second.last_val;
+        const auto& b = *idit->second.data;
+        const auto& last_val = idit->second.last_val;
         auto& s = *idit->second.state;
         auto removed = false;
         switch (s.fade)
@@ -330,11 +364,11 @@ private:
               s.factor = 1;
               s.fade = State::Fade::full;
             }
-            v += switch_fade(bval, s.factor);
+            mixer.add(b, last_val, i, s.factor);
             break;
 
           case State::Fade::full:
-            v += bval;
+            mixer.add_full(b, last_val, i);
             break;
 
           case State::Fade::out:
@@ -346,7 +380,7 @@ private:
                 s.factor = 0;
                 complete = true;
               }
-              v += switch_fade(bval, s.factor);
+              mixer.add(b, last_val, i, s.factor);
               if (complete)
               {
                 states.erase(n);
@@ -359,7 +393,7 @@ private:
         if (!removed)
           ++idit;
       }
-      out.data.emplace_back(v);
+      mixer.next();
     }
   }
 
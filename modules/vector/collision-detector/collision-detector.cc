@@ -23,8 +23,8 @@ private:
   // Element virtuals
   void tick(const TickData& td) override;
 
-  // Custom ready() so we can live in a loop
-  bool ready() const override { return true; }
+  // Don't wait for inputs so we can live in a loop
+  bool waits_for_inputs() const override { return false; }
 
   // Read the input before it is reset, for next time
   // Note we do the collision calculation one tick behind, to allow for
@@ -41,6 +41,11 @@ const auto default_points{100};
 class Figure: public SimpleElement
 {
 private:
+  // Figures want exact shapes, not band-limited ones
+  Waveform::Oscillator x_osc{false};
+  Waveform::Oscillator y_osc{false};
+  Waveform::Oscillator z_osc{false};
+
   // Element virtuals
   void tick(const TickData& td) override;
 
@@ -96,31 +101,24 @@ void Figure::tick(const TickData& td)
                      Number points, Number closed,
                      Frame& output)
   {
-    Number x_theta = x_phase;
-    Number y_theta = y_phase;
-    Number z_theta = z_phase;
-
     // Special cases to fix phase difference - waveform library starts
     // at zero-crossing point for saw, with a discontinuity midway,
     // but we want a single smooth line
-    if (x_wf == Waveform::Type::saw) x_theta += 0.5;
-    if (y_wf == Waveform::Type::saw) y_theta += 0.5;
-    if (z_wf == Waveform::Type::saw) z_theta += 0.5;
+    x_osc.set_phase(x_phase + (x_wf == Waveform::Type::saw ? 0.5 : 0));
+    y_osc.set_phase(y_phase + (y_wf == Waveform::Type::saw ? 0.5 : 0));
+    z_osc.set_phase(z_phase + (z_wf == Waveform::Type::saw ? 0.5 : 0));
+    x_osc.set_increment(x_freq/points);
+    y_osc.set_increment(y_freq/points);
+    z_osc.set_increment(z_freq/points);
 
     for(auto i=0; i<points; i++)
     {
-      // Note wrapped before because phase fix can put them over 1.0
-      if (x_theta >= 1) x_theta -= floor(x_theta);
-      auto x = Waveform::get_value(x_wf, x_pw, x_theta)/2;
-      x_theta += x_freq/points;
-
-      if (y_theta >= 1) y_theta -= floor(y_theta);
-      auto y = Waveform::get_value(y_wf, y_pw, y_theta)/2;
-      y_theta += y_freq/points;
-
-      if (z_theta >= 1) z_theta -= floor(z_theta);
-      auto z = Waveform::get_value(z_wf, z_pw, z_theta)/2;
-      z_theta += z_freq/points;
+      auto x = x_osc.get_value(x_wf, x_pw)/2;
+      auto y = y_osc.get_value(y_wf, y_pw)/2;
+      auto z = z_osc.get_value(z_wf, z_pw)/2;
+      x_osc.advance();
+      y_osc.advance();
+      z_osc.advance();
 
       // Double first point with extra blank to start
       if (!i) output.points.push_back(Point(x, y, z));
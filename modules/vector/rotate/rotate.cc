@@ -45,34 +45,13 @@ public:
 void Rotate::tick(const TickData& td)
 {
   const auto nsamples = td.samples_in_tick(output.get_sample_rate());
+  const auto defer = can_defer_affine(output);
   sample_iterate(td, nsamples, {}, tie(x, y, z, input), tie(output),
                  [&](Number x, Number y, Number z, const Frame& input,
                      Frame& output)
   {
-    // Precalculate useful stuff
-    // ! Could optimise only on changes?
-    double sinx = sin(x*2*pi);
-    double cosx = cos(x*2*pi);
-    double siny = sin(y*2*pi);
-    double cosy = cos(y*2*pi);
-    double sinz = sin(z*2*pi);
-    double cosz = cos(z*2*pi);
-
-    // Modify all points in the frame
-    output = input;
-    for(auto& p: output.points)
-    {
-      double xy = cosx*p.y - sinx*p.z;
-      double xz = sinx*p.y + cosx*p.z;
-      double yz = cosy*xz  - siny*p.x;
-      double yx = siny*xz  + cosy*p.x;
-      double zx = cosz*yx  - sinz*xy;
-      double zy = sinz*yx  + cosz*xy;
-
-      p.x = zx;
-      p.y = zy;
-      p.z = yz;
-    }
+    apply_affine(input, Matrix::rotation(Vector(x, y, z)*2*pi), defer,
+                 output);
   });
 }
 
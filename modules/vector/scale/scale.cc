@@ -45,17 +45,12 @@ public:
 void Scale::tick(const TickData& td)
 {
   const auto nsamples = td.samples_in_tick(output.get_sample_rate());
+  const auto defer = can_defer_affine(output);
   sample_iterate(td, nsamples, {}, tie(x, y, z, input), tie(output),
                  [&](Number x, Number y, Number z, const Frame& input,
                      Frame& output)
   {
-    output = input;
-    for(auto& p: output.points)
-    {
-      p.x *= x;
-      p.y *= y;
-      p.z *= z;
-    }
+    apply_affine(input, Matrix::scaling(Vector(x, y, z)), defer, output);
   });
 }
 
@@ -15,6 +15,8 @@ public:
   TranslateTest()
   {
     loader.load("./vg-module-vector-translate.so");
+    loader.load("../scale/vg-module-vector-scale.so");
+    loader.load("../rotate/vg-module-vector-rotate.so");
   }
 };
 
@@ -85,6 +87,133 @@ TEST_F(TranslateTest, TestTranslateXYZ)
   }
 }
 
+TEST_F(TranslateTest, TestFusedAffineChain)
+{
+  auto& scale = add("vector/scale")
+                .set("x", 2.0)
+                .set("y", 3.0)
+                .set("z", 4.0);
+  auto& rot = add("vector/rotate")
+              .set("z", 0.25);
+  auto& trans = add("vector/translate")
+                .set("x", 1.0);
+
+  auto fr_data = vector<Frame>(1);
+  auto& fr = fr_data[0];
+  for(auto i=0u; i<50; i++)
+    fr.points.push_back(Point(i, i*2, i*3, Colour::red));
+
+  auto& frs = add_source(fr_data);
+  frs.connect("output", scale, "input");
+  scale.connect("output", rot, "input");
+  rot.connect("output", trans, "input");
+
+  auto frames = vector<Frame>{};
+  auto& snk = add_sink(frames, sample_rate);
+  trans.connect("output", snk, "input");
+
+  run();
+
+  ASSERT_EQ(sample_rate, frames.size());
+  const auto& frame = frames[0];
+  EXPECT_FALSE(frame.is_deferred());
+  ASSERT_EQ(50, frame.points.size());
+  for(auto i=0u; i<frame.points.size(); i++)
+  {
+    // Scaled to (2i, 6i, 12i), rotated 90 deg around Z to (-6i, 2i, 12i),
+    // then moved
+    const auto& p = frame.points[i];
+    EXPECT_NEAR(-6.0*i + 1.0, p.x, 1e-9);
+    EXPECT_NEAR(2.0*i, p.y, 1e-9);
+    EXPECT_NEAR(12.0*i, p.z, 1e-9);
+    EXPECT_EQ(Colour::red, p.c);
+  }
+}
+
+TEST_F(TranslateTest, TestFusedAffineChainWithFanOut)
+{
+  auto& scale = add("vector/scale")
+                .set("x", 2.0);
+  auto& trans1 = add("vector/translate")
+                .set("x", 1.0);
+  auto& trans2 = add("vector/translate")
+                .set("y", 1.0);
+
+  auto fr_data = vector<Frame>(1);
+  auto& fr = fr_data[0];
+  for(auto i=0u; i<10; i++)
+    fr.points.push_back(Point(i, i, i, Colour::white));
+
+  auto& frs = add_source(fr_data);
+  frs.connect("output", scale, "input");
+  scale.connect("output", trans1, "input");
+  scale.connect("output", trans2, "input");
+
+  auto frames1 = vector<Frame>{};
+  auto& snk1 = add_sink(frames1, sample_rate);
+  trans1.connect("output", snk1, "input");
+
+  auto frames2 = vector<Frame>{};
+  auto& snk2 = add_sink(frames2, sample_rate);
+  trans2.connect("output", snk2, "input");
+
+  // Intermediate also goes to a non-affine sink
+  auto frames3 = vector<Frame>{};
+  auto& snk3 = add_sink(frames3, sample_rate);
+  scale.connect("output", snk3, "input");
+
+  run();
+
+  ASSERT_EQ(sample_rate, frames1.size());
+  ASSERT_EQ(sample_rate, frames2.size());
+  ASSERT_EQ(sample_rate, frames3.size());
+  ASSERT_EQ(10, frames1[0].points.size());
+  ASSERT_EQ(10, frames2[0].points.size());
+  ASSERT_EQ(10, frames3[0].points.size());
+  EXPECT_FALSE(frames3[0].is_deferred());
+  for(auto i=0u; i<10; i++)
+  {
+    EXPECT_EQ(Point(2.0*i+1, i, i), frames1[0].points[i]);
+    EXPECT_EQ(Point(2.0*i, i+1, i), frames2[0].points[i]);
+    EXPECT_EQ(Point(2.0*i, i, i), frames3[0].points[i]);
+  }
+}
+
+TEST_F(TranslateTest, TestFusedAffineFanOutToAffineOnly)
+{
+  auto& scale = add("vector/scale")
+                .set("x", 2.0);
+  auto& trans1 = add("vector/translate")
+                .set("x", 1.0);
+  auto& trans2 = add("vector/translate")
+                .set("y", 1.0);
+
+  auto fr_data = vector<Frame>(1);
+  fr_data[0].points.push_back(Point(1, 1, 1, Colour::white));
+
+  auto& frs = add_source(fr_data);
+  frs.connect("output", scale, "input");
+  scale.connect("output", trans1, "input");
+  scale.connect("output", trans2, "input");
+
+  auto frames1 = vector<Frame>{};
+  auto& snk1 = add_sink(frames1, sample_rate);
+  trans1.connect("output", snk1, "input");
+
+  auto frames2 = vector<Frame>{};
+  auto& snk2 = add_sink(frames2, sample_rate);
+  trans2.connect("output", snk2, "input");
+
+  run();
+
+  ASSERT_EQ(sample_rate, frames1.size());
+  ASSERT_EQ(1, frames1[0].points.size());
+  EXPECT_EQ(Point(3, 1, 1), frames1[0].points[0]);
+  ASSERT_EQ(sample_rate, frames2.size());
+  ASSERT_EQ(1, frames2[0].points.size());
+  EXPECT_EQ(Point(2, 2, 1), frames2[0].points[0]);
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
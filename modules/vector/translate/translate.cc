@@ -45,13 +45,12 @@ public:
 void Translate::tick(const TickData& td)
 {
   const auto nsamples = td.samples_in_tick(output.get_sample_rate());
+  const auto defer = can_defer_affine(output);
   sample_iterate(td, nsamples, {}, tie(x, y, z, input), tie(output),
                  [&](Number x, Number y, Number z, const Frame& input,
                      Frame& output)
   {
-    Vector v(x, y, z);
-    output = input;
-    for(auto& p: output.points) p+=v;
+    apply_affine(input, Matrix::translation(Vector(x, y, z)), defer, output);
   });
 }
 
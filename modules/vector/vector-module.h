@@ -23,20 +23,116 @@ struct Frame
 {
   vector<Point> points;
 
+  // Deferred affine transform - if 'source' is set, the real points are
+  // 'transform' applied to *source, and 'points' is empty.  Only passed
+  // between affine elements (see below), which share 'source' read-only
+  shared_ptr<const vector<Point>> source;
+  Matrix transform;
+
   Frame() {}
-  Frame(const Frame& o): points(o.points) {}
+  Frame(const Frame& o):
+    points(o.points), source(o.source), transform(o.transform) {}
 
-  Frame& operator=(const Frame& o) { points = o.points; return *this; }
+  Frame& operator=(const Frame& o)
+  {
+    points = o.points;
+    source = o.source;
+    transform = o.transform;
+    return *this;
+  }
 
   Frame& operator+=(const Frame& o)
   {
-    points.insert(points.begin(), o.points.begin(), o.points.end());
+    resolve();
+    if (o.source)
+    {
+      Frame t{o};
+      t.resolve();
+      points.insert(points.begin(), t.points.begin(), t.points.end());
+    }
+    else
+    {
+      points.insert(points.begin(), o.points.begin(), o.points.end());
+    }
     return *this;
   }
+
+  // Is a transform deferred?
+  bool is_deferred() const { return !!source; }
+
+  // Apply any deferred transform to make the points real
+  void resolve()
+  {
+    if (!source) return;
+    transform.apply(*source, points);
+    source.reset();
+    transform = Matrix{};
+  }
 };
 
 typedef shared_ptr<Frame> FramePtr;
 
+//==========================================================================
+// Affine transform fusion
+// Chains of affine elements (translate, rotate, scale) pass frames to each
+// other with the transform deferred, composing their matrices, so the
+// whole chain copies the points once and makes one pass over them at the
+// end.  An element only defers if every consumer of its output is another
+// affine element with no other connection to that input, so anything else
+// - including fan out to non-affine elements - always sees real points
+
+// Is the given element an affine one?
+inline bool is_affine_element(const GraphElement *element)
+{
+  if (!element) return false;
+  const auto type = element->get_module().get_full_type();
+  return type == "vector/translate"
+      || type == "vector/rotate"
+      || type == "vector/scale";
+}
+
+// Can the given output pass deferred frames?
+inline bool can_defer_affine(const Output<Frame>& output)
+{
+  const auto connections = output.get_connections();
+  if (connections.empty()) return false;
+  for(const auto& c: connections)
+  {
+    if (!is_affine_element(c.element)) return false;
+    if (!c.input || c.input->get_connections().size() != 1) return false;
+  }
+  return true;
+}
+
+// Apply an affine transform from input to output, deferring if allowed
+inline void apply_affine(const Frame& input, const Matrix& m, bool defer,
+                         Frame& output)
+{
+  if (defer)
+  {
+    if (input.source)
+    {
+      output.source = input.source;
+      output.transform = m * input.transform;
+    }
+    else
+    {
+      output.source = make_shared<const vector<Point>>(input.points);
+      output.transform = m;
+    }
+    output.points.clear();
+  }
+  else
+  {
+    output.source.reset();
+    output.transform = Matrix{};
+    if (input.source)
+      (m * input.transform).apply(*input.source, output.points);
+    else
+      m.apply(input.points, output.points);
+  }
+}
+
 }}} //namespaces
 
 using namespace ViGraph::Module::Vector;
@@ -67,8 +163,10 @@ template<> inline JSON::Value get_as_json(const Frame& frame)
 {
   JSON::Value value{JSON::Value::OBJECT};
   JSON::Value& points = value.put("points", JSON::Value::ARRAY);
-  for(const auto& p: frame.points)
+  for(const auto& fp: frame.is_deferred() ? *frame.source : frame.points)
   {
+    const auto p = frame.is_deferred() ? Point(frame.transform.apply(fp),
+                                               fp.c) : fp;
     JSON::Value &jp = points.add(JSON::Value::OBJECT);
     jp.set("x", p.x).set("y", p.y).set("z", p.z).set("c", p.c.str());
   }